@@ -0,0 +1,76 @@
+/**
+ *  @file   CoarseToFineFit.hpp
+ *  @brief  Contains declaration of class CoarseToFineFit
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef COARSE_TO_FINE_FIT_HPP
+#define COARSE_TO_FINE_FIT_HPP
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "TH1.h"
+#include "TF1.h"
+#include "TAxis.h"
+
+#include "yaml-cpp/yaml.h"
+
+#include "ErrorHandler.hpp"
+#include "MathTools.hpp"
+
+/*! @class CoarseToFineFit
+ * @brief Class CoarseToFineFit performs the coarse stage of the multiresolution fit: the function is fitted to the histogram with merged bins and the resulting parameters are used as seeds for the fits of the original histogram
+ *
+ * Bins of the histogram in the range of the function are merged by rebinFactor into the buffer owned by the class (incomplete group of bins at the upper edge of the range is dropped). Contents and errors of the merged bins are divided by rebinFactor so that they are in the units of the original bins; hence the parameters of the function fitted to the buffer are the seeds for the original histogram without rescaling of the amplitudes. Since the contents are not the counts anymore the coarse fit should use chi2 (options without "L") and must not store the function in the buffer (option "N"). The stage is set from .yaml node:
+ * @code
+ * rebin_factor: 4 # 1 disables the stage
+ * min_number_of_bins: 10
+ * options: "RQBN"
+ * @endcode
+ * The coarse fit is not performed if the buffer has less than min_number_of_bins bins with entries; the parameters of the function are not changed in this case and the fits of the original histogram start from the default seeds.
+ */
+class CoarseToFineFit
+{
+   public:
+
+   ///@brief Default constructor
+   CoarseToFineFit();
+   /*! @brief Constructor with parameters
+    * @param[in] stage .yaml node with the parameters of the stage (see the description of the class)
+    */
+   CoarseToFineFit(const YAML::Node& stage);
+   /*! @brief Fits the function to the histogram with merged bins in the range of the function. Returns the status of the fit or -1 if the fit was not performed
+    * @param[in] hist histogram
+    * @param[in,out] func function; its parameters are used as initial values and are replaced by the result of the coarse fit
+    */
+   int Fit(const TH1 *hist, TF1& func);
+   /// @brief Returns the number of performed coarse fits
+   unsigned long GetNumberOfFits() const;
+   /// @brief Returns the number of calls of Fit in which the coarse fit was not performed
+   unsigned long GetNumberOfSkippedFits() const;
+   /// @brief Default destructor
+   virtual ~CoarseToFineFit();
+
+   private:
+
+   /// Number of merged bins of the original histogram in 1 bin of the buffer
+   unsigned int rebinFactor = 1;
+   /// Minimum number of bins with entries in the buffer for the coarse fit to be performed
+   int minNumberOfBins = 10;
+   /// Options of TH1::Fit for the coarse fit
+   std::string options = "RQBN";
+   /// Histogram with merged bins
+   TH1D coarseHist;
+   /// Edges of the bins of coarseHist
+   std::vector<double> coarseBinEdges;
+   /// Number of performed coarse fits
+   unsigned long numberOfFits = 0;
+   /// Number of calls of Fit in which the coarse fit was not performed
+   unsigned long numberOfSkippedFits = 0;
+};
+
+#endif /* COARSE_TO_FINE_FIT_HPP */
@@ -0,0 +1,99 @@
+/**
+ *  @file   DoubleGausSeedEstimator.hpp
+ *  @brief  Contains declaration of class DoubleGausSeedEstimator
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef DOUBLE_GAUS_SEED_ESTIMATOR_HPP
+#define DOUBLE_GAUS_SEED_ESTIMATOR_HPP
+
+#include <cmath>
+#include <array>
+#include <string>
+#include <algorithm>
+#include <vector>
+
+#include "TH1.h"
+#include "TF1.h"
+#include "TAxis.h"
+
+#include "ErrorHandler.hpp"
+#include "MathTools.hpp"
+
+/*! @class DoubleGausSeedEstimator
+ * @brief Class DoubleGausSeedEstimator estimates the initial values and the limits of the parameters of the sum of 2 gaussians (core and tail; "gaus(0) + gaus(3)") from the bin contents of 1D histogram without the fit
+ *
+ * Bins in the range are read once: the cumulative distribution, the first and the last bins with entries, the maximum bin, and the mean and the RMS of the contents are accumulated. The weighted median and the median absolute deviation (MAD) are found from the interpolated cumulative distribution; both gaussians are centered at the median (the mean of the tail is shifted by the difference of the mean of the contents and the median). The fraction of the core, the sigma of the core, and the sigma of the tail are found iteratively from the fractions of the contents in median ± MAD/2 and median ± 2*MAD and from the variance of the contents, all of which are the sums of the ones of the core and the tail; the iterations start from the sigma of the core equal to 1.4826*MAD (sigma of the gaussian with the same MAD). The amplitudes follow from the integrals of the core and the tail. Seeds do not depend on the range of the axis outside of the bins with entries.
+ */
+class DoubleGausSeedEstimator
+{
+   public:
+
+   ///@brief Default constructor
+   DoubleGausSeedEstimator();
+   /*! @brief Estimates the parameters in the range of the histogram. Returns true if the estimate was obtained (the range has entries and the spread of the contents is not 0)
+    * @param[in] hist histogram
+    * @param[in] xMin lower edge of the range
+    * @param[in] xMax upper edge of the range
+    */
+   bool Estimate(const TH1 *hist, const double xMin, const double xMax);
+   /*! @brief Sets the initial values and the limits of the parameters of the function "gaus(0) + gaus(3)" from the last estimate
+    * @param[in,out] func function
+    */
+   void SetSeeds(TF1& func) const;
+   /// @brief Returns the lower edge of the first bin with entries from the last estimate
+   double GetFirstEdge() const;
+   /// @brief Returns the upper edge of the last bin with entries from the last estimate
+   double GetLastEdge() const;
+   /// @brief Returns the maximum bin content from the last estimate
+   double GetMaxBinContent() const;
+   /// @brief Returns the weighted median from the last estimate
+   double GetMedian() const;
+   /// @brief Returns the median absolute deviation from the last estimate
+   double GetMAD() const;
+   /// @brief Returns the fraction of the contents in the core from the last estimate
+   double GetCoreFraction() const;
+   /// @brief Default destructor
+   virtual ~DoubleGausSeedEstimator();
+
+   private:
+
+   /*! @brief Returns the position at which the interpolated cumulative distribution reaches the value
+    * @param[in] value value of the cumulative distribution
+    */
+   double GetQuantile(const double value) const;
+   /*! @brief Returns the interpolated cumulative distribution at the position
+    * @param[in] x position
+    */
+   double GetCumulative(const double x) const;
+   /// Number of iterations of the split of the contents between the core and the tail
+   unsigned int numberOfSplitIterations = 20;
+   /// Minimum fraction of the contents in the core or in the tail
+   double minFraction = 0.05;
+   /// Edges of the bins in the range
+   std::vector<double> binEdges;
+   /// Cumulative contents at binEdges
+   std::vector<double> cumulative;
+   /// Lower edge of the first bin with entries
+   double firstEdge = 0.;
+   /// Upper edge of the last bin with entries
+   double lastEdge = 0.;
+   /// Maximum bin content
+   double maxBinContent = 0.;
+   /// Weighted median
+   double median = 0.;
+   /// Median absolute deviation
+   double mad = 0.;
+   /// Fraction of the contents in the core
+   double coreFraction = 1.;
+   /// Initial values of the parameters
+   std::array<double, 6> parameters;
+   /// Lower limits of the parameters
+   std::array<double, 6> parametersMin;
+   /// Upper limits of the parameters
+   std::array<double, 6> parametersMax;
+};
+
+#endif /* DOUBLE_GAUS_SEED_ESTIMATOR_HPP */
@@ -0,0 +1,117 @@
+/**
+ *  @file   EMCRunCatalog.hpp
+ *  @brief  Contains declaration of class EMCRunCatalog
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_RUN_CATALOG_HPP
+#define EMC_RUN_CATALOG_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cctype>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+#include <unistd.h>
+
+#include "TFile.h"
+#include "TH2.h"
+#include "TROOT.h"
+
+#include "ErrorHandler.hpp"
+#include "MathTools.hpp"
+
+/*! @class EMCRunCatalog
+ * @brief Class EMCRunCatalog stores the metadata of se-<run>.root files used in the run by run EMCal timing calibration
+ *
+ * For every run the run number, the path to the file, its size, its last modification time, and the number of entries of histogram "tcorr vs ADC: <sector>" for every sector are stored. The catalog is written in a text file and is updated only for the files that were added or changed (size or modification time differs) since the last update so that bad runs can be skipped and the work can be balanced without opening the files.
+ */
+class EMCRunCatalog
+{
+   public:
+
+   ///@brief Default constructor
+   EMCRunCatalog();
+   /*! @brief Reads the catalog from the file. Returns false if the file does not exist
+    * @param[in] fileName name of the file
+    */
+   bool ReadFile(const std::string& fileName);
+   /*! @brief Writes the catalog in the file. The file is replaced at once so concurrent readers see either the previous or the new catalog
+    * @param[in] fileName name of the file
+    */
+   void WriteFile(const std::string& fileName) const;
+   /*! @brief Updates the catalog with se-<run>.root files from the directory. Only the files that are absent in the catalog or whose size or modification time changed are opened; runs whose files were removed are removed from the catalog. Files that are still being written (their size changes during minStableTime or ROOT can not read their directory of keys) are left out of the catalog until one of the next updates. Returns true if the catalog was changed
+    * @param[in] inputDir directory with se-<run>.root files
+    * @param[in] sectorNames names of the sectors for which the number of entries is stored; if they differ from the ones in the catalog all files are read again
+    * @param[in] numberOfThreads number of threads over which the files are distributed
+    * @param[in] minStableTime time in seconds during which the size of new or changed files must not change for them to be opened; 0 disables the check
+    */
+   bool Update(const std::string& inputDir, const std::vector<std::string>& sectorNames,
+               const unsigned int numberOfThreads, const double minStableTime = 0.);
+   /// @brief Returns the sorted run numbers
+   std::vector<int> GetRunNumbers() const;
+   /// @brief Returns the number of runs in the catalog
+   unsigned long GetNumberOfRuns() const;
+   /*! @brief Returns the number of entries of histogram "tcorr vs ADC: <sector>" of the run
+    * @param[in] runIndex index of the run in the sorted run numbers
+    * @param[in] sectorBin index of the sector in the sector names passed to EMCRunCatalog::Update
+    */
+   double GetEntries(const unsigned long runIndex, const unsigned int sectorBin) const;
+   /*! @brief Returns the last modification time of se-<run>.root file in seconds (see EMCRunCatalog::GetModificationTime(const std::string& fileName))
+    * @param[in] runIndex index of the run in the sorted run numbers
+    */
+   long long GetModificationTime(const unsigned long runIndex) const;
+   /*! @brief Returns the last modification time of the file in seconds in the same units as the modification times of se-<run>.root files in the catalog
+    * @param[in] fileName name of the file
+    */
+   static long long GetModificationTime(const std::string& fileName);
+   /*! @brief Returns the position of the first run of the chunk in runIndices so that all chunks contain contiguous parts of the runs with approximately equal expected cost; cost of the run is the number of entries in the sectors with at least minEntries entries (other sectors are skipped) plus 1 for opening the file. The position after the last run of the chunk is the position of the first run of the next chunk
+    * @param[in] chunkIndex index of the chunk (numberOfChunks returns the size of runIndices)
+    * @param[in] numberOfChunks number of chunks
+    * @param[in] minEntries minimum number of entries for the sector to be processed
+    * @param[in] runIndices sorted indices of the runs that are split into chunks
+    */
+   unsigned long GetFirstRunIndexOfChunk(const unsigned int chunkIndex,
+                                         const unsigned int numberOfChunks,
+                                         const double minEntries,
+                                         const std::vector<unsigned long>& runIndices) const;
+   /// @brief Default destructor
+   virtual ~EMCRunCatalog();
+
+   private:
+
+   /// @brief Metadata of a single run
+   struct Run
+   {
+      /// run number
+      int runNumber = 0;
+      /// path to se-<run>.root file
+      std::string filePath;
+      /// size of the file in bytes
+      unsigned long fileSize = 0;
+      /// last modification time of the file
+      long long modificationTime = 0;
+      /// number of entries of histogram "tcorr vs ADC: <sector>" for every sector
+      std::vector<double> sectorEntries;
+      /// true if the file was not completely written when the catalog was updated
+      bool isIncomplete = false;
+   };
+   /// @brief Returns the expected cost of the run (see EMCRunCatalog::GetFirstRunIndexOfChunk)
+   double GetCost(const Run& run, const double minEntries) const;
+   /// Names of the sectors for which the number of entries is stored
+   std::vector<std::string> sectorNames;
+   /// Runs sorted by run number
+   std::vector<Run> runs;
+};
+
+#endif /* EMC_RUN_CATALOG_HPP */
@@ -0,0 +1,163 @@
+/**
+ *  @file   EMCRunOffsetApproximator.hpp
+ *  @brief  Contains declaration of class EMCRunOffsetApproximator
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_RUN_OFFSET_APPROXIMATOR_HPP
+#define EMC_RUN_OFFSET_APPROXIMATOR_HPP
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <memory>
+#include <set>
+#include <functional>
+#include <filesystem>
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TF1.h"
+#include "TTree.h"
+#include "TMath.h"
+#include "TCanvas.h"
+#include "TGraphErrors.h"
+#include "TFileMerger.h"
+
+#include "ErrorHandler.hpp"
+#include "MathTools.hpp"
+#include "StrTools.hpp"
+
+#include "TCanvasTools.hpp"
+
+#include "InputYAMLReader.hpp"
+#include "EMCRunCatalog.hpp"
+#include "SummedAreaTable.hpp"
+#include "HistogramArena.hpp"
+#include "FitFunctionPool.hpp"
+#include "FitStrategyLadder.hpp"
+#include "CoarseToFineFit.hpp"
+#include "RobustPeakEstimator.hpp"
+
+/*! @class EMCRunOffsetApproximator
+ * @brief Class EMCRunOffsetApproximator approximates tcorr of photons vs ADC of every run in EMCal sectors for EMCTRunByRunOffset and CheckEMCTiming
+ *
+ * For every run and sector ADC bins of the histogram "tcorr vs ADC: <sector>" from se-<run>.root are merged until there is enough statistics, the photon signal in tcorr projection of the merged bins is approximated with the tiers of fit_strategy: t_photon (see FitStrategyLadder), and the means of the photon signal vs ADC are approximated with tcorr_mean_vs_adc_fit_func. The result for every merged ADC bins is filled in tcorr_fits tree (see TPhotonPeak); means and sigmas vs ADC are drawn in output/EMCTCalibration/<run_name>/<sector>/tcorr_par_vs_adc_<run>. Runs are processed in chunks (contiguous parts of sorted runs) whose outputs are merged by MergeChunks.
+ */
+class EMCRunOffsetApproximator
+{
+   public:
+
+   /// @brief Result of the approximation of the photon signal in tcorr projection of merged ADC bins of a run (entry of tcorr_fits tree)
+   struct TPhotonPeak
+   {
+      /// run number
+      int run = 0;
+      /// EMCal sector bin
+      int sector = 0;
+      /// lower edge of merged ADC bins
+      double adcMin = 0.;
+      /// upper edge of merged ADC bins
+      double adcMax = 0.;
+      /// mean of tcorr of photons
+      double mean = 0.;
+      /// uncertainty of the mean
+      double meanError = 0.;
+      /// sigma of tcorr of photons
+      double sigma = 0.;
+      /// uncertainty of the sigma
+      double sigmaError = 0.;
+      /// status of the last fit (see TFitResult::Status; 0 if the fit converged); 0 for the estimate
+      int status = 0;
+      /// 0 if the result was estimated without the fit (see RobustPeakEstimator), 1 if it was fitted
+      int method = 0;
+      /// true if the result was excluded from the approximation of means vs ADC
+      bool isOutlier = false;
+   };
+   ///@brief Default constructor
+   EMCRunOffsetApproximator();
+   /*! @brief Reads the parameters of the approximations from the input .yaml file
+    * @param[in] inputYAMLCal contents of emc_timing.yaml
+    */
+   void Init(InputYAMLReader& inputYAMLCal);
+   /*! @brief Approximates the runs runIndices[firstRunIndex, lastRunIndex) of the catalog in the sectors. Every se-<run>.root file is opened once and histograms of all sectors are read from it
+    * @param[in] runCatalog catalog of se-<run>.root files
+    * @param[in] runIndices sorted indices of the runs in the catalog
+    * @param[in] firstRunIndex index of the first processed run in runIndices
+    * @param[in] lastRunIndex index after the last processed run in runIndices
+    * @param[in] minRunEntries minimum number of entries in the histogram tcorr vs ADC of the run in the sector for it to be processed
+    * @param[in] sectorBins EMCal sector bins
+    * @param[in] outputFileNames files in which tcorr_fits trees of the sectors are written; sectors with empty names are not processed (e.g. if all their towers were masked)
+    * @param[in] processRunResult called for every run (in the order of runs) and every sector (in the order of sectorBins) with the index of the sector in sectorBins, the run number, and the approximation of means of tcorr of photons vs ADC; the approximation is nullptr if the run was not approximated in the sector
+    */
+   void ProcessRuns(const EMCRunCatalog& runCatalog, const std::vector<unsigned long>& runIndices,
+                    const unsigned long firstRunIndex, const unsigned long lastRunIndex,
+                    const double minRunEntries, const std::vector<unsigned int>& sectorBins,
+                    const std::vector<std::string>& outputFileNames,
+                    const std::function<void(const unsigned long, const int,
+                                             const TF1 *)>& processRunResult);
+   /*! @brief Merges the outputs of the chunks in the output file in the order of the chunks
+    * @param[in] outputFileName output file
+    * @param[in] chunkFileNames outputs of the chunks; the ones that do not exist are skipped (e.g. if all towers of the sector were masked)
+    * @param[in] isUpdated if true the outputs of the chunks are added to the existing output file from which the directories and tcorr_fits entries of replacedRuns are removed beforehand; else the output file is recreated
+    * @param[in] replacedRuns runs which results in the existing output file are replaced by the outputs of the chunks
+    */
+   void MergeChunks(const std::string& outputFileName,
+                    const std::vector<std::string>& chunkFileNames,
+                    const bool isUpdated, const std::set<int>& replacedRuns = {});
+   /// @brief Returns the tiers of the approximation of the photon signal (e.g. to write their statistics)
+   FitStrategyLadder& GetTPhotonFitLadder();
+   /// @brief Default destructor
+   virtual ~EMCRunOffsetApproximator();
+
+   private:
+
+   /*! @brief Approximates tcorr distributions of photons in ADC ranges and their means vs ADC for a single run in a given sector. Returns true if the approximation was performed; else false
+    * @param[in] tVsADC histogram tcorr vs ADC of the run in the sector
+    * @param[in] sector container for the specified sector (see "sectors_to_calibrate" field in input .yaml file)
+    * @param[in] runNumber run number
+    * @param[out] tPhotonMeanVsADCFit approximation of means of tcorr of photons vs ADC
+    * @param[out] tPhotonPeaks tree in which the result for every merged ADC bins is filled; run and sector of tPhotonPeak must be set before the call
+    */
+   bool ProcessRun(TH2D *tVsADC, const YAML::Node& sector, const int runNumber,
+                   TF1& tPhotonMeanVsADCFit, TTree *tPhotonPeaks);
+   /// @brief Returns new tree tcorr_fits with branches bound to tPhotonPeak in the current directory
+   TTree *CreateTPhotonPeaksTree();
+   /// @brief Binds branches of the existing tree tcorr_fits to tPhotonPeak
+   void SetTPhotonPeaksBranchAddresses(TTree *tPhotonPeaks);
+   /*! @brief Returns true if the photon signal in tcorr projection is an outlier
+    * @param[in] mean mean of the photon signal
+    * @param[in] sigma sigma of the photon signal
+    */
+   static bool IsTPhotonOutlier(const double mean, const double sigma);
+   /// Name of run (e.g. Run14HeAu200)
+   std::string runName;
+   /// Sectors to calibrate from the input .yaml file
+   YAML::Node sectors;
+   /// Function of the photon signal in tcorr projections
+   std::string tPhotonFitFunc;
+   /// Function of means of tcorr of photons vs ADC
+   std::string tPhotonMeanVsADCFitFunc;
+   /// Number of consequent fits of means of tcorr of photons vs ADC
+   unsigned int fitNTries = 5;
+   /// If true tcorr projections of merged ADC bins are written in per run directories of the output files in addition to tcorr_fits tree
+   bool isTPhotonProjectionWritten = false;
+   /// Buffer for the entries of tcorr_fits trees
+   TPhotonPeak tPhotonPeak;
+   /// Fit-free estimator of mean and sigma of the photon signal in tcorr projections
+   /// (used by the tiers of tPhotonFitLadder with method "estimate")
+   RobustPeakEstimator photonPeakEstimator;
+   /// Tiers of the approximation of the photon signal in tcorr projections (see FitStrategyLadder)
+   FitStrategyLadder tPhotonFitLadder;
+   /// Coarse stage of the fits of the photon signal in tcorr projections that provides the seeds
+   CoarseToFineFit tPhotonCoarseToFineFit;
+   /// Reused buffers for the projections; they are recycled for every run
+   HistogramArena histogramArena;
+   /// Reused fit functions; they are recycled for every run
+   FitFunctionPool fitFunctionPool;
+};
+
+#endif /* EMC_RUN_OFFSET_APPROXIMATOR_HPP */
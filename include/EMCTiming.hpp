@@ -11,9 +11,16 @@
 
 #include <memory>
 #include <thread>
+#include <atomic>
 #include <algorithm>
 #include <filesystem>
 #include <set>
+#include <map>
+#include <sstream>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
 
 #include "TFile.h"
 #include "TH1.h"
@@ -23,6 +30,8 @@
 #include "TROOT.h"
 #include "TStyle.h"
 #include "TGraphErrors.h"
+#include "TFileMerger.h"
+#include "TTree.h"
 
 #include "IOTools.hpp"
 #include "MathTools.hpp"
@@ -33,6 +42,21 @@
 #include "PBar.hpp"
 
 #include "InputYAMLReader.hpp"
+#include "EMCTowerMask.hpp"
+#include "EMCTowerOffsetTable.hpp"
+#include "EMCTowerMoments.hpp"
+#include "InputHistogramMerger.hpp"
+#include "HistogramArena.hpp"
+#include "FitFunctionPool.hpp"
+#include "FitStrategyLadder.hpp"
+#include "CoarseToFineFit.hpp"
+#include "ThreadTokenPool.hpp"
+#include "MemoryBudget.hpp"
+#include "MemoryUsageReporter.hpp"
+#include "SummedAreaTable.hpp"
+#include "EMCRunCatalog.hpp"
+#include "RobustPeakEstimator.hpp"
+#include "EMCRunOffsetApproximator.hpp"
 
 /*! @namespace EMCTiming
  * @brief Contains all functions, variables, and containers for EMCTowerOffset.cpp
@@ -48,11 +72,76 @@ namespace EMCTiming
     */
    bool PerformFitsForSingleTower(TH2D *distr, TF1& fitFunc, const std::string& sectorName,
                                   const int yTowerIndex, const int zTowerIndex);
-   /*! @brief Calls PerformFitsForSingleTower for different towers in a given sector
+   /*! @brief Approximates the distribution of means of t projections vs ADC for a single tower
+    *
+    * @param[in] meanDistr distribution of means of t projections vs ADC
+    * @param[in] fitFunc function that will be used for approximation 
+    * @param[in] minT lower edge of the first occupied t bin
+    * @param[in] maxT upper edge of the last occupied t bin
+    * @param[in] yTowerIndex y index of the tower 
+    * @param[in] zTowerIndex z index of the tower 
+    */
+   void PerformFitsForMeanDistr(TH1D& meanDistr, TF1& fitFunc, 
+                                const double minT, const double maxT,
+                                const int yTowerIndex, const int zTowerIndex);
+   /*! @brief Performs t vs ADC fit for a single tower seeded with the parameters from the previous calibration (see warmStartTowerOffset). Returns true if the fit converged and none of the parameters reached the limits; else false in which case the limits of fitFunc are released
+    *
+    * @param[in] meanDistr distribution of means of t projections vs ADC
+    * @param[in] fitFunc function that will be used for approximation 
+    * @param[in] yTowerIndex y index of the tower 
+    * @param[in] zTowerIndex z index of the tower 
+    */
+   bool PerformWarmStartFit(TH1D& meanDistr, TF1& fitFunc, 
+                            const int yTowerIndex, const int zTowerIndex);
+   /*! @brief Draws t vs ADC distribution and its approximation for a single tower
+    *
+    * @param[in] distr histogram containing t vs ADC distribution for the single tower
+    * @param[in] meanDistr distribution of means of t projections vs ADC
+    * @param[in] fitFunc function that was used for approximation 
+    * @param[in] sectorName name of the sector
+    * @param[in] yTowerIndex y index of the tower 
+    * @param[in] zTowerIndex z index of the tower 
+    */
+   void DrawTowerFit(TH2D *distr, TH1D& meanDistr, TF1& fitFunc, const std::string& sectorName,
+                     const int yTowerIndex, const int zTowerIndex);
+   /*! @brief Reads the tower mask and the parameters for warm start (if it is enabled) for a given sector
     *
-    * @param[in] sector EMCal sector
+    * @param[in] sectorName name of the sector
+    * @param[in] numberOfYTowers number of towers along y axis
+    * @param[in] numberOfZTowers number of towers along z axis
+    */
+   void ReadTowerMaskAndWarmStart(const std::string& sectorName, 
+                                  const int numberOfYTowers, const int numberOfZTowers);
+   /*! @brief Adds new input files to the accumulated moments of towers (see EMCTowerMoments) and refits only towers whose number of entries changed significantly since their last fit
+    *
+    * @param[in] sectorBin EMCal sector bin
+    */
+   void UpdateSectorIncrementally(const int sectorBin);
+   /*! @brief Processes all towers of a given sector; defined only in the per tower programs (EMCTTowerOffset calls PerformFitsForSingleTower for every tower and EMCTTowerMask classifies the towers); run-by-run programs process the sectors with ProcessRuns instead
+    *
+    * @param[in] sectorBin EMCal sector bin
     */
    void ProcessSector(const int sectorBin);
+   /*! @brief Approximates tcorr vs ADC distributions of the specified sectors for the chunk of runs (see runChunkIndex) with runOffsetApproximator
+    *
+    * @param[in] sectorBins EMCal sector bins
+    */
+   void ProcessRuns(const std::vector<unsigned int>& sectorBins);
+   /*! @brief Leaves in runIndicesToProcess only the runs that are absent in run_by_run_offset_<sector>.txt of any of the specified sectors or whose se-<run>.root files were modified after this file was written
+    *
+    * @param[in] sectorBins EMCal sector bins
+    */
+   void SelectRunsToProcess(const std::vector<unsigned int>& sectorBins);
+   /*! @brief Blocks until se-<run>.root files are written (closed after writing or moved) in data/EMCTiming/<run_name>/ and no other files are written for watchDebounceTime seconds after the last one
+    *
+    * @param[in] inotifyFileDescriptor inotify instance that watches the input directory
+    */
+   void WaitForNewRuns(const int inotifyFileDescriptor);
+   /*! @brief Merges the outputs of the chunks of runs processed by different subprocesses for a given sector in the order of runs. In incremental mode (see isRunByRunIncremental) the outputs are merged into the existing ones and the runs that were processed again replace the old results
+    *
+    * @param[in] sectorBin EMCal sector bin
+    */
+   void MergeRunChunks(const int sectorBin);
    /// @brief Function for ProgressBar thread call
    void PBarCall();
    /// @brief If showProgress set to false in main this function will calculate how many calls have passed from .tmp files and set this value for Par::numberOfCalls
@@ -69,6 +158,22 @@ namespace EMCTiming
    std::ofstream parametersOutput;
    /// contains all run numbers for run by run correction
    std::vector<int> runNumbers;
+   /// Metadata of se-<run>.root files (see EMCRunCatalog)
+   EMCRunCatalog runCatalog;
+   /// Minimum number of entries in histogram tcorr vs ADC for the run to be processed; runs with less entries are considered bad
+   const double minRunEntries = 1000.;
+   /// Sorted indices of the runs in runCatalog (and runNumbers) that will be processed
+   std::vector<unsigned long> runIndicesToProcess;
+   /// If true only runs that are absent in the existing run by run parameters (or whose files changed after the parameters were written) are processed and merged in the existing outputs
+   bool isRunByRunIncremental = false;
+   /// If true the program keeps running after the runs are processed and processes new se-<run>.root files as soon as they are written (implies isRunByRunIncremental)
+   bool isRunByRunWatched = false;
+   /// Time in seconds without new files after which written files are processed in watch mode; files of several runs written in quick succession are processed together
+   double watchDebounceTime = 2.;
+   /// Index of the chunk of runs (sorted contiguous part of runNumbers) that is processed by this process
+   unsigned int runChunkIndex = 0;
+   /// Number of chunks into which runNumbers are split; if it is equal to 1 all runs are processed by one process and its output is written directly
+   unsigned int numberOfRunChunks = 1;
    /// pProgress bar - shows progress (see ProgressBar)
    ProgressBar pBar{"FANCY1", "", PBarColor::BOLD_GREEN};
    /// Value that shows whether the computation part of this program is finished; the other part joins the threads and finishes the program
@@ -87,8 +192,36 @@ namespace EMCTiming
    unsigned int fitNTries = 5;
    /// minimum value of ADC for the fit
    double fitADCMin = 0.;
+   /// Approximations of tcorr of photons vs ADC of every run (see EMCRunOffsetApproximator)
+   /// shared by the run by run programs
+   EMCRunOffsetApproximator runOffsetApproximator;
    /// Mode in which the program was launched in; see main function description for more detail
    int programMode;
+   /// Statuses of the towers of the sector that is being processed (see EMCTTowerMask)
+   EMCTowerMask towerMask;
+   /// Histograms traw vs ADC vs iz summed over raw_sum.root or over partial input files (see input_partial_files in input .yaml file)
+   InputHistogramMerger inputHistograms;
+   /// Reused buffers for the projections of the histograms; they are recycled for every tower
+   HistogramArena histogramArena;
+   /// Reused fit functions; they are recycled together with histogramArena
+   FitFunctionPool fitFunctionPool;
+   /// Tiers of the fits of means of traw vs ADC distributions of towers (see FitStrategyLadder)
+   FitStrategyLadder towerFitLadder;
+   /// Parameters of t vs ADC fits from the previous calibration used as seeds for the current fits
+   EMCTowerOffsetTable warmStartTowerOffset;
+   /// If true t vs ADC fits are seeded with parameters from warmStartTowerOffset
+   bool isWarmStart = false;
+   /// Relative deviation of the seeded parameters (or of their RMS over the sector if it is bigger)
+   /// that defines their initial limits in warm start
+   double warmStartParameterDeviation = 0.2;
+   /// Number of consequent fits of t vs ADC distribution in warm start; 
+   /// if the seeded fit fails the tower is fitted with towerFitLadder from the default seeds
+   unsigned int warmStartFitNTries = 1;
+   /// If true the moments of towers are updated with new input files and 
+   /// only towers with significantly changed statistics are refitted
+   bool isIncremental = false;
+   /// Minimum relative change of the number of entries of the tower since its last fit for the tower to be refitted in incremental mode
+   double refitMinRelativeChange = 0.05;
 };
 /*! @brief Main function
  *
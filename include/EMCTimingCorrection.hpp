@@ -0,0 +1,124 @@
+/**
+ *  @file   EMCTimingCorrection.hpp
+ *  @brief  Contains declaration of class EMCTimingCorrection
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_TIMING_CORRECTION_HPP
+#define EMC_TIMING_CORRECTION_HPP
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+
+#include "TF1.h"
+
+#include "ErrorHandler.hpp"
+
+#include "EMCTowerOffsetTable.hpp"
+
+/*! @class EMCTimingCorrection
+ * @brief Class EMCTimingCorrection applies EMCal timing calibration produced by EMCTTowerOffset and EMCTRunByRunOffset to the hits
+ *
+ * The corrected time of the hit is t - f_tower(ADC) - f_run(ADC) where f_tower is t vs ADC approximation of the tower from tower_offset_<sector>.txt and f_run is the approximation of the mean of tcorr of photons vs ADC of the run from run_by_run_offset_<sector>.txt. Both files are read once; the functions are evaluated with TF1 only once per tower and per run at the nodes of uniform ADC grid and are stored in flat lookup tables indexed by tower (iy*numberOfZTowers + iz) and by run. The correction of the hit is then a linear interpolation between 2 nodes of each table without any formula evaluation. ADC outside of the grid range is clamped to its edges.
+ */
+class EMCTimingCorrection
+{
+   public:
+
+   ///@brief Default constructor
+   EMCTimingCorrection();
+   /*! @brief Constructor with parameters
+    * @param[in] towerOffsetFunc t vs ADC fit function of the towers (traw_vs_adc_fit_func in input .yaml file)
+    * @param[in] runOffsetFunc tcorr mean vs ADC fit function of the runs (tcorr_mean_vs_adc_fit_func in input .yaml file)
+    * @param[in] adcMin lower edge of ADC grid of the lookup tables
+    * @param[in] adcMax upper edge of ADC grid of the lookup tables
+    * @param[in] numberOfADCBins number of intervals of ADC grid of the lookup tables
+    */
+   EMCTimingCorrection(const std::string& towerOffsetFunc, const std::string& runOffsetFunc,
+                       const double adcMin, const double adcMax, const unsigned int numberOfADCBins);
+   /*! @brief Reads the calibration parameters of the sector and fills its lookup tables. Returns the index of the sector that is passed to EMCTimingCorrection::Correct
+    * If any of the files does not exist or is corrupted EMCTimingCorrection will print error and exit the program with exit code 1.
+    * @param[in] towerOffsetFileName name of the file with tower parameters (CalibrationParameters/tower_offset_<sector>.txt)
+    * @param[in] runByRunOffsetFileName name of the file with run by run parameters (CalibrationParameters/run_by_run_offset_<sector>.txt)
+    */
+   unsigned int AddSector(const std::string& towerOffsetFileName,
+                          const std::string& runByRunOffsetFileName);
+   /*! @brief Corrects the times of the hits of the same sector and the same run. Times of the hits that cannot be corrected (the tower or the run was not calibrated or the tower indices are out of range) are set to NaN. Returns the number of corrected hits
+    * @param[in] sectorBin index of the sector returned by EMCTimingCorrection::AddSector
+    * @param[in] runNumber run number
+    * @param[in] numberOfHits number of hits
+    * @param[in] iy y indices of the towers of the hits
+    * @param[in] iz z indices of the towers of the hits
+    * @param[in] adc ADC values of the hits
+    * @param[in,out] t times of the hits that are replaced with the corrected times
+    */
+   unsigned long Correct(const unsigned int sectorBin, const int runNumber,
+                         const unsigned long numberOfHits, const int *iy, const int *iz,
+                         const double *adc, double *t) const;
+   /*! @brief Returns the corrected time of a single hit or NaN if it cannot be corrected (see EMCTimingCorrection::Correct for the batch version)
+    * @param[in] sectorBin index of the sector returned by EMCTimingCorrection::AddSector
+    * @param[in] runNumber run number
+    * @param[in] iy y index of the tower of the hit
+    * @param[in] iz z index of the tower of the hit
+    * @param[in] adc ADC value of the hit
+    * @param[in] t time of the hit
+    */
+   double Correct(const unsigned int sectorBin, const int runNumber,
+                  const int iy, const int iz, const double adc, const double t) const;
+   /// @brief Returns the number of added sectors
+   unsigned int GetNumberOfSectors() const;
+   /// @brief Returns the sorted numbers of the calibrated runs of the sector
+   const std::vector<int>& GetRunNumbers(const unsigned int sectorBin) const;
+   /// @brief Default destructor
+   virtual ~EMCTimingCorrection();
+
+   private:
+
+   /// @brief Lookup tables of a single sector
+   struct Sector
+   {
+      /// number of towers along y axis
+      int numberOfYTowers = 0;
+      /// number of towers along z axis
+      int numberOfZTowers = 0;
+      /// flags that show whether the tower was calibrated; index is iy*numberOfZTowers + iz
+      std::vector<unsigned char> isTowerCalibrated;
+      /// values of t vs ADC functions of the towers at the nodes of ADC grid;
+      /// values of the tower start from (iy*numberOfZTowers + iz)*(numberOfADCBins + 1)
+      std::vector<float> towerTable;
+      /// sorted numbers of the calibrated runs
+      std::vector<int> runNumbers;
+      /// values of tcorr mean vs ADC functions of the runs at the nodes of ADC grid;
+      /// values of the run start from runIndex*(numberOfADCBins + 1)
+      std::vector<float> runTable;
+   };
+   /// @brief Fills values of the function at the nodes of ADC grid starting from table
+   void FillTable(TF1& func, float *table) const;
+   /// @brief Returns the value linearly interpolated between the nodes of the table for the ADC
+   double Interpolate(const float *table, const double adc) const;
+   /// @brief Returns the values of the table of the run or nullptr if the run was not calibrated
+   const float *GetRunTable(const Sector& sector, const int runNumber) const;
+   /// t vs ADC fit function of the towers
+   std::string towerOffsetFunc;
+   /// tcorr mean vs ADC fit function of the runs
+   std::string runOffsetFunc;
+   /// Lower edge of ADC grid
+   double adcMin = 0.;
+   /// Upper edge of ADC grid
+   double adcMax = 0.;
+   /// Number of intervals of ADC grid
+   unsigned int numberOfADCBins = 0;
+   /// Inverse of the width of the interval of ADC grid
+   double inverseADCBinWidth = 0.;
+   /// Lookup tables of all sectors
+   std::vector<Sector> sectors;
+};
+
+#endif /* EMC_TIMING_CORRECTION_HPP */
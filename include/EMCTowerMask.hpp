@@ -0,0 +1,87 @@
+/**
+ *  @file   EMCTowerMask.hpp
+ *  @brief  Contains declaration of class EMCTowerMask
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_TOWER_MASK_HPP
+#define EMC_TOWER_MASK_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+#include "ErrorHandler.hpp"
+
+/*! @class EMCTowerMask
+ * @brief Class EMCTowerMask stores the status (ok, empty, low statistics, hot) of every tower of the EMCal sector
+ *
+ * The mask is produced by EMCTTowerMask from a single pass over raw_sum.root and is written in CalibrationParameters/tower_mask_<sector>.txt. The first line of the file contains the number of y and z towers; each next line corresponds to one y tower and contains the statuses of all z towers. Other EMCTiming programs read this file to skip known bad towers before any projection or fit is made.
+ */
+class EMCTowerMask
+{
+   public:
+
+   /// Status of the tower
+   enum TowerStatus
+   {
+      /// tower can be calibrated
+      OK = 0,
+      /// tower has no entries above fit_adc_min
+      EMPTY = 1,
+      /// tower has entries but their number is insufficient for the fit
+      LOW_STAT = 2,
+      /// tower occupancy or timing spread is anomalously large compared to the rest of the sector
+      HOT = 3
+   };
+   ///@brief Default constructor
+   EMCTowerMask();
+   /*! @brief Constructor with parameters; all towers are marked as OK
+    * @param[in] numberOfYTowers number of towers along y axis
+    * @param[in] numberOfZTowers number of towers along z axis
+    */
+   EMCTowerMask(const int numberOfYTowers, const int numberOfZTowers);
+   /*! @brief Resets the mask to the specified size; all towers are marked as OK
+    * @param[in] numberOfYTowers number of towers along y axis
+    * @param[in] numberOfZTowers number of towers along z axis
+    */
+   void Init(const int numberOfYTowers, const int numberOfZTowers);
+   /*! @brief Reads the mask from the file. Returns false if the file does not exist in which case the mask is left unchanged
+    * If the number of towers in the file does not match the current size of the mask (when it was initialized) EMCTowerMask will print error and exit the program with exit code 1.
+    * @param[in] fileName name of the file
+    */
+   bool ReadFile(const std::string& fileName);
+   /*! @brief Writes the mask in the file
+    * @param[in] fileName name of the file
+    */
+   void WriteFile(const std::string& fileName) const;
+   /// @brief Sets the status of the tower with indices iy and iz
+   void SetStatus(const int iy, const int iz, const TowerStatus status);
+   /// @brief Returns the status of the tower with indices iy and iz
+   TowerStatus GetStatus(const int iy, const int iz) const;
+   /// @brief Returns true if the tower with indices iy and iz can be calibrated
+   bool IsGood(const int iy, const int iz) const;
+   /// @brief Returns the number of towers with the specified status
+   unsigned long GetNumberOfTowers(const TowerStatus status) const;
+   /// @brief Returns the number of towers along y axis
+   int GetNumberOfYTowers() const;
+   /// @brief Returns the number of towers along z axis
+   int GetNumberOfZTowers() const;
+   /// @brief Default destructor
+   virtual ~EMCTowerMask();
+
+   private:
+
+   /// Number of towers along y axis
+   int numberOfYTowers = 0;
+   /// Number of towers along z axis
+   int numberOfZTowers = 0;
+   /// Statuses of the towers; index is iy*numberOfZTowers + iz
+   std::vector<unsigned char> towerStatus;
+};
+
+#endif /* EMC_TOWER_MASK_HPP */
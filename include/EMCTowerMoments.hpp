@@ -0,0 +1,100 @@
+/**
+ *  @file   EMCTowerMoments.hpp
+ *  @brief  Contains declaration of class EMCTowerMoments
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_TOWER_MOMENTS_HPP
+#define EMC_TOWER_MOMENTS_HPP
+
+#include <string>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <filesystem>
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TNamed.h"
+
+#include "ErrorHandler.hpp"
+
+/*! @class EMCTowerMoments
+ * @brief Class EMCTowerMoments accumulates ADC-binned moments of traw for every tower of the EMCal sector
+ *
+ * For every tower and ADC bin the sum of entries, the sum of traw, the sum of traw squared, and the edges of the first and the last occupied traw bins are stored. These values are sufficient to reproduce the distribution of means of traw vs ADC that is approximated in EMCTTowerOffset; hence new input files can be added to the accumulated moments without reading the previously added data again. Names of the added files are stored together with the moments so that every file is added only once.
+ */
+class EMCTowerMoments
+{
+   public:
+
+   ///@brief Default constructor
+   EMCTowerMoments();
+   /*! @brief Reads the moments from the file. Returns false if the file does not exist in which case the moments are left unchanged
+    * @param[in] fileName name of the file
+    */
+   bool ReadFile(const std::string& fileName);
+   /*! @brief Writes the moments in the file
+    * @param[in] fileName name of the file
+    */
+   void WriteFile(const std::string& fileName) const;
+   /*! @brief Adds the moments of all z towers of the specified y tower from the histogram traw vs ADC vs iz. Moments are initialized with the ADC binning of the first added histogram; if the binning of the next histograms differs EMCTowerMoments will print error and exit the program with exit code 1.
+    * @param[in] distrTVsADCVsZTower histogram traw vs ADC vs iz for the y tower
+    * @param[in] yTowerIndex y index of the tower
+    * @param[in] numberOfYTowers number of towers along y axis
+    */
+   void Add(const TH3D *distrTVsADCVsZTower, const int yTowerIndex, const int numberOfYTowers);
+   /// @brief Returns true if the file with the specified name was added to the moments
+   bool IsFileAdded(const std::string& fileName) const;
+   /// @brief Marks the file with the specified name as added to the moments
+   void SetFileAdded(const std::string& fileName);
+   /// @brief Returns true if no histograms were added to the moments
+   bool IsEmpty() const;
+   /// @brief Returns the number of entries of the tower with indices iy and iz for ADC bins starting from firstADCBin
+   double GetEntries(const int iy, const int iz, const int firstADCBin) const;
+   /*! @brief Fills the distribution of means of traw vs ADC of the tower with indices iy and iz for ADC bins starting from firstADCBin. minT and maxT are set to the lower edge of the first and upper edge of the last occupied traw bins respectively
+    * @param[in] iy y index of the tower
+    * @param[in] iz z index of the tower
+    * @param[in] firstADCBin first ADC bin
+    * @param[out] meanDistr distribution of means; must have the same binning as the ADC axis (see GetADCAxis)
+    * @param[out] minT lower edge of the first occupied traw bin
+    * @param[out] maxT upper edge of the last occupied traw bin
+    */
+   void FillMeanDistr(const int iy, const int iz, const int firstADCBin,
+                      TH1D& meanDistr, double& minT, double& maxT) const;
+   /// @brief Returns the number of entries of the tower with indices iy and iz at the moment of the last fit
+   double GetEntriesAtLastFit(const int iy, const int iz) const;
+   /// @brief Sets the number of entries of the tower with indices iy and iz at the moment of the last fit
+   void SetEntriesAtLastFit(const int iy, const int iz, const double entries);
+   /// @brief Returns ADC axis of the moments
+   const TAxis *GetADCAxis() const;
+   /// @brief Default destructor
+   virtual ~EMCTowerMoments();
+
+   private:
+
+   /// @brief Creates empty containers for moments with the specified number of towers and binning of ADC
+   void Init(const int numberOfYTowers, const int numberOfZTowers, const TAxis *adcAxis);
+   /// Number of towers along z axis
+   int numberOfZTowers = 0;
+   /// Sum of entries; x is the tower index (iy*numberOfZTowers + iz), y is ADC
+   std::unique_ptr<TH2D> sumW;
+   /// Sum of entries times traw; x is the tower index, y is ADC
+   std::unique_ptr<TH2D> sumWT;
+   /// Sum of entries times traw squared; x is the tower index, y is ADC
+   std::unique_ptr<TH2D> sumWT2;
+   /// Lower edge of the first occupied traw bin; x is the tower index, y is ADC
+   std::unique_ptr<TH2D> minT;
+   /// Upper edge of the last occupied traw bin; x is the tower index, y is ADC
+   std::unique_ptr<TH2D> maxT;
+   /// Number of entries of every tower at the moment of its last fit; x is iz, y is iy
+   std::unique_ptr<TH2D> entriesAtLastFit;
+   /// Names of the files that were added to the moments
+   std::set<std::string> addedFileNames;
+};
+
+#endif /* EMC_TOWER_MOMENTS_HPP */
@@ -0,0 +1,76 @@
+/**
+ *  @file   EMCTowerOffsetTable.hpp
+ *  @brief  Contains declaration of class EMCTowerOffsetTable
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_TOWER_OFFSET_TABLE_HPP
+#define EMC_TOWER_OFFSET_TABLE_HPP
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+
+#include "ErrorHandler.hpp"
+#include "MathTools.hpp"
+
+/*! @class EMCTowerOffsetTable
+ * @brief Class EMCTowerOffsetTable reads the parameters of t vs ADC fits for every tower from tower_offset_<sector>.txt file produced by EMCTTowerOffset
+ *
+ * The parameters are stored in flat arrays indexed by iy*numberOfZTowers + iz so that the access to the parameters of any tower does not require any search.
+ */
+class EMCTowerOffsetTable
+{
+   public:
+
+   ///@brief Default constructor
+   EMCTowerOffsetTable();
+   /*! @brief Constructor with parameters
+    * See EMCTowerOffsetTable::ReadFile(const std::string& fileName) for details
+    */
+   EMCTowerOffsetTable(const std::string& fileName);
+   /*! @brief Reads the parameters from the file. Returns false if the file does not exist
+    * If the file is corrupted or the number of parameters is not the same for all towers EMCTowerOffsetTable will print error and exit the program with exit code 1.
+    * @param[in] fileName name of the file (CalibrationParameters/tower_offset_<sector>.txt)
+    */
+   bool ReadFile(const std::string& fileName);
+   /// @brief Returns true if t vs ADC fit was succesfully performed for the tower with indices iy and iz
+   bool IsCalibrated(const int iy, const int iz) const;
+   /// @brief Returns pointer to the parameters of the tower with indices iy and iz
+   const double *GetParameters(const int iy, const int iz) const;
+   /// @brief Returns the number of parameters of t vs ADC fit function
+   int GetNumberOfParameters() const;
+   /*! @brief Returns the RMS of the parameter over all calibrated towers (0 if there are no calibrated towers)
+    * @param[in] parIndex index of the parameter
+    */
+   double GetParameterRMS(const int parIndex) const;
+   /// @brief Returns the number of towers along y axis
+   int GetNumberOfYTowers() const;
+   /// @brief Returns the number of towers along z axis
+   int GetNumberOfZTowers() const;
+   /// @brief Default destructor
+   virtual ~EMCTowerOffsetTable();
+
+   private:
+
+   /// Number of towers along y axis
+   int numberOfYTowers = 0;
+   /// Number of towers along z axis
+   int numberOfZTowers = 0;
+   /// Number of parameters of t vs ADC fit function
+   int numberOfParameters = 0;
+   /// Flags that show whether the fit was performed for the tower; index is iy*numberOfZTowers + iz
+   std::vector<unsigned char> isTowerCalibrated;
+   /// Parameters of all towers; parameters of the tower start from (iy*numberOfZTowers + iz)*numberOfParameters
+   std::vector<double> parameters;
+   /// RMS of every parameter over all calibrated towers
+   std::vector<double> parametersRMS;
+};
+
+#endif /* EMC_TOWER_OFFSET_TABLE_HPP */
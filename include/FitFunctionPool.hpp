@@ -0,0 +1,70 @@
+/**
+ *  @file   FitFunctionPool.hpp
+ *  @brief  Contains declaration of class FitFunctionPool
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef FIT_FUNCTION_POOL_HPP
+#define FIT_FUNCTION_POOL_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "TF1.h"
+#include "TAttLine.h"
+
+/*! @class FitFunctionPool
+ * @brief Class FitFunctionPool owns the fit functions and reuses them instead of constructing new functions from the same formula for every fit
+ *
+ * Functions are kept per model (formula). Constructing TF1 from the formula parses and compiles it which is the most expensive part of its construction; the pool constructs the function of the model only if all functions of this model are used, otherwise it returns the free one reset to the state of the newly constructed function: parameters and their errors are 0, parameters are released (have no limits), range and line attributes are the ones the function had after construction. Functions returned by Get are owned by the pool and are valid until Recycle is called after which all of them are free again; hence the number of constructed functions is determined by the largest number of functions used between 2 calls of Recycle and not by the number of fits. Functions are not added to the global list of functions of ROOT so that functions with the same names do not replace each other there.
+ */
+class FitFunctionPool
+{
+   public:
+
+   ///@brief Default constructor
+   FitFunctionPool();
+   /*! @brief Returns the free function of the model; the function is constructed if there is no such free function
+    * @param[in] name name of the function
+    * @param[in] formula formula of the function (model)
+    * @param[in] xMin minimum of the range of the function
+    * @param[in] xMax maximum of the range of the function
+    */
+   TF1 *Get(const std::string& name, const std::string& formula,
+            const double xMin = 0., const double xMax = 1.);
+   /// @brief Makes all functions free; functions returned before can not be used after this call
+   void Recycle();
+   /// @brief Returns the number of constructed functions
+   unsigned long GetNumberOfFunctions() const;
+   /// @brief Default destructor
+   virtual ~FitFunctionPool();
+
+   private:
+
+   /// @brief Function owned by the pool
+   struct PooledFunction
+   {
+      /// function
+      std::unique_ptr<TF1> function;
+      /// line attributes of the function after construction
+      TAttLine lineAttributes;
+      /// whether the function is used since the last call of Recycle
+      bool isUsed = true;
+   };
+   /*! @brief Resets the function to the state of the newly constructed one
+    * @param[in] pooledFunction function that is reset
+    * @param[in] name name of the function
+    * @param[in] xMin minimum of the range of the function
+    * @param[in] xMax maximum of the range of the function
+    */
+   static void Reset(PooledFunction& pooledFunction, const std::string& name,
+                     const double xMin, const double xMax);
+   /// Functions of each model
+   std::map<std::string, std::vector<PooledFunction>> functions;
+};
+
+#endif /* FIT_FUNCTION_POOL_HPP */
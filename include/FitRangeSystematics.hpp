@@ -0,0 +1,67 @@
+/**
+ *  @file   FitRangeSystematics.hpp
+ *  @brief  Contains declaration of class FitRangeSystematics
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef FIT_RANGE_SYSTEMATICS_HPP
+#define FIT_RANGE_SYSTEMATICS_HPP
+
+#include <cmath>
+#include <vector>
+#include <utility>
+
+#include "TH1.h"
+#include "TF1.h"
+
+#include "ErrorHandler.hpp"
+#include "MathTools.hpp"
+
+/*! @class FitRangeSystematics
+ * @brief Class FitRangeSystematics estimates the systematic uncertainties of the mean and the sigma of the gaussian peak that originate from the choice of the range of the fit without refitting the histogram in the varied ranges
+ *
+ * Ranges (windows) are set in sigmas of the peak relative to its mean, e.g. {-2., 2.} stands for mean ± 2*sigma. In every window the mean and the RMS of the bin contents are calculated after the subtraction of the fitted background; the RMS is corrected for the bin width and both values are corrected analytically for the truncation of the gaussian by the window (including asymmetric windows). The uncertainties are the RMS of the deviations of the values from all windows from the mean and the sigma of the main fit. Windows with less than minNumberOfBins bins or with no signal after the background subtraction are skipped.
+ */
+class FitRangeSystematics
+{
+   public:
+
+   ///@brief Default constructor
+   FitRangeSystematics();
+   /*! @brief Constructor with parameters
+    * @param[in] windows lower and upper edges of the windows in sigmas relative to the mean
+    */
+   FitRangeSystematics(const std::vector<std::pair<double, double>>& windows);
+   /*! @brief Estimates the uncertainties for the peak in the histogram. Returns true if at least 1 window was used
+    * @param[in] hist histogram with the peak
+    * @param[in] backgroundFunc fitted background that is subtracted from the bin contents
+    * @param[in] mean mean of the peak from the main fit
+    * @param[in] sigma sigma of the peak from the main fit
+    */
+   bool Estimate(const TH1 *hist, const TF1& backgroundFunc, const double mean, const double sigma);
+   /// @brief Returns the systematic uncertainty of the mean from the last estimate
+   double GetMeanError() const;
+   /// @brief Returns the systematic uncertainty of the sigma from the last estimate
+   double GetSigmaError() const;
+   /// @brief Returns the number of windows used in the last estimate
+   unsigned int GetNumberOfUsedWindows() const;
+   /// @brief Default destructor
+   virtual ~FitRangeSystematics();
+
+   private:
+
+   /// Lower and upper edges of the windows in sigmas relative to the mean
+   std::vector<std::pair<double, double>> windows;
+   /// Minimum number of bins in the window for it to be used
+   int minNumberOfBins = 3;
+   /// Systematic uncertainty of the mean
+   double meanError = 0.;
+   /// Systematic uncertainty of the sigma
+   double sigmaError = 0.;
+   /// Number of windows used in the last estimate
+   unsigned int numberOfUsedWindows = 0;
+};
+
+#endif /* FIT_RANGE_SYSTEMATICS_HPP */
@@ -0,0 +1,123 @@
+/**
+ *  @file   FitStrategyLadder.hpp
+ *  @brief  Contains declaration of class FitStrategyLadder
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef FIT_STRATEGY_LADDER_HPP
+#define FIT_STRATEGY_LADDER_HPP
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <functional>
+
+#include "TF1.h"
+#include "Math/MinimizerOptions.h"
+
+#include "yaml-cpp/yaml.h"
+
+#include "ErrorHandler.hpp"
+#include "StrTools.hpp"
+
+/*! @class FitStrategyLadder
+ * @brief Class FitStrategyLadder performs the approximation with the sequence of increasingly expensive methods (tiers) until the result of one of them is accepted
+ *
+ * The ladder is read from .yaml node that contains the list of tiers and the maximum chi2/NDF of the accepted fit:
+ * @code
+ * max_chi2_ndf: 10.
+ * tiers:
+ *   - {method: "estimate"}
+ *   - {method: "fit", options: "RQBN", strategy: 0, number_of_tries: 1}
+ *   - {method: "fit", options: "RQMBN", strategy: 1, number_of_tries: 5}
+ *   - {method: "fit", options: "RQMBNE", strategy: 2, number_of_tries: 5}
+ * @endcode
+ * Tier with method "estimate" calls the fit-free estimate provided by the caller (e.g. RobustPeakEstimator). Tier with method "fit" calls the fit provided by the caller number_of_tries times with the options of the tier (options of TH1::Fit; e.g. "M" for IMPROVE and "E" for Minos errors) while Minuit strategy of the tier is set as default. The result of the fit tier is accepted if the status of the last try is 0 and the quality checks of the caller pass (see IsFitGood). The next tier is called only if the result of the previous one is not accepted; if no tier is accepted the result of the last one is kept. The number of calls, of accepted results, and the time spent in every tier are accumulated and can be printed or written in the file; files written by the processes that used the same ladder can be summed with AddStatistics.
+ */
+class FitStrategyLadder
+{
+   public:
+
+   /// @brief Method of the tier
+   enum class Method {ESTIMATE, FIT};
+   /// @brief Tier of the ladder
+   struct Tier
+   {
+      /// method of the tier
+      Method method = Method::FIT;
+      /// options of TH1::Fit
+      std::string options;
+      /// Minuit strategy (0, 1, or 2)
+      int strategy = 1;
+      /// number of consecutive fits
+      unsigned int numberOfTries = 1;
+   };
+   ///@brief Default constructor
+   FitStrategyLadder();
+   /*! @brief Constructor with parameters
+    * @param[in] name name of the ladder (for messages)
+    * @param[in] ladder .yaml node with the ladder (see the description of the class)
+    */
+   FitStrategyLadder(const std::string& name, const YAML::Node& ladder);
+   /*! @brief Calls the tiers one by one until the result of one of them is accepted. Returns true if the result was accepted
+    * @param[in] estimate fit-free estimate called by the tiers with method "estimate"; returns true if the estimate passed its quality checks
+    * @param[in] fit fit called by the tiers with method "fit" with the tier and the index of the try; returns the status of the fit. Try 0 should start from the initial parameters so that the tier does not continue from the rejected result of the previous one
+    * @param[in] isAccepted quality checks of the result of the fit
+    */
+   bool Run(const std::function<bool()>& estimate,
+            const std::function<int(const Tier&, const unsigned int)>& fit,
+            const std::function<bool()>& isAccepted);
+   /// @brief Returns the tier the result of which was kept in the last call of Run
+   const Tier& GetLastTier() const;
+   /*! @brief Returns true if the parameters of the function and their errors are finite and chi2/NDF does not exceed max_chi2_ndf
+    * @param[in] func function after the fit
+    */
+   bool IsFitGood(const TF1& func) const;
+   /// @brief Prints the number of calls, of accepted results, and the time of every tier
+   void PrintStatistics() const;
+   /*! @brief Writes the number of calls, of accepted results, and the time of every tier in the file (1 line per tier)
+    * @param[in] fileName name of the file
+    */
+   void WriteStatistics(const std::string& fileName) const;
+   /*! @brief Adds the statistics written by WriteStatistics of the ladder with the same tiers (e.g. by the subprocesses that processed different parts of the data)
+    * @param[in] fileName name of the file
+    */
+   void AddStatistics(const std::string& fileName);
+   /// @brief Default destructor
+   virtual ~FitStrategyLadder();
+
+   private:
+
+   /// @brief Statistics of the tier
+   struct TierStatistics
+   {
+      /// number of calls of the tier
+      unsigned long numberOfCalls = 0;
+      /// number of accepted results of the tier
+      unsigned long numberOfAccepted = 0;
+      /// time spent in the tier [s]
+      double time = 0.;
+   };
+   /*! @brief Returns the short description of the tier
+    * @param[in] tier tier
+    */
+   static std::string GetDescription(const Tier& tier);
+   /// Name of the ladder
+   std::string name;
+   /// Tiers of the ladder
+   std::vector<Tier> tiers;
+   /// Statistics of the tiers
+   std::vector<TierStatistics> tiersStatistics;
+   /// Number of calls of Run in which no result was accepted
+   unsigned long numberOfUnaccepted = 0;
+   /// Maximum chi2/NDF of the accepted fit; 0 if chi2/NDF is not checked
+   double maxChi2NDF = 0.;
+   /// Index of the tier the result of which was kept in the last call of Run
+   unsigned long lastTierIndex = 0;
+};
+
+#endif /* FIT_STRATEGY_LADDER_HPP */
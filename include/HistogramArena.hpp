@@ -0,0 +1,121 @@
+/**
+ *  @file   HistogramArena.hpp
+ *  @brief  Contains declaration of class HistogramArena
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef HISTOGRAM_ARENA_HPP
+#define HISTOGRAM_ARENA_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TAxis.h"
+#include "TList.h"
+#include "TArrayD.h"
+
+/*! @class HistogramArena
+ * @brief Class HistogramArena owns the histograms that are used as buffers for the projections and reuses them instead of allocating new histograms for every projection
+ *
+ * Projections are filled in place in the free buffer with the same binning as the projected axes; the new buffer is allocated only if there is no such free buffer. Buffers returned by the projection functions are owned by the arena and are valid until Recycle is called after which all of them are free again and are reused by the next projections; hence the number of allocated histograms is determined by the largest number of projections used between 2 calls of Recycle (e.g. the number of pT bins drawn on one canvas) and not by the total number of projections. Projections have the same contents, errors, names, and axes as the ones produced by ROOT; ranges of bins outside of the axis are clamped to underflow and overflow bins and empty ranges (last bin is smaller than the first one) stand for all bins including underflow and overflow the same way as in ROOT. The same as in ROOT only the bins in the range of the projected axes (see TAxis::SetRange) are projected if the range is set; unlike ROOT the projections always keep all bins of the projected axes (the same as ROOT projections with option "o") and the bins outside of the range are empty.
+ */
+class HistogramArena
+{
+   public:
+
+   ///@brief Default constructor
+   HistogramArena();
+   /*! @brief Returns the projection of the 2D histogram on Y axis (same as TH2::ProjectionY)
+    * @param[in] hist histogram that is projected
+    * @param[in] name name of the projection
+    * @param[in] firstXBin first X bin of the projected range
+    * @param[in] lastXBin last X bin of the projected range
+    */
+   TH1D *ProjectionY(const TH2 *hist, const std::string& name,
+                     const int firstXBin, const int lastXBin);
+   /*! @brief Returns the projection of the 3D histogram on X axis (same as TH3::ProjectionX)
+    * @param[in] hist histogram that is projected
+    * @param[in] name name of the projection
+    * @param[in] firstYBin first Y bin of the projected range
+    * @param[in] lastYBin last Y bin of the projected range
+    * @param[in] firstZBin first Z bin of the projected range
+    * @param[in] lastZBin last Z bin of the projected range
+    */
+   TH1D *ProjectionX(const TH3 *hist, const std::string& name,
+                     const int firstYBin, const int lastYBin,
+                     const int firstZBin, const int lastZBin);
+   /*! @brief Returns the projection of the 3D histogram in which X axis is Y axis of the histogram and Y axis is X axis of the histogram (same as TH3::Project3D("xy") with the range of Z axis set)
+    * @param[in] hist histogram that is projected
+    * @param[in] name name of the projection
+    * @param[in] firstZBin first Z bin of the projected range
+    * @param[in] lastZBin last Z bin of the projected range
+    */
+   TH2D *ProjectionXY(const TH3 *hist, const std::string& name,
+                      const int firstZBin, const int lastZBin);
+   /// @brief Makes all buffers free; histograms returned before can not be used after this call
+   void Recycle();
+   /*! @brief Makes the buffer free so that it is reused by the next projection before Recycle is called (e.g. for projections that are used only in one iteration of the loop); the buffer can not be used after this call
+    * @param[in] buffer histogram returned by one of the projection functions
+    */
+   void Release(const TH1 *buffer);
+   /// @brief Returns the number of allocated buffers
+   unsigned long GetNumberOfBuffers() const;
+   /// @brief Default destructor
+   virtual ~HistogramArena();
+
+   private:
+
+   /*! @brief Returns true if the axes have the same bins
+    * @param[in] axis1 first axis
+    * @param[in] axis2 second axis
+    */
+   static bool IsSameBinning(const TAxis *axis1, const TAxis *axis2);
+   /*! @brief Clamps the range of bins to the axis the same way as ROOT does for projections
+    * @param[in] axis axis of the range
+    * @param[in,out] firstBin first bin of the range
+    * @param[in,out] lastBin last bin of the range
+    */
+   static void ClampRange(const TAxis *axis, int& firstBin, int& lastBin);
+   /*! @brief Returns the range of bins of the projected axis: the range set with TAxis::SetRange if it is set; else all bins including underflow and overflow
+    * @param[in] axis projected axis
+    * @param[out] firstBin first bin of the range
+    * @param[out] lastBin last bin of the range
+    */
+   static void GetProjectedRange(const TAxis *axis, int& firstBin, int& lastBin);
+   /*! @brief Prepares the buffer to be filled: empties it and sets the same name, titles, and errors as the projection produced by ROOT would have
+    * @param[in] buffer buffer that is prepared
+    * @param[in] hist histogram that is projected
+    * @param[in] name name of the projection
+    */
+   static void PrepareBuffer(TH1 *buffer, const TH1 *hist, const std::string& name);
+   /*! @brief Returns the free 1D buffer with the same binning as the axis; the buffer is allocated if there is no such free buffer
+    * @param[in] hist histogram that is projected
+    * @param[in] axis projected axis
+    * @param[in] name name of the projection
+    */
+   TH1D *Get1DBuffer(const TH1 *hist, const TAxis *axis, const std::string& name);
+   /*! @brief Returns the free 2D buffer with the same binning as the axes; the buffer is allocated if there is no such free buffer
+    * @param[in] hist histogram that is projected
+    * @param[in] xAxis axis projected on X axis of the buffer
+    * @param[in] yAxis axis projected on Y axis of the buffer
+    * @param[in] name name of the projection
+    */
+   TH2D *Get2DBuffer(const TH1 *hist, const TAxis *xAxis, const TAxis *yAxis,
+                     const std::string& name);
+   /// 1D buffers
+   std::vector<std::unique_ptr<TH1D>> buffers1D;
+   /// 2D buffers
+   std::vector<std::unique_ptr<TH2D>> buffers2D;
+   /// Whether the 1D buffers are used since the last call of Recycle
+   std::vector<bool> isBuffer1DUsed;
+   /// Whether the 2D buffers are used since the last call of Recycle
+   std::vector<bool> isBuffer2DUsed;
+};
+
+#endif /* HISTOGRAM_ARENA_HPP */
@@ -0,0 +1,88 @@
+/**
+ *  @file   InputHistogramMerger.hpp
+ *  @brief  Contains declaration of class InputHistogramMerger
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef INPUT_HISTOGRAM_MERGER_HPP
+#define INPUT_HISTOGRAM_MERGER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TROOT.h"
+
+#include "ErrorHandler.hpp"
+
+/*! @class InputHistogramMerger
+ * @brief Class InputHistogramMerger reads histograms from one or several ROOT files and sums them in memory
+ *
+ * Can be used instead of the file produced by hadd: every requested histogram is summed over all input files. Files are distributed between threads each of which sums the histograms from its files in its own accumulator; the accumulators are then summed pairwise in parallel (tree reduction). Histograms that are needed together should be requested with InputHistogramMerger::Merge so that every file is opened only once for all of them. Merged histograms are kept until they are released (see InputHistogramMerger::Release and InputHistogramMerger::Clear) so that every histogram is merged only once.
+ */
+class InputHistogramMerger
+{
+   public:
+
+   ///@brief Default constructor
+   InputHistogramMerger();
+   /*! @brief Constructor with parameters
+    * See InputHistogramMerger::AddInput(const std::string& inputPath) for details
+    */
+   InputHistogramMerger(const std::string& inputPath);
+   /*! @brief Adds the input files. If the path is a directory all .root files from it are added; if the path is a .root file only this file is added; otherwise the path is treated as a text file with the list of .root files (one per line; empty lines and lines starting with # are ignored). If the path does not exist InputHistogramMerger will print error and exit the program with exit code 1.
+    * @param[in] inputPath directory, .root file, or list of .root files
+    */
+   void AddInput(const std::string& inputPath);
+   /*! @brief Sets the number of threads that are used for merging
+    * @param[in] numberOfThreads number of threads
+    */
+   void SetNumberOfThreads(const unsigned int numberOfThreads);
+   /*! @brief Sums the histograms over all input files in a single pass over the files. Histograms that were already merged are not read again. Histograms that are absent in some files are summed over the rest of the files
+    * @param[in] histNames names of the histograms
+    */
+   void Merge(const std::vector<std::string>& histNames);
+   /*! @brief Returns the histogram summed over all input files; the histogram is merged if it was not merged before (see InputHistogramMerger::Merge). Returns nullptr if the histogram does not exist in any of the files. Returned histogram is owned by InputHistogramMerger and is valid until it is released
+    * @param[in] histName name of the histogram
+    */
+   TH1 *Get(const std::string& histName);
+   /*! @brief Deletes the merged histogram; it will be merged again if it is requested later
+    * @param[in] histName name of the histogram
+    */
+   void Release(const std::string& histName);
+   /// @brief Deletes all merged histograms
+   void Clear();
+   /// @brief Returns the number of input files
+   unsigned long GetNumberOfFiles() const;
+   /// @brief Returns the name of the input (for messages)
+   std::string GetName() const;
+   /// @brief Default destructor
+   virtual ~InputHistogramMerger();
+
+   private:
+
+   /// @brief Sums the histograms from files with indices firstFileIndex, firstFileIndex + step, ... into accumulators (one per histogram)
+   void MergeFiles(const std::vector<std::string>& histNames, const unsigned long firstFileIndex,
+                   const unsigned long step, 
+                   std::vector<std::unique_ptr<TH1>>& accumulators) const;
+   /// Names of input files; set is used so that the order of the files does not depend on the file system
+   std::set<std::string> inputFileNames;
+   /// Names of added inputs
+   std::string inputName;
+   /// Number of threads that are used for merging
+   unsigned int numberOfThreads = 1;
+   /// Merged histograms; histograms that are absent in all files are stored as nullptr
+   std::map<std::string, std::unique_ptr<TH1>> mergedHists;
+};
+
+#endif /* INPUT_HISTOGRAM_MERGER_HPP */
@@ -0,0 +1,106 @@
+/**
+ *  @file   MemoryBudget.hpp
+ *  @brief  Contains declaration of class MemoryBudget
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef MEMORY_BUDGET_HPP
+#define MEMORY_BUDGET_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+#include <unistd.h>
+
+#include "ErrorHandler.hpp"
+#include "IOTools.hpp"
+#include "MathTools.hpp"
+
+/*! @class MemoryBudget
+ * @brief Class MemoryBudget admits subprocesses only while the memory they are expected to use fits in the budget
+ *
+ * Every admitted subprocess reports its current and peak resident memory (see MemoryUsageReporter) in the file passed to it via environment variable (see GetEnvironment). Subprocesses are split in groups that are expected to use similar amount of memory (e.g. units of the same stage); the expected memory of the subprocess is the largest final peak memory of the finished subprocesses of its group (the memory of the running subprocess can still grow hence its reports are not used for the other subprocesses). The subprocess is admitted if the sum of the expected memory of the running subprocesses (or of their peak memory if it is larger) and of the new one does not exceed the budget. Until one subprocess of the group has finished and reported its final peak memory the expected memory of the subprocess of the group is the default one (see the constructor) or the largest peak memory reported by the running subprocesses of the group if it is larger. A subprocess is always admitted if no other subprocesses are running so that the budget smaller than the memory of one subprocess does not stop the calculations.
+ */
+class MemoryBudget
+{
+   public:
+
+   ///@brief Default constructor
+   MemoryBudget();
+   /*! @brief Constructor
+    * @param[in] budget memory budget [MB]; if it is 0 the budget is 90% of the memory limit of the cgroup of the process or of the total memory if the limit is not set
+    * @param[in] subprocessMemory expected memory [MB] of the subprocess of the group none of which has finished yet; if it is 0 the budget is split equally between the hardware threads
+    */
+   MemoryBudget(const double budget, const double subprocessMemory = 0.);
+   /*! @brief Admits the subprocess of the group if it fits in the budget and returns its index; returns -1 if it does not fit
+    * @param[in] group name of the group of the subprocess
+    */
+   long TryAdmit(const std::string& group);
+   /*! @brief Waits until the subprocess of the group fits in the budget, admits it, and returns its index
+    * @param[in] group name of the group of the subprocess
+    */
+   unsigned long Admit(const std::string& group);
+   /*! @brief Returns the shell variable assignment that is put before the command of the admitted subprocess so that it reports its memory
+    * @param[in] index index of the subprocess returned by TryAdmit or Admit
+    */
+   std::string GetEnvironment(const unsigned long index) const;
+   /*! @brief Marks the subprocess as finished and updates the expected memory of its group with its final report
+    * @param[in] index index of the subprocess returned by TryAdmit or Admit
+    */
+   void Release(const unsigned long index);
+   /// @brief Returns the memory budget [MB]
+   double GetBudget() const;
+   /// @brief Returns the memory limit [MB] of the cgroup of the process or the total memory if the limit is not set
+   static double GetMemoryLimit();
+   /// @brief Default destructor
+   virtual ~MemoryBudget();
+
+   private:
+
+   /// @brief Subprocess admitted by the budget
+   struct Subprocess
+   {
+      /// name of the group of the subprocess
+      std::string group;
+      /// name of the file in which the subprocess writes its memory usage
+      std::string reportFileName;
+      /// last reported peak memory [MB]; 0 if the subprocess has not reported yet
+      double peakMemory = 0.;
+      /// whether the subprocess is running
+      bool isRunning = true;
+   };
+   /*! @brief Reads the last report of the subprocess and updates its peak memory
+    * @param[in] subprocess subprocess which report is read
+    */
+   void ReadReport(Subprocess& subprocess);
+   /*! @brief Returns the largest final peak memory of the finished subprocesses of the group; 0 if none of them has finished
+    * @param[in] group name of the group
+    */
+   double GetGroupPeakMemory(const std::string& group) const;
+   /// Expected memory [MB] of the subprocess of the group none of which has finished yet
+   double subprocessMemory = 0.;
+   /// Number of objects of this class created in the process (used to separate their reports)
+   inline static std::atomic<unsigned long> numberOfCreatedBudgets{0};
+   /// Memory budget [MB]
+   double budget = 0.;
+   /// Directory in which the subprocesses write their reports
+   std::string reportDir;
+   /// Admitted subprocesses
+   std::vector<Subprocess> subprocesses;
+   /// Largest final peak memory [MB] of the finished subprocesses of each group; groups without finished subprocesses are absent
+   std::map<std::string, double> groupPeakMemory;
+   /// Mutex for the access from several threads
+   mutable std::mutex subprocessesMutex;
+};
+
+#endif /* MEMORY_BUDGET_HPP */
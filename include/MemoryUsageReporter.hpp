@@ -0,0 +1,56 @@
+/**
+ *  @file   MemoryUsageReporter.hpp
+ *  @brief  Contains declaration of class MemoryUsageReporter
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef MEMORY_USAGE_REPORTER_HPP
+#define MEMORY_USAGE_REPORTER_HPP
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+/*! @class MemoryUsageReporter
+ * @brief Class MemoryUsageReporter periodically writes the current and the peak resident memory of the process in the file read by MemoryBudget of the parent process
+ *
+ * The name of the file is taken from environment variable CALPHENIX_MEMORY_REPORT which is set by the parent process for every subprocess (see MemoryBudget::GetEnvironment); if it is not set nothing is written. The file contains 2 values in MB: the current (VmRSS) and the peak (VmHWM) resident memory of the process.
+ */
+class MemoryUsageReporter
+{
+   public:
+
+   ///@brief Default constructor; starts reporting if the parent process requested it
+   MemoryUsageReporter();
+   /*! @brief Reads the current and the peak resident memory [MB] of the current process. Returns false if they can not be read
+    * @param[out] currentMemory current resident memory (VmRSS) [MB]
+    * @param[out] peakMemory peak resident memory (VmHWM) [MB]
+    */
+   static bool ReadMemoryUsage(double& currentMemory, double& peakMemory);
+   /// @brief Default destructor; writes the last report
+   virtual ~MemoryUsageReporter();
+
+   private:
+
+   /// @brief Writes the report in the file (the file is replaced at once so it is never read partially)
+   void WriteReport() const;
+   /// Name of the environment variable with the name of the file
+   inline static const std::string environmentVariableName = "CALPHENIX_MEMORY_REPORT";
+   /// Name of the file in which the reports are written
+   std::string reportFileName;
+   /// Time between the reports
+   const std::chrono::milliseconds reportInterval{500};
+   /// Whether the reporting thread must stop
+   std::atomic<bool> isStopped{false};
+   /// Thread that writes the reports
+   std::thread reportThread;
+};
+
+#endif /* MEMORY_USAGE_REPORTER_HPP */
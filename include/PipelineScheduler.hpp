@@ -0,0 +1,84 @@
+/**
+ *  @file   PipelineScheduler.hpp
+ *  @brief  Contains declaration of class PipelineScheduler
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef PIPELINE_SCHEDULER_HPP
+#define PIPELINE_SCHEDULER_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+#include "ErrorHandler.hpp"
+#include "IOTools.hpp"
+
+#include "ThreadTokenPool.hpp"
+#include "MemoryBudget.hpp"
+
+/*! @class PipelineScheduler
+ * @brief Class PipelineScheduler runs the units of calibration stages (e.g. calibration of one sector or one detector) as separate processes in the order given by their dependencies
+ *
+ * Every unit is a shell command that is run when all units it depends on have finished successfully; units whose dependencies failed are skipped. All units share one budget of threads (see ThreadTokenPool; the budget of the parent process is used if it has one): a unit takes up to its maximum number of threads from the free ones when it is started and returns them when it finishes, so units of different stages run concurrently (e.g. the next stage of one sector starts while the other sectors are still processed by the previous stage). Units are also started only while their memory fits in the memory budget (see MemoryBudget); the memory of the unit is expected from the final peak memory of the finished units of the same group. Ready units are started in the order they were added.
+ */
+class PipelineScheduler
+{
+   public:
+
+   ///@brief Default constructor
+   PipelineScheduler();
+   /*! @brief Adds the unit and returns its index that is passed as a dependency of the other units
+    * @param[in] name name of the unit (for messages)
+    * @param[in] group name of the group of units that use similar amount of memory (e.g. units of the same stage)
+    * @param[in] command function that returns the shell command of the unit for the number of threads given to it
+    * @param[in] maxNumberOfThreads maximum number of threads the unit can use; 0 for the unit that only waits for its subprocesses which take the threads from the shared pool themselves (e.g. program in Mode1)
+    * @param[in] dependencies indices of the units that must finish successfully before the unit is started; only units added before can be dependencies
+    */
+   unsigned long AddUnit(const std::string& name, const std::string& group,
+                         const std::function<std::string(const unsigned int)>& command,
+                         const unsigned int maxNumberOfThreads,
+                         const std::vector<unsigned long>& dependencies = {});
+   /*! @brief Runs all units and returns true if all of them finished successfully
+    * @param[in] numberOfThreads number of threads shared by all units (ignored if the parent process shares its threads)
+    * @param[in] memoryBudget memory [MB] shared by all units; if it is 0 the budget is set from the memory limit (see MemoryBudget)
+    */
+   bool Run(const unsigned int numberOfThreads, const double memoryBudget = 0.);
+   /// @brief Returns the number of added units
+   unsigned long GetNumberOfUnits() const;
+   /// @brief Default destructor
+   virtual ~PipelineScheduler();
+
+   private:
+
+   /// @brief States of the unit
+   enum class UnitStatus {WAITING, RUNNING, SUCCEEDED, FAILED, SKIPPED};
+   /// @brief Unit of the pipeline
+   struct Unit
+   {
+      /// name of the unit
+      std::string name;
+      /// name of the group of units that use similar amount of memory
+      std::string group;
+      /// returns the shell command of the unit for the given number of threads
+      std::function<std::string(const unsigned int)> command;
+      /// maximum number of threads the unit can use; 0 if its subprocesses take the threads themselves
+      unsigned int maxNumberOfThreads;
+      /// indices of the units that must finish successfully before the unit is started
+      std::vector<unsigned long> dependencies;
+      /// state of the unit
+      UnitStatus status = UnitStatus::WAITING;
+      /// time the unit took [s]
+      double time = 0.;
+   };
+   /// Units of the pipeline
+   std::vector<Unit> units;
+};
+
+#endif /* PIPELINE_SCHEDULER_HPP */
@@ -0,0 +1,82 @@
+/**
+ *  @file   RobustPeakEstimator.hpp
+ *  @brief  Contains declaration of class RobustPeakEstimator
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef ROBUST_PEAK_ESTIMATOR_HPP
+#define ROBUST_PEAK_ESTIMATOR_HPP
+
+#include <cmath>
+
+#include "TH1.h"
+
+#include "ErrorHandler.hpp"
+#include "MathTools.hpp"
+
+/*! @class RobustPeakEstimator
+ * @brief Class RobustPeakEstimator estimates the mean and the sigma of the gaussian peak on top of a linear background in 1D histogram without the fit
+ *
+ * The estimate is obtained from bin contents with iterative truncated mean and RMS: at every iteration the mean and the RMS are calculated in the window mean ± nSigma*sigma from the previous iteration after the subtraction of the linear background estimated from the sidebands of the window (from nSigma*sigma to 2*nSigma*sigma on both sides). RMS of the gaussian truncated at ±nSigma*sigma is corrected for the truncation. The first iteration starts from the maximum bin and the RMS of the whole range. The estimate is considered good if the iterations converged, the window contains enough bins, and the fraction of the signal in the window is large enough; otherwise the fit should be used instead.
+ */
+class RobustPeakEstimator
+{
+   public:
+
+   ///@brief Default constructor
+   RobustPeakEstimator();
+   /*! @brief Constructor with parameters
+    * @param[in] nSigma half width of the window in sigmas
+    * @param[in] maxNumberOfIterations maximum number of iterations
+    * @param[in] minSignalFraction minimum fraction of the signal after the background subtraction in the window for the estimate to be considered good
+    */
+   RobustPeakEstimator(const double nSigma, const unsigned int maxNumberOfIterations,
+                       const double minSignalFraction);
+   /*! @brief Estimates the mean and the sigma of the peak in the range of the histogram. Returns true if the estimate passed the quality checks
+    * @param[in] hist histogram with the peak
+    * @param[in] xMin lower edge of the range
+    * @param[in] xMax upper edge of the range
+    */
+   bool Estimate(const TH1 *hist, const double xMin, const double xMax);
+   /// @brief Returns the mean of the peak from the last estimate
+   double GetMean() const;
+   /// @brief Returns the sigma of the peak from the last estimate
+   double GetSigma() const;
+   /// @brief Returns the statistical uncertainty of the mean of the peak from the last estimate
+   double GetMeanError() const;
+   /// @brief Returns the statistical uncertainty of the sigma of the peak from the last estimate
+   double GetSigmaError() const;
+   /// @brief Returns the fraction of the signal in the window from the last estimate
+   double GetSignalFraction() const;
+   /// @brief Returns the number of iterations made in the last estimate
+   unsigned int GetNumberOfIterations() const;
+   /// @brief Default destructor
+   virtual ~RobustPeakEstimator();
+
+   private:
+
+   /// Half width of the window in sigmas
+   double nSigma = 2.5;
+   /// Maximum number of iterations
+   unsigned int maxNumberOfIterations = 20;
+   /// Minimum fraction of the signal in the window for the estimate to be considered good
+   double minSignalFraction = 0.5;
+   /// Minimum number of bins in the window for the estimate to be considered good
+   int minNumberOfBins = 5;
+   /// Iterations stop when the mean and the sigma change by less than this fraction of sigma
+   double tolerance = 1e-3;
+   /// Mean of the peak
+   double mean = 0.;
+   /// Sigma of the peak
+   double sigma = 0.;
+   /// Fraction of the signal in the window
+   double signalFraction = 0.;
+   /// Number of entries of the signal in the window after the background subtraction
+   double signalEntries = 0.;
+   /// Number of iterations made in the last estimate
+   unsigned int numberOfIterations = 0;
+};
+
+#endif /* ROBUST_PEAK_ESTIMATOR_HPP */
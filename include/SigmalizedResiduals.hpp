@@ -13,6 +13,7 @@
 #include <thread>
 #include <algorithm>
 #include <filesystem>
+#include <array>
 
 #include "TFile.h"
 #include "TH1.h"
@@ -36,6 +37,16 @@
 #include "PBar.hpp"
 
 #include "InputYAMLReader.hpp"
+#include "InputHistogramMerger.hpp"
+#include "HistogramArena.hpp"
+#include "FitFunctionPool.hpp"
+#include "FitStrategyLadder.hpp"
+#include "FitRangeSystematics.hpp"
+#include "CoarseToFineFit.hpp"
+#include "DoubleGausSeedEstimator.hpp"
+#include "ThreadTokenPool.hpp"
+#include "MemoryBudget.hpp"
+#include "MemoryUsageReporter.hpp"
 
 /*! @namespace SigmalizedResiduals
  * @brief Contains all functions and containers for SigmalizedResiduals.cpp and CheckSigmalizedResiduals.cpp
@@ -86,8 +97,23 @@ namespace SigmalizedResiduals
    std::array<std::string, 2> variableNameTex{"d#varphi", "dz_{DC}"};
    /// Useful objects to employ for quick TLatex insertions
    TLatex pTRangeTLatex, zDCRangeTLatex, chargeTLatex, centralityRangeTLatex;
-   /// Input file (from taxi output)
-   std::unique_ptr<TFile> inputFile;
+   /// Input histograms (from taxi output) summed over sum.root or over partial input files (see input_partial_files in input .yaml file)
+   InputHistogramMerger inputHistograms;
+   /// Reused buffers for the projections of the histograms; they are recycled for every canvas of pT bins
+   HistogramArena histogramArena;
+   /// Reused fit functions; they are recycled together with histogramArena
+   FitFunctionPool fitFunctionPool;
+   /// Tiers of the fits of dphi and dz (or sdphi and sdz) distributions (see FitStrategyLadder)
+   FitStrategyLadder dValFitLadder;
+   /// Coarse stage of the fits of dphi and dz (or sdphi and sdz) distributions that provides the seeds
+   CoarseToFineFit coarseToFineFit;
+   /// Estimator of the seeds and the limits of the fits of dphi and dz (or sdphi and sdz) distributions
+   DoubleGausSeedEstimator dValSeedEstimator;
+   /// If true uncertainties of means and sigmas are estimated from the covariance of the main fit and
+   /// from rangeSystematics; else from the spread of the alternative fits in the varied ranges
+   bool isUncertaintyFastMode = false;
+   /// Systematic uncertainties from the range of the fit in the same ranges as the alternative fits
+   FitRangeSystematics rangeSystematics;
    /// Output file
    std::unique_ptr<TFile> outputFile;
    /// Output directory
@@ -114,7 +140,7 @@ namespace SigmalizedResiduals
    bool showProgress = true;
    /// Minimum number of entries for the histogram to be approximated. If this requirement for this value is not met warning will be printed but the program will not finish
    const double minIntegralValue = 3e2;  
-   /// Number of consequent fits of dphi and dz distributions for better approximation results
+   /// Number of consequent fits of means and sigmas of dphi and dz vs pT for better approximation results
    /// each consequent fit decreases the limits around value from previous fit for every parameter
    /// which makes bettter gradual gradient descent of approximation parameters since ROOT built in
    /// approximation algorithm has only limited resource to perform the gradient descent
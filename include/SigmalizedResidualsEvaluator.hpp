@@ -0,0 +1,130 @@
+/**
+ *  @file   SigmalizedResidualsEvaluator.hpp
+ *  @brief  Contains declaration of class SigmalizedResidualsEvaluator
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef SIGMALIZED_RESIDUALS_EVALUATOR_HPP
+#define SIGMALIZED_RESIDUALS_EVALUATOR_HPP
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+#include "TF1.h"
+
+#include "yaml-cpp/yaml.h"
+
+#include "ErrorHandler.hpp"
+
+/*! @class SigmalizedResidualsEvaluator
+ * @brief Class SigmalizedResidualsEvaluator applies sigmalized residuals calibration produced by SigmalizedResiduals and CheckSigmalizedResiduals to the tracks
+ *
+ * Sigmalized residual of the track is sval = ((val - mean(pT))/sigma(pT) + meanShift)*sigmaScale where mean(pT) and sigma(pT) are the approximations of means and sigmas of dval vs pT from cal_<detector>_s<variable>_<charge>.txt and meanShift and sigmaScale are the corrections from recal_<detector>_s<variable>_<charge>.txt. Each file is read once and the fit functions from the input .yaml file are evaluated with TF1 only at the nodes of uniform pT grid. Since sval is linear in val it is stored as sval = val*scale(pT) + offset(pT) in flat lookup tables of scale and offset indexed by (detector, variable, charge, centrality bin, zDC bin). Evaluation of the track is then a linear interpolation between 2 nodes of both tables and a single multiply-add without any formula evaluation or branches. The nodes are read at the indices that differ from track to track, hence the batch loop is not vectorized with the project flags (x86-64 baseline has no gather instructions) and the gain over the evaluation of the formulas comes from the lookup tables only. pT outside of the grid range is clamped to its edges; the tracks outside of centrality or zDC bins get NaN.
+ */
+class SigmalizedResidualsEvaluator
+{
+   public:
+
+   ///@brief Default constructor
+   SigmalizedResidualsEvaluator();
+   /*! @brief Constructor with parameters
+    * @param[in] pTMin lower edge of pT grid of the lookup tables
+    * @param[in] pTMax upper edge of pT grid of the lookup tables
+    * @param[in] numberOfPTBins number of intervals of pT grid of the lookup tables
+    * @param[in] centralityRanges edges of centrality bins (centrality_bins in input .yaml file)
+    * @param[in] zDCRanges edges of zDC bins (zdc_bins in input .yaml file)
+    * @param[in] isRecalibrationApplied if false recal_ files are not read and sval is calculated with cal_ files only (e.g. for the distributions from which CheckSigmalizedResiduals obtains recal_ files)
+    */
+   SigmalizedResidualsEvaluator(const double pTMin, const double pTMax,
+                                const unsigned int numberOfPTBins,
+                                const std::vector<double>& centralityRanges,
+                                const std::vector<double>& zDCRanges,
+                                const bool isRecalibrationApplied = true);
+   /*! @brief Reads the calibration parameters of both variables and both charges of the detector and fills its lookup tables. Returns the index of the detector that is passed to SigmalizedResidualsEvaluator::Evaluate
+    * If any of cal_ files does not exist or is corrupted SigmalizedResidualsEvaluator will print error and exit the program with exit code 1. If recal_ file does not exist (or the recalibration is not applied; see the constructor) the corrections are not applied.
+    * @param[in] detector node of the detector from detectors_to_calibrate in input .yaml file
+    * @param[in] parametersDir directory with the calibration parameters (output/SigmalizedResiduals/<run_name>/CalibrationParameters/)
+    */
+   unsigned int AddDetector(const YAML::Node& detector, const std::string& parametersDir);
+   /*! @brief Calculates the sigmalized residuals of the tracks in the detector. Sigmalized residuals of the tracks with negative centrality or zDC bin are set to NaN
+    * @param[in] detectorBin index of the detector returned by SigmalizedResidualsEvaluator::AddDetector
+    * @param[in] variableBin index of the variable (0 for dphi, 1 for dz)
+    * @param[in] numberOfTracks number of tracks
+    * @param[in] centralityBin centrality bins of the tracks (see SigmalizedResidualsEvaluator::GetCentralityBin)
+    * @param[in] zDCBin zDC bins of the tracks (see SigmalizedResidualsEvaluator::GetZDCBin)
+    * @param[in] charge charges of the tracks; tracks with negative charge are evaluated with the parameters of the negative charge and the other tracks with the ones of the positive charge (neutral tracks should be skipped by the caller)
+    * @param[in] pT transverse momenta of the tracks
+    * @param[in] val residuals of the tracks
+    * @param[out] sval sigmalized residuals of the tracks
+    */
+   void Evaluate(const unsigned int detectorBin, const unsigned int variableBin,
+                 const unsigned long numberOfTracks, const int *centralityBin,
+                 const int *zDCBin, const int *charge, const double *pT,
+                 const double *val, double *sval) const;
+   /*! @brief Returns the sigmalized residual of a single track (see SigmalizedResidualsEvaluator::Evaluate for the batch version)
+    * @param[in] detectorBin index of the detector returned by SigmalizedResidualsEvaluator::AddDetector
+    * @param[in] variableBin index of the variable (0 for dphi, 1 for dz)
+    * @param[in] centralityBin centrality bin of the track
+    * @param[in] zDCBin zDC bin of the track
+    * @param[in] charge charge of the track
+    * @param[in] pT transverse momentum of the track
+    * @param[in] val residual of the track
+    */
+   double Evaluate(const unsigned int detectorBin, const unsigned int variableBin,
+                   const int centralityBin, const int zDCBin,
+                   const int charge, const double pT, const double val) const;
+   /// @brief Returns the centrality bin or -1 if the centrality is outside of the bins
+   int GetCentralityBin(const double centrality) const;
+   /// @brief Returns the zDC bin or -1 if zDC is outside of the bins
+   int GetZDCBin(const double zDC) const;
+   /// @brief Returns the number of added detectors
+   unsigned int GetNumberOfDetectors() const;
+   /// @brief Returns the name of the detector
+   const std::string& GetDetectorName(const unsigned int detectorBin) const;
+   /// @brief Default destructor
+   virtual ~SigmalizedResidualsEvaluator();
+
+   private:
+
+   /// @brief Reads cal_ and recal_ files of the variable and the charge of the detector and fills their tables starting from tableIndex
+   void FillTables(const YAML::Node& detector, const std::string& parametersDir,
+                   const unsigned int variableBin, const int charge, const unsigned long tableIndex);
+   /// @brief Returns the index of the table
+   unsigned long GetTableIndex(const unsigned int detectorBin, const unsigned int variableBin,
+                               const unsigned int chargeBin, const unsigned int centralityBin,
+                               const unsigned int zDCBin) const;
+   /// @brief Returns the bin of the value in the edges or -1 if the value is outside of them
+   static int FindBin(const std::vector<double>& ranges, const double value);
+   /// Lower edge of pT grid
+   double pTMin = 0.;
+   /// Upper edge of pT grid
+   double pTMax = 0.;
+   /// Number of intervals of pT grid
+   unsigned int numberOfPTBins = 0;
+   /// Inverse of the width of the interval of pT grid
+   double inversePTBinWidth = 0.;
+   /// Whether the corrections from recal_ files are applied
+   bool isRecalibrationApplied = true;
+   /// Edges of centrality bins
+   std::vector<double> centralityRanges;
+   /// Edges of zDC bins
+   std::vector<double> zDCRanges;
+   /// Names of the added detectors
+   std::vector<std::string> detectorNames;
+   /// 1/sigma*sigmaScale at the nodes of pT grid of all tables;
+   /// values of the table start from tableIndex*(numberOfPTBins + 1)
+   std::vector<float> scaleTable;
+   /// (meanShift - mean/sigma)*sigmaScale at the nodes of pT grid of all tables;
+   /// values of the table start from tableIndex*(numberOfPTBins + 1)
+   std::vector<float> offsetTable;
+   /// Names of variables in the files
+   inline static const std::string variableName[2] = {"dphi", "dz"};
+};
+
+#endif /* SIGMALIZED_RESIDUALS_EVALUATOR_HPP */
@@ -0,0 +1,135 @@
+/**
+ *  @file   SigmalizedResidualsHistograms.hpp
+ *  @brief  Contains declarations of functions and variables that are used for filling of dphi and dz (and sdphi and sdz) distributions from track trees for calibration of sigmalized residuals
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef SIGMALIZED_RESIDUALS_HISTOGRAMS_HPP
+#define SIGMALIZED_RESIDUALS_HISTOGRAMS_HPP
+
+#include <cmath>
+#include <set>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TH3.h"
+#include "TROOT.h"
+
+#include "ErrorHandler.hpp"
+#include "IOTools.hpp"
+
+#include "PBar.hpp"
+
+#include "InputYAMLReader.hpp"
+#include "SigmalizedResidualsEvaluator.hpp"
+#include "MemoryUsageReporter.hpp"
+
+/*! @namespace SigmalizedResidualsHistograms
+ * @brief Contains all functions and containers for SigmalizedResidualsHistograms.cpp
+ *
+ * Input trees contain one entry per track with the following branches (all Float_t except charge which is Int_t):
+ *  - charge - charge of the track
+ *  - pT - transverse momentum of the track [GeV/c]
+ *  - centrality - centrality of the event [%]
+ *  - zDC - z coordinate of the track at DC [cm]
+ *  - <detector>_dphi, <detector>_dz - residuals of the track in the detector for every detector from detectors_to_calibrate in input .yaml file; NaN if the track has no match in the detector
+ */
+namespace SigmalizedResidualsHistograms
+{
+   /// @brief Portion of the tree that is processed by one thread at a time
+   struct Task
+   {
+      /// index of the file in inputFileNames
+      unsigned long fileIndex;
+      /// first entry of the portion
+      long long firstEntry;
+      /// entry after the last entry of the portion
+      long long lastEntry;
+   };
+/*! @brief Adds input files from the directory, .root file, or list of .root files (same as InputHistogramMerger::AddInput)
+ * @param[in] inputPath directory, .root file, or list of .root files
+ */
+   void AddInputFiles(const std::string& inputPath);
+   /// @brief Splits the trees of all input files into tasks of at most entriesPerTask entries
+   void CreateTasks();
+/*! @brief Returns the index of the histogram in the vector returned by CreateHistograms
+ * @param[in] isSigmalized false for dval and true for sdval distributions
+ * @param[in] detectorBin detector bin (i.e. element of array in "detectors_to_calibrate" field in input .yaml file)
+ * @param[in] variableBin variable bin (0 for dphi and 1 for dz)
+ * @param[in] chargeBin charge bin (0 for positive and 1 for negative charge)
+ * @param[in] zDCBin zDC bin (i.e. element of array in "zdc_bins" field in input .yaml file)
+ */
+   unsigned long GetHistogramIndex(const bool isSigmalized, const unsigned int detectorBin,
+                                   const unsigned int variableBin, const unsigned int chargeBin,
+                                   const unsigned int zDCBin);
+   /// @brief Returns empty val vs pT vs centrality histograms for all detectors, variables, charges, and zDC bins
+   std::vector<std::unique_ptr<TH3F>> CreateHistograms();
+/*! @brief Processes tasks until there are none left and fills the histograms (function for the thread call)
+ * @param[in] hists thread local histograms created with CreateHistograms
+ */
+   void ProcessTasks(std::vector<std::unique_ptr<TH3F>>& hists);
+   /// @brief Function for ProgressBar thread call
+   void PBarCall();
+   /// Contents of input .yaml file for calibration
+   InputYAMLReader inputYAMLCal;
+   /// Name of run (e.g. Run14HeAu200 or Run7AuAu200)
+   std::string runName;
+   /// Names of variables to be calibrated
+   std::array<std::string, 2> variableName{"dphi", "dz"};
+   /// Names of the detectors
+   std::vector<std::string> detectorNames;
+   /// Names of input files with track trees
+   std::vector<std::string> inputFileNames;
+   /// Name of the tree in the input files
+   std::string treeName;
+   /// Maximum number of entries in one task
+   long long entriesPerTask = 1000000;
+   /// Portions of the trees that are distributed between threads
+   std::vector<Task> tasks;
+   /// Index of the next task that is not taken by any thread
+   std::atomic<unsigned long> nextTaskIndex{0};
+   /// Number of processed entries of all threads
+   std::atomic<unsigned long long> numberOfProcessedEntries{0};
+   /// Number of entries of all input trees
+   unsigned long long numberOfEntries = 0;
+   /// pT ranges for ROOT TAxis
+   std::vector<double> pTRanges;
+   /// zDC ranges
+   std::vector<double> zDCRanges;
+   /// Centrality ranges for ROOT TAxis
+   std::vector<double> centralityRanges;
+   /// Names of zDC ranges as in the names of the histograms
+   std::vector<std::string> zDCRangeNames;
+   /// Edges of the bins of dphi, dz, and sdphi and sdz (the same for both) for ROOT TAxis
+   std::array<std::vector<double>, 3> valRanges;
+   /// Finds centrality and zDC bins of the tracks and calculates sdphi and sdz if isSigmalizedFilled is true
+   SigmalizedResidualsEvaluator evaluator;
+   /// Whether sdphi and sdz distributions are filled; true if the calibration parameters produced by SigmalizedResiduals exist
+   bool isSigmalizedFilled = false;
+   /// Number of tracks that are read before the histograms are filled in one batch
+   const unsigned long batchSize = 4096;
+   /// pProgress bar - shows progress (see ProgressBar)
+   ProgressBar pBar{"FANCY1", "", PBarColor::BOLD_RED};
+   /// Value that shows whether the computation part of this program is finished
+   bool isProcessFinished = false;
+};
+
+/*! @brief Main function
+ *
+ * Fills dphi and dz vs pT vs centrality distributions for every detector, charge, and zDC range from track trees (see residuals_histograms field in input .yaml file) with the binning from input .yaml file. The distributions have the same names as the ones read by SigmalizedResiduals. If calibration parameters produced by SigmalizedResiduals exist, sdphi and sdz distributions read by CheckSigmalizedResiduals are filled as well. Tracks are read by all threads into thread local histograms which are summed in the end.
+ *
+ * @param[in] argv[1] name of the .yaml input file or name of the directory containing .yaml input file
+ * @param[in] argv[2] number of threads the program will run on (if no value is passed this value is set to std::thread::hadrware_concurrency())
+ */
+int main(int argc, char **argv);
+
+#endif /* SIGMALIZED_RESIDUALS_HISTOGRAMS_HPP */
@@ -0,0 +1,64 @@
+/**
+ *  @file   SummedAreaTable.hpp
+ *  @brief  Contains declaration of class SummedAreaTable
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef SUMMED_AREA_TABLE_HPP
+#define SUMMED_AREA_TABLE_HPP
+
+#include <vector>
+#include <utility>
+
+#include "TH2.h"
+
+#include "MathTools.hpp"
+
+/*! @class SummedAreaTable
+ * @brief Class SummedAreaTable stores 2D prefix sums of the contents of TH2 histogram
+ *
+ * Prefix sums are calculated once in the constructor after which the integral over any rectangular range of bins is obtained with 4 reads instead of the loop over all bins in the range as in TH2::Integral. This makes the merging of bins until the minimum number of entries is reached linear in the number of bins.
+ */
+class SummedAreaTable
+{
+   public:
+
+   /*! @brief Constructor with parameters
+    * @param[in] hist histogram for which prefix sums are calculated (including underflow and overflow bins)
+    */
+   SummedAreaTable(const TH2 *hist);
+   /*! @brief Returns the integral over the range of bins (borders included) with the same range conventions as TH2::Integral
+    * @param[in] firstXBin first bin along x axis
+    * @param[in] lastXBin last bin along x axis
+    * @param[in] firstYBin first bin along y axis
+    * @param[in] lastYBin last bin along y axis
+    */
+   double Integral(int firstXBin, int lastXBin, int firstYBin, int lastYBin) const;
+   /*! @brief Returns the ranges of merged bins along x axis (pairs of the first and the last bins) in a single pass from firstXBin to lastXBin. Consecutive bins are merged until the integral in the range [firstYBin, lastYBin] reaches minIntegral; bins at the end that do not reach minIntegral are discarded
+    * @param[in] firstXBin first bin along x axis
+    * @param[in] lastXBin last bin along x axis
+    * @param[in] firstYBin first bin along y axis
+    * @param[in] lastYBin last bin along y axis
+    * @param[in] minIntegral minimum integral of merged bins
+    */
+   std::vector<std::pair<int, int>> GetMergedXBins(const int firstXBin, const int lastXBin,
+                                                   const int firstYBin, const int lastYBin,
+                                                   const double minIntegral) const;
+   /// @brief Default destructor
+   virtual ~SummedAreaTable();
+
+   private:
+
+   /// Returns the index of the prefix sum for the bins with indices up to (xBin, yBin)
+   unsigned long GetIndex(const int xBin, const int yBin) const;
+   /// Number of bins along x axis (without underflow and overflow bins)
+   int numberOfXBins;
+   /// Number of bins along y axis (without underflow and overflow bins)
+   int numberOfYBins;
+   /// Prefix sums; the first row and column are zeros so that no range checks are needed
+   std::vector<double> sums;
+};
+
+#endif /* SUMMED_AREA_TABLE_HPP */
@@ -0,0 +1,68 @@
+/**
+ *  @file   ThreadTokenPool.hpp
+ *  @brief  Contains declaration of class ThreadTokenPool
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef THREAD_TOKEN_POOL_HPP
+#define THREAD_TOKEN_POOL_HPP
+
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "ErrorHandler.hpp"
+
+/*! @class ThreadTokenPool
+ * @brief Class ThreadTokenPool shares the budget of threads between all processes of the process tree the same way GNU make jobserver does
+ *
+ * The pool is a named pipe (FIFO) filled with one byte (token) per thread. The process that creates the pool passes the path to the pipe to its subprocesses via environment variable CALPHENIX_THREAD_TOKEN_POOL; a pool constructed in such subprocess is attached to the same pipe instead of creating a new one. Programs that launch the subprocesses take tokens before launching them, pass the number of taken tokens as the number of threads of the subprocess, and return the tokens when the subprocess finishes, hence the number of busy threads of the whole process tree never exceeds the budget and the tokens of finished subprocesses are taken by the ones that are started later. Tokens taken by the subprocess that crashed are returned by the program that launched it.
+ */
+class ThreadTokenPool
+{
+   public:
+
+   ///@brief Default constructor
+   ThreadTokenPool();
+   /*! @brief Constructor that attaches to the pool of the parent process if it exists or creates the new one otherwise
+    * @param[in] numberOfThreads number of tokens in the pool if the new pool is created
+    */
+   ThreadTokenPool(const unsigned int numberOfThreads);
+   /// @brief Takes 1 token; waits until it is returned by another process if there are no free tokens
+   void Acquire();
+   /*! @brief Takes up to the given number of tokens without waiting and returns the number of taken tokens
+    * @param[in] numberOfTokens maximum number of tokens to take
+    */
+   unsigned int TryAcquire(const unsigned int numberOfTokens);
+   /*! @brief Returns the tokens to the pool
+    * @param[in] numberOfTokens number of tokens to return
+    */
+   void Release(const unsigned int numberOfTokens = 1);
+   /// @brief Returns true if the pool was created by the parent process
+   bool IsInherited() const;
+   /// @brief Default destructor
+   virtual ~ThreadTokenPool();
+
+   private:
+
+   /// Name of the environment variable with the path to the pipe
+   inline static const std::string environmentVariableName = "CALPHENIX_THREAD_TOKEN_POOL";
+   /// Path to the pipe
+   std::string fifoPath;
+   /// File descriptor of the pipe used to wait for tokens
+   int blockingFileDescriptor = -1;
+   /// File descriptor of the pipe used to take tokens without waiting and to return them; it is opened separately since O_NONBLOCK is shared by all processes that use the same file description
+   int nonBlockingFileDescriptor = -1;
+   /// Whether the pool was created by the parent process
+   bool isInherited = false;
+};
+
+#endif /* THREAD_TOKEN_POOL_HPP */
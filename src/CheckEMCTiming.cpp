@@ -18,15 +18,16 @@ int main(int argc, char **argv)
 {
    using namespace EMCTiming;
 
-   if (argc < 2 || argc > 5) 
+   if (argc < 2 || argc > 7 || argc == 6) 
    {
-      std::string errMsg = "Expected 1-2 or 3-4 parameters while " + std::to_string(argc - 1) + 
+      std::string errMsg = "Expected 1-2, 3-4, or 6 parameters while " + std::to_string(argc - 1) + 
                            " parameter(s) were provided \n";
-      errMsg += "Usage: bin/EMCTRunByRunOffset inputFile numberOfThreads=" + 
+      errMsg += "Usage: bin/CheckEMCTiming inputFile numberOfThreads=" + 
                 std::to_string(std::thread::hardware_concurrency()) + "*\n";
-      errMsg += "Or**: bin/EMCTRunByRunOffset inputFile sectorBin numberOfThreads showProgress=true";
+      errMsg += "Or**: bin/CheckEMCTiming inputFile sectorBin numberOfThreads showProgress=true ";
+      errMsg += "runChunkIndex=0 numberOfRunChunks=1\n";
       errMsg += "*: default argument is the number of threads on the current machine \n";
-      errMsg += "**: this mode processes only one sector \n";
+      errMsg += "**: this mode processes only one sector (or all sectors if sectorBin is -1) \n";
       CppTools::PrintError(errMsg);
    }
 
@@ -44,8 +45,6 @@ int main(int argc, char **argv)
 
    runName = inputYAMLCal["run_name"].as<std::string>();
 
-   CppTools::CheckInputFile("data/EMCTiming/" + runName + "/raw_sum.root");
-
    // opening input file with parameters of a run
    inputYAMLMain.OpenFile("input/" + runName + "/main.yaml");
    inputYAMLMain.CheckStatus("main");
@@ -59,71 +58,132 @@ int main(int argc, char **argv)
 
    TDirectory::AddDirectory(kFALSE);
 
-   const std::string inputDir = "data/EMCTiming/" + runName + "/";
-
-   std::set<std::filesystem::path> inputDataFilePaths;
+   const std::string runCatalogFileName = 
+      "output/EMCTCalibration/" + runName + "/run_catalog.txt";
 
-   for (const auto &file : std::filesystem::directory_iterator(inputDir))
+   // runs are taken from the catalog which is updated only for new and changed se-<run>.root files
+   auto ReadRunCatalog = [&](const bool isUpdated)
    {
-      const std::string fileName = static_cast<std::string>(file.path());
-      if (fileName.substr(inputDir.size(), 3) == static_cast<std::string>("se-"))
+      if (!isUpdated)
       {
-         inputDataFilePaths.insert(file);
+         if (!runCatalog.ReadFile(runCatalogFileName))
+         {
+            CppTools::PrintError("Run catalog " + runCatalogFileName + " does not exist");
+         }
       }
-   }
+      else
+      {
+         std::vector<std::string> sectorNames;
+         for (const auto& sector : inputYAMLCal["sectors_to_calibrate"])
+         {
+            sectorNames.push_back(sector["name"].as<std::string>());
+         }
 
-   // iterating over set inputDataFiles to get run numbers sorted
-   for (const auto &file : inputDataFilePaths)
-   {
-      const std::string fileName = static_cast<std::string>(file);
-      runNumbers.emplace_back(std::stoi(fileName.substr(inputDir.size() + 3, 6)));
-   }
+         system(("mkdir -p output/EMCTCalibration/" + runName).c_str());
 
-   if (argc < 3) // Mode1
+         runCatalog.ReadFile(runCatalogFileName);
+         if (runCatalog.Update("data/EMCTiming/" + runName + "/", sectorNames, numberOfThreads))
+         {
+            runCatalog.WriteFile(runCatalogFileName);
+         }
+      }
+      runNumbers = runCatalog.GetRunNumbers();
+
+      runIndicesToProcess.clear();
+      for (unsigned long i = 0; i < runNumbers.size(); i++) runIndicesToProcess.push_back(i);
+   };
+
+   if (argc < 4) // Mode1
    {
       programMode = 1;
       if (argc > 2) numberOfThreads = std::stoi(argv[2]);
       else numberOfThreads = std::thread::hardware_concurrency();
       if (numberOfThreads == 0) CppTools::PrintError("Number of threads must be bigger than 0");
 
-      system(("mkdir -p tmp/progress/EMCTRunByRunOffset/" + runName).c_str());
-      system(("rm -rf tmp/progress/EMCTRunByRunOffset/" + runName + "/*").c_str());
+      ReadRunCatalog(true);
+
+      system(("mkdir -p tmp/progress/CheckEMCTiming/" + runName).c_str());
+      system(("rm -rf tmp/progress/CheckEMCTiming/" + runName + "/*").c_str());
 
       numberOfIterations = inputYAMLCal["sectors_to_calibrate"].size()*runNumbers.size();
 
-      int subprocessNumberOfThreads = numberOfThreads/inputYAMLCal["sectors_to_calibrate"].size();
-      if (subprocessNumberOfThreads < 1) subprocessNumberOfThreads = 1;
+      const unsigned int numberOfSectors = inputYAMLCal["sectors_to_calibrate"].size();
+
+      // runs are independent hence they are split into contiguous chunks each of which is 
+      // processed for all sectors so that every se-<run>.root file is opened only once;
+      // 2 chunks per thread are used to balance runs with different statistics
+      numberOfRunChunks = CppTools::Minimum(2*numberOfThreads, 
+                                            static_cast<unsigned int>(runNumbers.size()));
+      if (numberOfRunChunks == 0) numberOfRunChunks = 1;
 
-      auto SingleThreadCall = [&](const unsigned long sectorBin)
+      for (unsigned int sectorBin = 0; sectorBin < numberOfSectors; sectorBin++)
       {
-         // man ROOT sucks (TF1::Fit is still not thread safe) so I have to call the same program 
-         // recursively in shell outside of the current instance to implement multithreading
-         system((static_cast<std::string>("./bin/EMCTRunByRunOffset ") + 
-                 argv[1] + " " + std::to_string(sectorBin) + " " + 
-                 std::to_string(subprocessNumberOfThreads) + " 0").c_str());;
+         system(("mkdir -p tmp/CheckEMCTiming/" + runName + "/" + 
+                 std::to_string(sectorBin)).c_str());
+         system(("rm -rf tmp/CheckEMCTiming/" + runName + "/" + 
+                 std::to_string(sectorBin) + "/*").c_str());
+      }
+
+      // index of the next chunk of runs to be processed
+      std::atomic<unsigned int> nextRunChunkIndex{0};
+
+      // threads of all subprocesses are taken from the same pool
+      ThreadTokenPool threadTokenPool(numberOfThreads);
+      // subprocesses are started only while their memory fits in the budget
+      MemoryBudget memoryBudget(inputYAMLCal["memory_budget"].as<double>());
+
+      auto SingleThreadCall = [&]()
+      {
+         for (unsigned int i = nextRunChunkIndex++; i < numberOfRunChunks; i = nextRunChunkIndex++)
+         {
+            // subprocess waits for the memory before taking the thread so that the threads 
+            // are not held by the subprocesses that can not be started yet
+            const unsigned long memoryBudgetIndex = memoryBudget.Admit("CheckEMCTiming");
+            threadTokenPool.Acquire();
+
+            // man ROOT sucks (TF1::Fit is still not thread safe) so I have to call the same program 
+            // recursively in shell outside of the current instance to implement multithreading
+            system((memoryBudget.GetEnvironment(memoryBudgetIndex) + "./bin/CheckEMCTiming " + 
+                    argv[1] + " -1 1 0 " + std::to_string(i) + " " + 
+                    std::to_string(numberOfRunChunks)).c_str());
+
+            memoryBudget.Release(memoryBudgetIndex);
+            threadTokenPool.Release();
+         }
       };
 
       std::vector<std::thread> thrCalls;
       std::thread pBarThr(PBarCall); 
 
-      for (unsigned int sectorBin = 0; sectorBin < 
-           inputYAMLCal["sectors_to_calibrate"].size(); sectorBin++)
+      for (unsigned int i = 0; i < CppTools::Minimum(numberOfThreads, numberOfRunChunks); i++)
       {
-            if (thrCalls.size() >= numberOfThreads)
-            {
-               while (!thrCalls.empty())
-               {
-                  thrCalls.back().join();
-                  thrCalls.pop_back();
-               }
-            }
-            thrCalls.emplace_back(SingleThreadCall, sectorBin);
+         thrCalls.emplace_back(SingleThreadCall);
       }
 
-      while (!thrCalls.empty())
+      for (std::thread& thr : thrCalls) thr.join();
+
+      outputDir = "output/EMCTCalibration/" + runName + "/";
+
+      // with 1 chunk subprocesses write the outputs directly
+      if (numberOfRunChunks > 1)
       {
-         thrCalls.back().join();
-         thrCalls.pop_back();
+         for (unsigned int sectorBin = 0; sectorBin < numberOfSectors; sectorBin++)
+         {
+            MergeRunChunks(sectorBin);
+         }
+
+         // statistics of the fits of the chunks are summed in one file of the program
+         FitStrategyLadder tPhotonFitLadder("tcorr fits", 
+                                            inputYAMLCal["fit_strategy"]["t_photon"]);
+         for (unsigned int i = 0; i < numberOfRunChunks; i++)
+         {
+            const std::string statisticsFileName = "tmp/CheckEMCTiming/" + runName + 
+                                                   "/fit_strategy_t_photon_" + 
+                                                   std::to_string(i) + ".txt";
+            tPhotonFitLadder.AddStatistics(statisticsFileName);
+            std::filesystem::remove(statisticsFileName);
+         }
+         tPhotonFitLadder.WriteStatistics(outputDir + "fit_strategy_t_photon_check_emc_timing.txt");
       }
 
       isProcessFinished = true;
@@ -132,212 +192,166 @@ int main(int argc, char **argv)
    else // Mode2
    {
       programMode = 2;
+
+      // memory usage is reported to the parent process if it requested it
+      MemoryUsageReporter memoryUsageReporter;
+
       numberOfThreads = std::stoi(argv[3]);
       if (numberOfThreads <= 0) CppTools::PrintError("Number of threads must be bigger than 0");
  
       ROOT::EnableImplicitMT(numberOfThreads);
 
       if (argc > 4) showProgress = static_cast<bool>(std::stoi(argv[4]));
+      if (argc > 6)
+      {
+         runChunkIndex = std::stoi(argv[5]);
+         numberOfRunChunks = std::stoi(argv[6]);
+
+         if (numberOfRunChunks == 0 || runChunkIndex >= numberOfRunChunks)
+         {
+            CppTools::PrintError("Run chunk index must be smaller than the number of run chunks");
+         }
+      }
+
+      // subprocesses only read the catalog updated by the parent process 
+      // so that all of them split the same runs into chunks
+      ReadRunCatalog(numberOfRunChunks == 1);
+
+      // sector bin -1 stands for all sectors
+      std::vector<unsigned int> sectorBins;
+      if (std::stoi(argv[2]) >= 0) sectorBins.push_back(std::stoi(argv[2]));
+      else
+      {
+         for (unsigned int sectorBin = 0; sectorBin < 
+              inputYAMLCal["sectors_to_calibrate"].size(); sectorBin++)
+         {
+            sectorBins.push_back(sectorBin);
+         }
+      }
 
       outputDir = "output/EMCTCalibration/" + runName + "/";
       system(("mkdir -p " + outputDir + "CalibrationParameters").c_str());
-      system(("mkdir -p " + outputDir + inputYAMLCal["sectors_to_calibrate"][std::stoi(argv[2])]
-                                                    ["name"].as<std::string>()).c_str());
+      for (const unsigned int sectorBin : sectorBins)
+      {
+         system(("mkdir -p " + outputDir + inputYAMLCal["sectors_to_calibrate"][sectorBin]
+                                                       ["name"].as<std::string>()).c_str());
+      }
 
-      fitNTries = inputYAMLCal["number_of_fit_tries"].as<unsigned int>();
-      fitADCMin = inputYAMLCal["fit_adc_min"].as<double>();
+      runOffsetApproximator.Init(inputYAMLCal);
 
       std::thread pBarThr(PBarCall); 
 
-      numberOfIterations = runNumbers.size();
+      numberOfIterations = sectorBins.size()*
+         (runCatalog.GetFirstRunIndexOfChunk(runChunkIndex + 1, numberOfRunChunks, 
+                                             minRunEntries, runIndicesToProcess) - 
+          runCatalog.GetFirstRunIndexOfChunk(runChunkIndex, numberOfRunChunks, 
+                                             minRunEntries, runIndicesToProcess));
  
-      ProcessSector(std::stoi(argv[2]));
+      ProcessRuns(sectorBins);
 
       isProcessFinished = true;
       pBarThr.join();
+
+      FitStrategyLadder& tPhotonFitLadder = runOffsetApproximator.GetTPhotonFitLadder();
+
+      // statistics of the chunks are written in tmp and summed by the parent process
+      if (numberOfRunChunks > 1)
+      {
+         tPhotonFitLadder.WriteStatistics("tmp/CheckEMCTiming/" + runName + 
+                                          "/fit_strategy_t_photon_" + 
+                                          std::to_string(runChunkIndex) + ".txt");
+      }
+      else
+      {
+         tPhotonFitLadder.WriteStatistics(outputDir + "fit_strategy_t_photon_check_emc_timing" + 
+                                          ((sectorBins.size() == 1) ? "_" + 
+                                           inputYAMLCal["sectors_to_calibrate"][sectorBins[0]]
+                                                       ["name"].as<std::string>() : "") + ".txt");
+      }
+      if (showProgress) tPhotonFitLadder.PrintStatistics();
    }
    return 0;
 }
 
-void EMCTiming::ProcessSector(const int sectorBin)
+void EMCTiming::ProcessRuns(const std::vector<unsigned int>& sectorBins)
 {
-   const YAML::Node sector = inputYAMLCal["sectors_to_calibrate"][sectorBin];
-   const std::string sectorName = sector["name"].as<std::string>();
-
-   const std::string tPhotonFitFunc = 
-      inputYAMLCal["t_photon_fit_func"].as<std::string>();
-   const std::string tPhotonMeanVsADCFitFunc = 
-      inputYAMLCal["tcorr_mean_vs_adc_fit_func"].as<std::string>();
-
-   TFile outputFile((outputDir + sectorName + "/tcorr_fits.root").c_str(), "RECREATE");
-
-   for (const int runNumber : runNumbers)
+   // contiguous part of sorted runs processed by this process; 
+   // chunks are balanced by the expected cost of runs
+   const unsigned long firstRunIndex = 
+      runCatalog.GetFirstRunIndexOfChunk(runChunkIndex, numberOfRunChunks, 
+                                         minRunEntries, runIndicesToProcess);
+   const unsigned long lastRunIndex = 
+      runCatalog.GetFirstRunIndexOfChunk(runChunkIndex + 1, numberOfRunChunks, 
+                                         minRunEntries, runIndicesToProcess);
+
+   // output file is not created for the sector in which all towers were masked
+   std::vector<std::string> outputFileNames(sectorBins.size());
+
+   for (unsigned long i = 0; i < sectorBins.size(); i++)
    {
-      numberOfCalls++;
-
-      TFile inputFile(("data/EMCTiming/" + runName + "/se-" + 
-                       std::to_string(runNumber) + ".root").c_str());
-
-      TH2D *tVsADC = static_cast<TH2D *>(inputFile.Get(("tcorr vs ADC: " + sectorName).c_str()));
-
-      outputFile.mkdir(std::to_string(runNumber).c_str());
-      outputFile.cd(std::to_string(runNumber).c_str());
-
-      TGraphErrors meansTVsADC;
-      TGraphErrors sigmasTVsADC;
-
-      for (const auto& rangeADC : sector["adc_ranges"])
+      const YAML::Node sector = inputYAMLCal["sectors_to_calibrate"][sectorBins[i]];
+      const std::string sectorName = sector["name"].as<std::string>();
+
+      // run by run histograms are integrated over the towers of the sector hence tower mask 
+      // can only exclude the sector in which all towers were marked as bad by EMCTTowerMask
+      towerMask.Init(sector["number_of_y_towers"].as<int>(), 
+                     sector["number_of_z_towers"].as<int>());
+      if (towerMask.ReadFile(outputDir + "CalibrationParameters/tower_mask_" + 
+                             sectorName + ".txt") &&
+          towerMask.GetNumberOfTowers(EMCTowerMask::OK) == 0)
       {
-         const double rangeADCMin = rangeADC["min"].as<double>();
-         const double rangeADCMax = rangeADC["max"].as<double>();
-
-         // used to mark the first bin in the adc range for 
-         // cases when there is not enough statistics to merge bins
-         int firstValidBinInRange = CppTools::Maximum(1, tVsADC->GetXaxis()->FindBin(rangeADCMin));
-
-         for (int i = CppTools::Maximum(1, tVsADC->GetXaxis()->FindBin(rangeADCMin)); 
-              i <= CppTools::Minimum(tVsADC->GetXaxis()->FindBin(rangeADCMax), 
-                                    tVsADC->GetXaxis()->GetNbins()); i++)
+         if (showProgress || runChunkIndex == 0)
          {
-            if (tVsADC->Integral(firstValidBinInRange, i, tVsADC->GetYaxis()->FindBin(-10.), 
-                                 tVsADC->GetYaxis()->FindBin(10.)) < 1000.) continue;
-
-            // ADC value of the (current bin)/(merged bins)
-            const double valADC = 
-               CppTools::Average(tVsADC->GetXaxis()->GetBinCenter(i), 
-                                 tVsADC->GetXaxis()->GetBinCenter(firstValidBinInRange));
-
-            TH1D *tVsADCProj = 
-               tVsADC->ProjectionY(("tcorr " + CppTools::DtoStr(valADC, 0)).c_str(), 
-                                   firstValidBinInRange, i);
-
-            // if statistics is sufficient first valid bin resets 
-            // to the current bin on next iteration bin
-            firstValidBinInRange = i + 1;
-
-            TF1 tPhotonFit(("tcorr fit " + CppTools::DtoStr(valADC, 0)).c_str(), tPhotonFitFunc.c_str());
-
-            tPhotonFit.SetRange(-10., 10.);
-            tPhotonFit.SetParameters(tVsADCProj->GetMaximum(), 0, 0.5, 1., 1.);
-
-            for (unsigned int j = 1; j <= fitNTries; j++)
-            {
-               if (j < fitNTries) tVsADCProj->Fit(&tPhotonFit, "RQMBN");
-               else tVsADCProj->Fit(&tPhotonFit, "RQMB");
-
-               const double parameterDeviationScale = 1. + 1./static_cast<double>(j*j);
-
-               tPhotonFit.SetRange(tPhotonFit.GetParameter(1) - 
-                                 fabs(tPhotonFit.GetParameter(2))*parameterDeviationScale,
-                                 tPhotonFit.GetParameter(1) - 
-                                 fabs(tPhotonFit.GetParameter(2))*parameterDeviationScale);
-
-               for (int k = 0; k < tPhotonFit.GetNpar(); k++)
-               {
-                  if (k == 1)
-                  {
-                     tPhotonFit.SetParLimits(k, tPhotonFit.GetParameter(1) - 
-                                           fabs(tPhotonFit.GetParameter(2))*
-                                           (parameterDeviationScale - 1.),
-                                           tPhotonFit.GetParameter(1) +
-                                           fabs(tPhotonFit.GetParameter(2))*
-                                           (parameterDeviationScale - 1.));
-                  }
-                  else
-                  {
-                     tPhotonFit.SetParLimits(k, tPhotonFit.GetParameter(k)/parameterDeviationScale,
-                                           tPhotonFit.GetParameter(k)*parameterDeviationScale);
-                  }
-               }
-            }
-
-            tVsADCProj->Write();
-
-            // skipping outliers
-            if (fabs(tPhotonFit.GetParameter(1)) > 5. || 
-                fabs(tPhotonFit.GetParameter(2)) > 3. || 
-                fabs(tPhotonFit.GetParameter(2)) < 0.1) continue;
-
-            meansTVsADC.AddPoint(valADC, tPhotonFit.GetParameter(1));
-            sigmasTVsADC.AddPoint(valADC, fabs(tPhotonFit.GetParameter(2)));
+            CppTools::PrintWarning("All towers in sector " + sectorName + " are masked; skipping");
          }
-      }
-
-      meansTVsADC.SetMarkerStyle(20);
-      meansTVsADC.SetMarkerColor(kRed - 3);
-      meansTVsADC.SetMarkerSize(0.5);
-
-      sigmasTVsADC.SetMarkerStyle(20);
-      sigmasTVsADC.SetMarkerColor(kAzure - 3);
-      sigmasTVsADC.SetMarkerSize(0.5);
-
-      TF1 tPhotonMeanVsADCFit("tcorr mean vs ADC fit", tPhotonMeanVsADCFitFunc.c_str(), 0., 10000);
-      tPhotonMeanVsADCFit.SetLineWidth(3);
-      tPhotonMeanVsADCFit.SetLineStyle(2);
-      tPhotonMeanVsADCFit.SetLineColor(kBlack);
-
-      if (meansTVsADC.GetN() == 0) // bad run that passed the first bad run check
-      {
          continue;
       }
-      else if (meansTVsADC.GetN() > 1) 
+
+      // outputs of the chunks are written in tmp and merged by MergeRunChunks
+      if (numberOfRunChunks > 1)
       {
-         for (unsigned int i = 1; i < fitNTries; i++)
-         {
-            meansTVsADC.Fit(&tPhotonMeanVsADCFit, "RQMBN");
-
-            for (int j = 0; j < tPhotonMeanVsADCFit.GetNpar(); j++)
-            {
-               tPhotonMeanVsADCFit.SetParLimits(j, tPhotonMeanVsADCFit.GetParameter(j)*
-                                              (1. - 6./static_cast<double>(i*i*i)), 
-                                              tPhotonMeanVsADCFit.GetParameter(j)*
-                                              (1. + 4./static_cast<double>(i*i*i)));
-            }
-         }
+         outputFileNames[i] = "tmp/CheckEMCTiming/" + runName + "/" + 
+                              std::to_string(sectorBins[i]) + "/" + 
+                              std::to_string(runChunkIndex) + ".root";
       }
-      else // root can't fit 1 point data
-      {
-         tPhotonMeanVsADCFit.SetParameter(0, meansTVsADC.GetPointY(0));
-         for (int i = 1; i < tPhotonMeanVsADCFit.GetNpar(); i++)
-         {
-            tPhotonMeanVsADCFit.SetParameter(i, 0.);
-         }
-      }
-
-      TCanvas parCanv("mean and sigma t parameters vs ADC", "", 600, 600);
+      else outputFileNames[i] = outputDir + sectorName + "/tcorr_fits.root";
+   }
 
-      TH1 *frame = gPad->DrawFrame(meansTVsADC.GetPointX(0)/1.1, 
-                                   CppTools::Minimum(TMath::MinElement(meansTVsADC.GetN(), 
-                                                                       meansTVsADC.GetY()),
-                                                     TMath::MinElement(sigmasTVsADC.GetN(), 
-                                                                       sigmasTVsADC.GetY())) - 0.5,
-                                   meansTVsADC.GetPointX(meansTVsADC.GetN() - 1)*1.1,
-                                   CppTools::Maximum(TMath::MaxElement(meansTVsADC.GetN(), 
-                                                                       meansTVsADC.GetY()),
-                                                     TMath::MaxElement(sigmasTVsADC.GetN(), 
-                                                                       sigmasTVsADC.GetY())) + 0.5);
+   auto ProcessRunResult = [&](const unsigned long sectorIndex, const int, const TF1 *)
+   {
+      numberOfCalls++;
 
-      frame->GetXaxis()->SetTitle("ADC");
+      if (!showProgress && sectorIndex == sectorBins.size() - 1)
+      {
+         std::ofstream progressFile("tmp/progress/CheckEMCTiming/" + runName + 
+                                    "/" + std::to_string(runChunkIndex));
+         progressFile << numberOfCalls;
+      }
+   };
 
-      tPhotonMeanVsADCFit.Draw("SAME");
-      meansTVsADC.Draw("P");
-      sigmasTVsADC.Draw("P");
+   runOffsetApproximator.ProcessRuns(runCatalog, runIndicesToProcess, firstRunIndex, lastRunIndex,
+                                     minRunEntries, sectorBins, outputFileNames, ProcessRunResult);
+}
 
-      ROOTTools::PrintCanvas(&parCanv, "output/EMCTCalibration/" + runName + "/" + 
-                             sectorName + "/tcorr_par_vs_adc_" + std::to_string(runNumber));
+void EMCTiming::MergeRunChunks(const int sectorBin)
+{
+   const std::string sectorName = 
+      inputYAMLCal["sectors_to_calibrate"][sectorBin]["name"].as<std::string>();
 
-      
-      frame->GetXaxis()->SetTitle("ADC");
+   const std::string chunkDir = "tmp/CheckEMCTiming/" + runName + "/" + 
+                                std::to_string(sectorBin) + "/";
 
-      if (!showProgress)
-      {
-         std::ofstream progressFile("tmp/progress/EMCTRunByRunOffset/" + runName + 
-                                    "/" + std::to_string(sectorBin));
-         progressFile << numberOfCalls;
-      }
+   // chunk output file does not exist if all towers of the sector were masked
+   std::vector<std::string> chunkFileNames;
+   for (unsigned int i = 0; i < numberOfRunChunks; i++)
+   {
+      chunkFileNames.push_back(chunkDir + std::to_string(i) + ".root");
    }
 
-   outputFile.Close();
+   runOffsetApproximator.MergeChunks(outputDir + sectorName + "/tcorr_fits.root", 
+                                     chunkFileNames, false);
+
+   system(("rm -rf " + chunkDir).c_str());
 }
 
 void EMCTiming::PBarCall()
@@ -358,7 +372,7 @@ void EMCTiming::SetNumberOfCalls()
    if (programMode != 1) return; // Only Mode1 passes
    numberOfCalls = 0;
    for (const auto &file : 
-        std::filesystem::directory_iterator("tmp/progress/EMCTRunByRunOffset/" + runName))
+        std::filesystem::directory_iterator("tmp/progress/CheckEMCTiming/" + runName))
    {
       std::string fileName = static_cast<std::string>(file.path());
       std::ifstream tmpFile(fileName.c_str());
@@ -0,0 +1,105 @@
+/**
+ *  @file   CoarseToFineFit.cpp
+ *  @brief  Contains realisation of class CoarseToFineFit
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef COARSE_TO_FINE_FIT_CPP
+#define COARSE_TO_FINE_FIT_CPP
+
+#include "../include/CoarseToFineFit.hpp"
+
+CoarseToFineFit::CoarseToFineFit() {};
+
+CoarseToFineFit::CoarseToFineFit(const YAML::Node& stage)
+{
+   if (stage["rebin_factor"]) rebinFactor = stage["rebin_factor"].as<unsigned int>();
+   if (stage["min_number_of_bins"]) minNumberOfBins = stage["min_number_of_bins"].as<int>();
+   if (stage["options"]) options = stage["options"].as<std::string>();
+
+   if (rebinFactor == 0) CppTools::PrintError("CoarseToFineFit: Rebin factor must be bigger than 0");
+   if (options.find('N') == std::string::npos)
+   {
+      CppTools::PrintError("CoarseToFineFit: Options of the coarse fit must contain \"N\"");
+   }
+   if (options.find('L') != std::string::npos)
+   {
+      CppTools::PrintError("CoarseToFineFit: Coarse fit can not be the likelihood fit "
+                           "since contents of merged bins are not the counts");
+   }
+}
+
+int CoarseToFineFit::Fit(const TH1 *hist, TF1& func)
+{
+   if (rebinFactor <= 1) return -1;
+
+   const TAxis *axis = hist->GetXaxis();
+
+   double xMin, xMax;
+   func.GetRange(xMin, xMax);
+
+   const int firstBin = CppTools::Maximum(1, axis->FindBin(xMin));
+   const int lastBin = CppTools::Minimum(axis->FindBin(xMax), axis->GetNbins());
+
+   const int numberOfCoarseBins = (lastBin - firstBin + 1)/static_cast<int>(rebinFactor);
+
+   if (numberOfCoarseBins < minNumberOfBins)
+   {
+      numberOfSkippedFits++;
+      return -1;
+   }
+
+   coarseBinEdges.resize(numberOfCoarseBins + 1);
+   for (int i = 0; i <= numberOfCoarseBins; i++)
+   {
+      coarseBinEdges[i] = axis->GetBinLowEdge(firstBin + i*static_cast<int>(rebinFactor));
+   }
+
+   coarseHist.SetBins(numberOfCoarseBins, coarseBinEdges.data());
+   coarseHist.Reset();
+   if (coarseHist.GetSumw2N() == 0) coarseHist.Sumw2();
+
+   int numberOfFilledBins = 0;
+
+   for (int i = 0; i < numberOfCoarseBins; i++)
+   {
+      double content = 0., error2 = 0.;
+      for (int j = firstBin + i*static_cast<int>(rebinFactor);
+           j < firstBin + (i + 1)*static_cast<int>(rebinFactor); j++)
+      {
+         content += hist->GetBinContent(j);
+         error2 += hist->GetBinError(j)*hist->GetBinError(j);
+      }
+
+      if (content > 0.) numberOfFilledBins++;
+
+      // contents are in the units of the original bins
+      coarseHist.SetBinContent(i + 1, content/static_cast<double>(rebinFactor));
+      coarseHist.SetBinError(i + 1, sqrt(error2)/static_cast<double>(rebinFactor));
+   }
+
+   if (numberOfFilledBins < minNumberOfBins)
+   {
+      numberOfSkippedFits++;
+      return -1;
+   }
+
+   numberOfFits++;
+   return coarseHist.Fit(&func, options.c_str());
+}
+
+unsigned long CoarseToFineFit::GetNumberOfFits() const
+{
+   return numberOfFits;
+}
+
+unsigned long CoarseToFineFit::GetNumberOfSkippedFits() const
+{
+   return numberOfSkippedFits;
+}
+
+CoarseToFineFit::~CoarseToFineFit() {};
+
+#endif /* COARSE_TO_FINE_FIT_CPP */
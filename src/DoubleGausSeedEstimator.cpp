@@ -0,0 +1,223 @@
+/**
+ *  @file   DoubleGausSeedEstimator.cpp
+ *  @brief  Contains realisation of class DoubleGausSeedEstimator
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef DOUBLE_GAUS_SEED_ESTIMATOR_CPP
+#define DOUBLE_GAUS_SEED_ESTIMATOR_CPP
+
+#include "../include/DoubleGausSeedEstimator.hpp"
+
+DoubleGausSeedEstimator::DoubleGausSeedEstimator() {};
+
+bool DoubleGausSeedEstimator::Estimate(const TH1 *hist, const double xMin, const double xMax)
+{
+   const TAxis *axis = hist->GetXaxis();
+
+   const int firstBin = CppTools::Maximum(1, axis->FindBin(xMin));
+   const int lastBin = CppTools::Minimum(axis->FindBin(xMax), axis->GetNbins());
+
+   binEdges.clear();
+   cumulative.clear();
+
+   if (lastBin < firstBin) return false;
+
+   binEdges.push_back(axis->GetBinLowEdge(firstBin));
+   cumulative.push_back(0.);
+
+   int firstFilledBin = 0, lastFilledBin = 0;
+   double sumW = 0., sumWX = 0., sumWXX = 0.;
+   maxBinContent = 0.;
+
+   for (int i = firstBin; i <= lastBin; i++)
+   {
+      // negative contents (e.g. after subtractions) are not the entries
+      const double content = CppTools::Maximum(hist->GetBinContent(i), 0.);
+
+      if (content > 0.)
+      {
+         if (firstFilledBin == 0) firstFilledBin = i;
+         lastFilledBin = i;
+      }
+      if (content > maxBinContent) maxBinContent = content;
+
+      const double x = axis->GetBinCenter(i);
+      sumW += content;
+      sumWX += content*x;
+      sumWXX += content*x*x;
+
+      binEdges.push_back(axis->GetBinUpEdge(i));
+      cumulative.push_back(cumulative.back() + content);
+   }
+
+   if (sumW <= 0.) return false;
+
+   firstEdge = axis->GetBinLowEdge(firstFilledBin);
+   lastEdge = axis->GetBinUpEdge(lastFilledBin);
+
+   median = GetQuantile(sumW/2.);
+
+   // MAD is the half width of the window around the median that contains half of the contents
+   double madMin = 0., madMax = CppTools::Maximum(median - firstEdge, lastEdge - median);
+   const double binWidth = (lastEdge - firstEdge)/static_cast<double>(lastFilledBin -
+                                                                      firstFilledBin + 1);
+   while (madMax - madMin > binWidth*1e-3)
+   {
+      const double halfWidth = (madMin + madMax)/2.;
+      if (GetCumulative(median + halfWidth) - GetCumulative(median - halfWidth) < sumW/2.)
+      {
+         madMin = halfWidth;
+      }
+      else madMax = halfWidth;
+   }
+   mad = madMax;
+
+   const double variance = sumWXX/sumW - sumWX*sumWX/sumW/sumW;
+   if (variance <= 0. || mad <= 0.) return false;
+
+   // fractions of the contents in the narrow and in the wide windows around the median
+   const double narrowHalfWidth = mad/2.;
+   const double wideHalfWidth = mad*2.;
+   const double narrowFraction = (GetCumulative(median + narrowHalfWidth) - 
+                                  GetCumulative(median - narrowHalfWidth))/sumW;
+   const double wideFraction = (GetCumulative(median + wideHalfWidth) - 
+                                GetCumulative(median - wideHalfWidth))/sumW;
+
+   // fraction of the contents of the gaussian with the sigma in the window
+   auto GausFraction = [](const double halfWidth, const double sigma)
+   {
+      return erf(halfWidth/sigma/sqrt(2.));
+   };
+
+   // peak contained in 1 bin has MAD close to 0
+   double coreSigma = CppTools::Maximum(1.4826*mad, binWidth/2.);
+   double tailSigma = 2.*coreSigma;
+
+   // fractions in the windows and the variance are the sums of the ones of the core and the tail
+   for (unsigned int i = 0; i < numberOfSplitIterations; i++)
+   {
+      const double coreWideFraction = GausFraction(wideHalfWidth, coreSigma);
+      const double tailWideFraction = GausFraction(wideHalfWidth, tailSigma);
+
+      if (coreWideFraction > tailWideFraction)
+      {
+         coreFraction = (wideFraction - tailWideFraction)/(coreWideFraction - tailWideFraction);
+      }
+      else coreFraction = 1.;
+      coreFraction = CppTools::Minimum(CppTools::Maximum(coreFraction, minFraction), 
+                                       1. - minFraction);
+
+      tailSigma = sqrt(CppTools::Maximum((variance - coreFraction*coreSigma*coreSigma)/
+                                         (1. - coreFraction), 4.*coreSigma*coreSigma));
+
+      // sigma of the core is found from the narrow window by bisection
+      const double coreNarrowFraction = 
+         (narrowFraction - (1. - coreFraction)*GausFraction(narrowHalfWidth, tailSigma))/
+         coreFraction;
+
+      if (coreNarrowFraction <= 0. || coreNarrowFraction >= 1.) continue;
+
+      double sigmaMin = binWidth/10., sigmaMax = tailSigma;
+      while (sigmaMax - sigmaMin > binWidth*1e-3)
+      {
+         const double sigma = (sigmaMin + sigmaMax)/2.;
+         if (GausFraction(narrowHalfWidth, sigma) > coreNarrowFraction) sigmaMin = sigma;
+         else sigmaMax = sigma;
+      }
+      coreSigma = (sigmaMin + sigmaMax)/2.;
+   }
+
+   const double tailMean =
+      CppTools::Minimum(CppTools::Maximum((sumWX/sumW - coreFraction*median)/
+                                          (1. - coreFraction), firstEdge), lastEdge);
+
+   // amplitudes of the gaussians with the integrals of the core and the tail
+   const double coreAmplitude = coreFraction*sumW*binWidth/(coreSigma*sqrt(2.*M_PI));
+   const double tailAmplitude = (1. - coreFraction)*sumW*binWidth/(tailSigma*sqrt(2.*M_PI));
+
+   const double tailSigmaMax = CppTools::Maximum(lastEdge - firstEdge, 2.*tailSigma);
+
+   parameters = {coreAmplitude, median, coreSigma, tailAmplitude, tailMean, tailSigma};
+   parametersMin = {coreAmplitude/2., median - coreSigma, coreSigma/3.,
+                    tailAmplitude/10., firstEdge, coreSigma};
+   parametersMax = {CppTools::Maximum(coreAmplitude*2., maxBinContent), median + coreSigma,
+                    coreSigma*3., tailAmplitude*10., lastEdge, tailSigmaMax};
+
+   return true;
+}
+
+void DoubleGausSeedEstimator::SetSeeds(TF1& func) const
+{
+   if (func.GetNpar() != static_cast<int>(parameters.size()))
+   {
+      CppTools::PrintError("DoubleGausSeedEstimator: Function " + std::string(func.GetName()) +
+                           " is not the sum of 2 gaussians");
+   }
+
+   for (unsigned long i = 0; i < parameters.size(); i++)
+   {
+      func.SetParameter(i, parameters[i]);
+      func.SetParLimits(i, parametersMin[i], parametersMax[i]);
+   }
+}
+
+double DoubleGausSeedEstimator::GetFirstEdge() const
+{
+   return firstEdge;
+}
+
+double DoubleGausSeedEstimator::GetLastEdge() const
+{
+   return lastEdge;
+}
+
+double DoubleGausSeedEstimator::GetMaxBinContent() const
+{
+   return maxBinContent;
+}
+
+double DoubleGausSeedEstimator::GetMedian() const
+{
+   return median;
+}
+
+double DoubleGausSeedEstimator::GetMAD() const
+{
+   return mad;
+}
+
+double DoubleGausSeedEstimator::GetCoreFraction() const
+{
+   return coreFraction;
+}
+
+double DoubleGausSeedEstimator::GetQuantile(const double value) const
+{
+   const unsigned long i =
+      std::lower_bound(cumulative.begin(), cumulative.end(), value) - cumulative.begin();
+
+   if (i == 0) return binEdges.front();
+   if (i == cumulative.size()) return binEdges.back();
+
+   return binEdges[i - 1] + (binEdges[i] - binEdges[i - 1])*
+                            (value - cumulative[i - 1])/(cumulative[i] - cumulative[i - 1]);
+}
+
+double DoubleGausSeedEstimator::GetCumulative(const double x) const
+{
+   if (x <= binEdges.front()) return 0.;
+   if (x >= binEdges.back()) return cumulative.back();
+
+   const unsigned long i =
+      std::upper_bound(binEdges.begin(), binEdges.end(), x) - binEdges.begin();
+
+   return cumulative[i - 1] + (cumulative[i] - cumulative[i - 1])*
+                              (x - binEdges[i - 1])/(binEdges[i] - binEdges[i - 1]);
+}
+
+DoubleGausSeedEstimator::~DoubleGausSeedEstimator() {};
+
+#endif /* DOUBLE_GAUS_SEED_ESTIMATOR_CPP */
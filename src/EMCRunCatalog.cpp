@@ -0,0 +1,316 @@
+/**
+ *  @file   EMCRunCatalog.cpp
+ *  @brief  Contains realisation of class EMCRunCatalog
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_RUN_CATALOG_CPP
+#define EMC_RUN_CATALOG_CPP
+
+#include "../include/EMCRunCatalog.hpp"
+
+EMCRunCatalog::EMCRunCatalog() {};
+
+bool EMCRunCatalog::ReadFile(const std::string& fileName)
+{
+   if (!std::filesystem::exists(fileName)) return false;
+
+   std::ifstream inputFile(fileName);
+
+   unsigned int numberOfSectors;
+   if (!(inputFile >> numberOfSectors))
+   {
+      CppTools::PrintError("EMCRunCatalog::ReadFile: Unable to read the number of sectors from " +
+                           fileName);
+   }
+
+   sectorNames.resize(numberOfSectors);
+   for (std::string& sectorName : sectorNames) inputFile >> sectorName;
+
+   runs.clear();
+
+   // catalog is written sorted by run number hence repeated run number means corrupted file
+   std::set<int> readRunNumbers;
+
+   std::string line;
+   std::getline(inputFile, line); // skipping the rest of the first line
+
+   while (std::getline(inputFile, line))
+   {
+      if (line == "") continue;
+
+      std::istringstream lineStream(line);
+
+      Run run;
+      run.sectorEntries.resize(numberOfSectors);
+
+      lineStream >> run.runNumber >> run.fileSize >> run.modificationTime;
+      for (double& entries : run.sectorEntries) lineStream >> entries;
+
+      // path is the last field and can contain spaces
+      std::getline(lineStream >> std::ws, run.filePath);
+
+      if (lineStream.fail() || run.filePath == "")
+      {
+         CppTools::PrintError("EMCRunCatalog::ReadFile: Corrupted line \"" + line +
+                              "\" in file " + fileName);
+      }
+
+      if (!readRunNumbers.insert(run.runNumber).second)
+      {
+         CppTools::PrintError("EMCRunCatalog::ReadFile: Run " + std::to_string(run.runNumber) +
+                              " is listed more than once in file " + fileName);
+      }
+
+      runs.push_back(run);
+   }
+
+   return true;
+}
+
+void EMCRunCatalog::WriteFile(const std::string& fileName) const
+{
+   // the catalog is written in a temporary file which then replaces the previous one so that 
+   // several programs updating the same catalog concurrently (e.g. units of Pipeline for 
+   // different sectors) never leave or read a partially written file
+   const std::string temporaryFileName = fileName + "." + std::to_string(getpid()) + ".tmp";
+
+   std::ofstream outputFile(temporaryFileName);
+
+   outputFile << sectorNames.size();
+   for (const std::string& sectorName : sectorNames) outputFile << " " << sectorName;
+   outputFile << std::endl;
+
+   for (const Run& run : runs)
+   {
+      outputFile << run.runNumber << " " << run.fileSize << " " << run.modificationTime;
+      for (const double entries : run.sectorEntries) outputFile << " " << entries;
+      outputFile << " " << run.filePath << std::endl;
+   }
+
+   outputFile.close();
+   std::filesystem::rename(temporaryFileName, fileName);
+}
+
+bool EMCRunCatalog::Update(const std::string& inputDir, const std::vector<std::string>& sectorNames,
+                           const unsigned int numberOfThreads, const double minStableTime)
+{
+   bool isChanged = false;
+
+   // entries of all sectors are read again if the sectors changed
+   if (sectorNames != this->sectorNames)
+   {
+      this->sectorNames = sectorNames;
+      runs.clear();
+      isChanged = true;
+   }
+
+   std::map<std::string, Run> previousRuns;
+   for (Run& run : runs) previousRuns[run.filePath] = std::move(run);
+
+   // map is used to get runs sorted by run number
+   std::map<int, Run> updatedRuns;
+   // runs for which files need to be opened
+   std::vector<Run *> runsToRead;
+
+   for (const auto &file : std::filesystem::directory_iterator(inputDir))
+   {
+      const std::string fileName = file.path().filename().string();
+      if (fileName.substr(0, 3) != "se-" || file.path().extension() != ".root") continue;
+
+      // run number is the 6 digits after the prefix (e.g. se-123456.root)
+      if (fileName.size() < 9 ||
+          !std::all_of(fileName.begin() + 3, fileName.begin() + 9,
+                       [](const unsigned char c) {return std::isdigit(c);}))
+      {
+         CppTools::PrintWarning("EMCRunCatalog::Update: Run number can not be read from the name "
+                                "of file " + file.path().string() + "; skipping");
+         continue;
+      }
+
+      Run run;
+      run.runNumber = std::stoi(fileName.substr(3, 6));
+      run.filePath = file.path().string();
+      run.fileSize = std::filesystem::file_size(file.path());
+      run.modificationTime = GetModificationTime(run.filePath);
+
+      // only one file per run is used; the choice does not depend on the order of the files
+      auto duplicateRun = updatedRuns.find(run.runNumber);
+      if (duplicateRun != updatedRuns.end())
+      {
+         const std::string usedFilePath = 
+            std::min(duplicateRun->second.filePath, run.filePath);
+         CppTools::PrintWarning("EMCRunCatalog::Update: Files " + duplicateRun->second.filePath +
+                                " and " + run.filePath + " have the same run number " + 
+                                std::to_string(run.runNumber) + "; only " + usedFilePath + 
+                                " is used");
+         if (usedFilePath == duplicateRun->second.filePath) continue;
+      }
+
+      auto previousRun = previousRuns.find(run.filePath);
+
+      if (previousRun != previousRuns.end() &&
+          previousRun->second.fileSize == run.fileSize &&
+          previousRun->second.modificationTime == run.modificationTime)
+      {
+         updatedRuns[run.runNumber] = std::move(previousRun->second);
+         previousRuns.erase(previousRun);
+         continue;
+      }
+
+      isChanged = true;
+      updatedRuns[run.runNumber] = run;
+   }
+
+   // files of the runs that remained were removed
+   if (!previousRuns.empty()) isChanged = true;
+
+   for (auto& [runNumber, run] : updatedRuns)
+   {
+      if (run.sectorEntries.size() != sectorNames.size()) runsToRead.push_back(&run);
+   }
+
+   // files that are still being written are not opened; they are left out of the catalog 
+   // and are added on one of the next updates once their size stops changing
+   if (minStableTime > 0. && !runsToRead.empty())
+   {
+      std::this_thread::
+         sleep_for(std::chrono::milliseconds(static_cast<long>(minStableTime*1000.)));
+
+      for (Run *run : runsToRead)
+      {
+         std::error_code errorCode;
+         const unsigned long fileSize = std::filesystem::file_size(run->filePath, errorCode);
+
+         if (errorCode || fileSize != run->fileSize || 
+             GetModificationTime(run->filePath) != run->modificationTime)
+         {
+            run->isIncomplete = true;
+         }
+      }
+   }
+
+   // index of the next run to be read
+   std::atomic<unsigned long> nextRunIndex{0};
+
+   auto ReadRuns = [&]()
+   {
+      for (unsigned long i = nextRunIndex++; i < runsToRead.size(); i = nextRunIndex++)
+      {
+         if (runsToRead[i]->isIncomplete) continue;
+
+         TFile inputFile(runsToRead[i]->filePath.c_str());
+
+         // file without the directory of keys at the end was not closed by the writer
+         if (inputFile.IsZombie() || inputFile.TestBit(TFile::kRecovered))
+         {
+            runsToRead[i]->isIncomplete = true;
+            continue;
+         }
+
+         runsToRead[i]->sectorEntries.assign(sectorNames.size(), 0.);
+
+         for (unsigned long j = 0; j < sectorNames.size(); j++)
+         {
+            TH2D *tVsADC = static_cast<TH2D *>
+               (inputFile.Get(("tcorr vs ADC: " + sectorNames[j]).c_str()));
+            if (tVsADC) runsToRead[i]->sectorEntries[j] = tVsADC->Integral();
+         }
+      }
+   };
+
+   if (!runsToRead.empty())
+   {
+      ROOT::EnableThreadSafety();
+
+      std::vector<std::thread> thrCalls;
+      for (unsigned int i = 0; i < CppTools::Minimum(static_cast<unsigned long>(numberOfThreads),
+                                                     runsToRead.size()); i++)
+      {
+         thrCalls.emplace_back(ReadRuns);
+      }
+      for (std::thread& thr : thrCalls) thr.join();
+   }
+
+   runs.clear();
+   for (auto& [runNumber, run] : updatedRuns)
+   {
+      if (run.isIncomplete)
+      {
+         CppTools::PrintWarning("EMCRunCatalog::Update: File " + run.filePath + 
+                                " is incomplete or is still being written; it is skipped");
+         continue;
+      }
+      runs.push_back(std::move(run));
+   }
+
+   return isChanged;
+}
+
+std::vector<int> EMCRunCatalog::GetRunNumbers() const
+{
+   std::vector<int> runNumbers;
+   for (const Run& run : runs) runNumbers.push_back(run.runNumber);
+   return runNumbers;
+}
+
+unsigned long EMCRunCatalog::GetNumberOfRuns() const
+{
+   return runs.size();
+}
+
+double EMCRunCatalog::GetEntries(const unsigned long runIndex, const unsigned int sectorBin) const
+{
+   return runs[runIndex].sectorEntries[sectorBin];
+}
+
+long long EMCRunCatalog::GetModificationTime(const unsigned long runIndex) const
+{
+   return runs[runIndex].modificationTime;
+}
+
+long long EMCRunCatalog::GetModificationTime(const std::string& fileName)
+{
+   return std::chrono::duration_cast<std::chrono::seconds>
+      (std::filesystem::last_write_time(fileName).time_since_epoch()).count();
+}
+
+unsigned long EMCRunCatalog::GetFirstRunIndexOfChunk(const unsigned int chunkIndex,
+                                                      const unsigned int numberOfChunks,
+                                                      const double minEntries,
+                                                      const std::vector<unsigned long>& runIndices) const
+{
+   if (chunkIndex == 0) return 0;
+   if (chunkIndex >= numberOfChunks) return runIndices.size();
+
+   double totalCost = 0.;
+   for (const unsigned long runIndex : runIndices) totalCost += GetCost(runs[runIndex], minEntries);
+
+   // the chunk starts from the first run for which the cost
+   // of all previous runs exceeds the cost of previous chunks
+   const double previousChunksCost = totalCost*chunkIndex/numberOfChunks;
+
+   double cost = 0.;
+   for (unsigned long i = 0; i < runIndices.size(); i++)
+   {
+      if (cost >= previousChunksCost) return i;
+      cost += GetCost(runs[runIndices[i]], minEntries);
+   }
+   return runIndices.size();
+}
+
+double EMCRunCatalog::GetCost(const Run& run, const double minEntries) const
+{
+   double cost = 1.;
+   for (const double entries : run.sectorEntries)
+   {
+      if (entries >= minEntries) cost += entries;
+   }
+   return cost;
+}
+
+EMCRunCatalog::~EMCRunCatalog() {};
+
+#endif /* EMC_RUN_CATALOG_CPP */
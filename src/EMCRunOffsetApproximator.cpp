@@ -0,0 +1,442 @@
+/**
+ *  @file   EMCRunOffsetApproximator.cpp
+ *  @brief  Contains realisation of class EMCRunOffsetApproximator
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_RUN_OFFSET_APPROXIMATOR_CPP
+#define EMC_RUN_OFFSET_APPROXIMATOR_CPP
+
+#include "../include/EMCRunOffsetApproximator.hpp"
+
+EMCRunOffsetApproximator::EMCRunOffsetApproximator() {};
+
+void EMCRunOffsetApproximator::Init(InputYAMLReader& inputYAMLCal)
+{
+   runName = inputYAMLCal["run_name"].as<std::string>();
+   sectors = inputYAMLCal["sectors_to_calibrate"];
+
+   tPhotonFitFunc = inputYAMLCal["t_photon_fit_func"].as<std::string>();
+   tPhotonMeanVsADCFitFunc = inputYAMLCal["tcorr_mean_vs_adc_fit_func"].as<std::string>();
+
+   fitNTries = inputYAMLCal["number_of_fit_tries"].as<unsigned int>();
+   isTPhotonProjectionWritten = inputYAMLCal["write_tcorr_projections"].as<bool>();
+
+   const YAML::Node photonPeakEstimatorNode = inputYAMLCal["photon_peak_estimator"];
+   photonPeakEstimator =
+      RobustPeakEstimator(photonPeakEstimatorNode["n_sigma"].as<double>(),
+                          photonPeakEstimatorNode["max_number_of_iterations"].as<unsigned int>(),
+                          photonPeakEstimatorNode["min_signal_fraction"].as<double>());
+
+   tPhotonFitLadder = FitStrategyLadder("tcorr fits", inputYAMLCal["fit_strategy"]["t_photon"]);
+   tPhotonCoarseToFineFit = CoarseToFineFit(inputYAMLCal["coarse_to_fine_fit"]);
+}
+
+void EMCRunOffsetApproximator::
+ProcessRuns(const EMCRunCatalog& runCatalog, const std::vector<unsigned long>& runIndices,
+            const unsigned long firstRunIndex, const unsigned long lastRunIndex,
+            const double minRunEntries, const std::vector<unsigned int>& sectorBins,
+            const std::vector<std::string>& outputFileNames,
+            const std::function<void(const unsigned long, const int,
+                                     const TF1 *)>& processRunResult)
+{
+   const std::vector<int> runNumbers = runCatalog.GetRunNumbers();
+
+   // output file is not created for the sector with empty name
+   std::vector<std::unique_ptr<TFile>> sectorOutputFiles(sectorBins.size());
+   // trees with results for merged ADC bins; they are owned by the output files
+   std::vector<TTree *> sectorTPhotonPeaks(sectorBins.size(), nullptr);
+
+   for (unsigned long i = 0; i < sectorBins.size(); i++)
+   {
+      if (outputFileNames[i] == "") continue;
+
+      sectorOutputFiles[i] =
+         std::unique_ptr<TFile>(TFile::Open(outputFileNames[i].c_str(), "RECREATE"));
+
+      sectorOutputFiles[i]->cd();
+      sectorTPhotonPeaks[i] = CreateTPhotonPeaksTree();
+   }
+
+   for (unsigned long i = firstRunIndex; i < lastRunIndex; i++)
+   {
+      const unsigned long runIndex = runIndices[i];
+      const int runNumber = runNumbers[runIndex];
+
+      // file is opened once and histograms of all sectors are read from it;
+      // if all sectors are skipped or bad for this run the file is not opened
+      std::unique_ptr<TFile> inputFile;
+      for (unsigned long j = 0; j < sectorBins.size(); j++)
+      {
+         if (sectorOutputFiles[j] && runCatalog.GetEntries(runIndex, sectorBins[j]) >= minRunEntries)
+         {
+            inputFile = std::unique_ptr<TFile>
+               (TFile::Open(("data/EMCTiming/" + runName + "/se-" +
+                             std::to_string(runNumber) + ".root").c_str()));
+            break;
+         }
+      }
+
+      for (unsigned long j = 0; j < sectorBins.size(); j++)
+      {
+         // skipped sector or bad run; runs with insufficient statistics can't pass the bin merging
+         if (!sectorOutputFiles[j] ||
+             runCatalog.GetEntries(runIndex, sectorBins[j]) < minRunEntries)
+         {
+            processRunResult(j, runNumber, nullptr);
+            continue;
+         }
+
+         const YAML::Node sector = sectors[sectorBins[j]];
+         const std::string sectorName = sector["name"].as<std::string>();
+
+         TH2D *tVsADC = static_cast<TH2D *>(inputFile->Get(("tcorr vs ADC: " + sectorName).c_str()));
+
+         if (!tVsADC)
+         {
+            CppTools::PrintError("Histogram tcorr vs ADC: " + sectorName + " does not exist in " +
+                                 inputFile->GetName());
+         }
+
+         if (isTPhotonProjectionWritten)
+         {
+            sectorOutputFiles[j]->mkdir(std::to_string(runNumber).c_str());
+            sectorOutputFiles[j]->cd(std::to_string(runNumber).c_str());
+         }
+
+         tPhotonPeak.run = runNumber;
+         tPhotonPeak.sector = sectorBins[j];
+
+         // functions of the previous run are no longer needed
+         fitFunctionPool.Recycle();
+
+         TF1& tPhotonMeanVsADCFit = *fitFunctionPool.
+            Get("tcorr mean vs ADC fit", tPhotonMeanVsADCFitFunc, 0., 10000);
+
+         if (ProcessRun(tVsADC, sector, runNumber, tPhotonMeanVsADCFit, sectorTPhotonPeaks[j]))
+         {
+            processRunResult(j, runNumber, &tPhotonMeanVsADCFit);
+         }
+         else processRunResult(j, runNumber, nullptr);
+      }
+   }
+
+   for (unsigned long i = 0; i < sectorBins.size(); i++)
+   {
+      if (sectorOutputFiles[i])
+      {
+         sectorOutputFiles[i]->cd();
+         sectorTPhotonPeaks[i]->Write();
+         sectorOutputFiles[i]->Close();
+      }
+   }
+}
+
+bool EMCRunOffsetApproximator::ProcessRun(TH2D *tVsADC, const YAML::Node& sector,
+                                          const int runNumber, TF1& tPhotonMeanVsADCFit,
+                                          TTree *tPhotonPeaks)
+{
+   TGraphErrors meansTVsADC;
+   TGraphErrors sigmasTVsADC;
+
+   // projections of the previous run are no longer needed
+   histogramArena.Recycle();
+
+   // integrals over merged ADC bins are taken from prefix sums
+   const SummedAreaTable tVsADCIntegrals(tVsADC);
+
+   for (const auto& rangeADC : sector["adc_ranges"])
+   {
+      const double rangeADCMin = rangeADC["min"].as<double>();
+      const double rangeADCMax = rangeADC["max"].as<double>();
+
+      // bins are merged until there is enough statistics for the fit
+      for (const auto& [firstADCBin, lastADCBin] : tVsADCIntegrals.
+           GetMergedXBins(CppTools::Maximum(1, tVsADC->GetXaxis()->FindBin(rangeADCMin)),
+                          CppTools::Minimum(tVsADC->GetXaxis()->FindBin(rangeADCMax),
+                                            tVsADC->GetXaxis()->GetNbins()),
+                          tVsADC->GetYaxis()->FindBin(-10.),
+                          tVsADC->GetYaxis()->FindBin(10.), 1000.))
+      {
+         // ADC value of the (current bin)/(merged bins)
+         const double valADC =
+            CppTools::Average(tVsADC->GetXaxis()->GetBinCenter(lastADCBin),
+                              tVsADC->GetXaxis()->GetBinCenter(firstADCBin));
+
+         TH1D *tVsADCProj =
+            histogramArena.ProjectionY(tVsADC, "tcorr " + CppTools::DtoStr(valADC, 0),
+                                       firstADCBin, lastADCBin);
+
+         // mean and sigma of the photon signal
+         double tPhotonMean, tPhotonSigma;
+
+         TF1& tPhotonFit =
+            *fitFunctionPool.Get("tcorr fit " + CppTools::DtoStr(valADC, 0), tPhotonFitFunc);
+
+         // status of the last fit performed by the fit tiers
+         int tPhotonFitStatus = 0;
+
+         auto EstimateTPhoton = [&]()
+         {
+            // estimates that result in outliers are escalated to the fit tiers
+            return photonPeakEstimator.Estimate(tVsADCProj, -10., 10.) &&
+                   !IsTPhotonOutlier(photonPeakEstimator.GetMean(),
+                                     photonPeakEstimator.GetSigma());
+         };
+
+         auto FitTPhoton = [&](const FitStrategyLadder::Tier& tier, const unsigned int tryIndex)
+         {
+            // every tier starts from the default seeds refined by the coarse fit
+            if (tryIndex == 0)
+            {
+               for (int i = 0; i < tPhotonFit.GetNpar(); i++) tPhotonFit.ReleaseParameter(i);
+               tPhotonFit.SetRange(-10., 10.);
+               tPhotonFit.SetParameters(tVsADCProj->GetMaximum(), 0, 0.5, 1., 1.);
+               tPhotonCoarseToFineFit.Fit(tVsADCProj, tPhotonFit);
+            }
+
+            tPhotonFitStatus = tVsADCProj->Fit(&tPhotonFit, tier.options.c_str());
+
+            const double parameterDeviationScale =
+               1. + 1./static_cast<double>((tryIndex + 1)*(tryIndex + 1));
+
+            tPhotonFit.SetRange(tPhotonFit.GetParameter(1) -
+                                fabs(tPhotonFit.GetParameter(2))*parameterDeviationScale,
+                                tPhotonFit.GetParameter(1) +
+                                fabs(tPhotonFit.GetParameter(2))*parameterDeviationScale);
+
+            for (int i = 0; i < tPhotonFit.GetNpar(); i++)
+            {
+               if (i == 1)
+               {
+                  tPhotonFit.SetParLimits(i, tPhotonFit.GetParameter(1) -
+                                          fabs(tPhotonFit.GetParameter(2))*
+                                          (parameterDeviationScale - 1.),
+                                          tPhotonFit.GetParameter(1) +
+                                          fabs(tPhotonFit.GetParameter(2))*
+                                          (parameterDeviationScale - 1.));
+               }
+               else
+               {
+                  tPhotonFit.SetParLimits(i, tPhotonFit.GetParameter(i)/parameterDeviationScale,
+                                          tPhotonFit.GetParameter(i)*parameterDeviationScale);
+               }
+            }
+
+            return tPhotonFitStatus;
+         };
+
+         // fits that result in outliers are escalated to the next tier
+         auto IsFitAccepted = [&]()
+         {
+            return tPhotonFitLadder.IsFitGood(tPhotonFit) &&
+                   !IsTPhotonOutlier(tPhotonFit.GetParameter(1), fabs(tPhotonFit.GetParameter(2)));
+         };
+
+         // cheaper tiers are escalated to more expensive ones only if their results are rejected
+         tPhotonFitLadder.Run(EstimateTPhoton, FitTPhoton, IsFitAccepted);
+
+         if (tPhotonFitLadder.GetLastTier().method == FitStrategyLadder::Method::ESTIMATE)
+         {
+            tPhotonMean = photonPeakEstimator.GetMean();
+            tPhotonSigma = photonPeakEstimator.GetSigma();
+
+            tPhotonPeak.meanError = photonPeakEstimator.GetMeanError();
+            tPhotonPeak.sigmaError = photonPeakEstimator.GetSigmaError();
+            tPhotonPeak.status = 0;
+            tPhotonPeak.method = 0;
+         }
+         else
+         {
+            tPhotonMean = tPhotonFit.GetParameter(1);
+            tPhotonSigma = fabs(tPhotonFit.GetParameter(2));
+
+            tPhotonPeak.meanError = tPhotonFit.GetParError(1);
+            tPhotonPeak.sigmaError = tPhotonFit.GetParError(2);
+            tPhotonPeak.status = tPhotonFitStatus;
+            tPhotonPeak.method = 1;
+
+            // fits are performed with option N hence the function is stored in the projection here
+            if (isTPhotonProjectionWritten) tVsADCProj->GetListOfFunctions()->Add(tPhotonFit.Clone());
+         }
+
+         if (isTPhotonProjectionWritten) tVsADCProj->Write();
+
+         tPhotonPeak.adcMin = tVsADC->GetXaxis()->GetBinLowEdge(firstADCBin);
+         tPhotonPeak.adcMax = tVsADC->GetXaxis()->GetBinUpEdge(lastADCBin);
+         tPhotonPeak.mean = tPhotonMean;
+         tPhotonPeak.sigma = tPhotonSigma;
+         // outliers are skipped
+         tPhotonPeak.isOutlier = IsTPhotonOutlier(tPhotonMean, tPhotonSigma);
+
+         tPhotonPeaks->Fill();
+
+         if (tPhotonPeak.isOutlier) continue;
+
+         meansTVsADC.AddPoint(valADC, tPhotonMean);
+         sigmasTVsADC.AddPoint(valADC, tPhotonSigma);
+      }
+   }
+
+   meansTVsADC.SetMarkerStyle(20);
+   meansTVsADC.SetMarkerColor(kRed - 3);
+   meansTVsADC.SetMarkerSize(0.5);
+
+   sigmasTVsADC.SetMarkerStyle(20);
+   sigmasTVsADC.SetMarkerColor(kAzure - 3);
+   sigmasTVsADC.SetMarkerSize(0.5);
+
+   tPhotonMeanVsADCFit.SetLineWidth(3);
+   tPhotonMeanVsADCFit.SetLineStyle(2);
+   tPhotonMeanVsADCFit.SetLineColor(kBlack);
+
+   if (meansTVsADC.GetN() == 0) return false; // bad run that passed the first bad run check
+   else if (meansTVsADC.GetN() > 1)
+   {
+      for (unsigned int i = 1; i < fitNTries; i++)
+      {
+         meansTVsADC.Fit(&tPhotonMeanVsADCFit, "RQMBN");
+
+         for (int j = 0; j < tPhotonMeanVsADCFit.GetNpar(); j++)
+         {
+            tPhotonMeanVsADCFit.SetParLimits(j, tPhotonMeanVsADCFit.GetParameter(j)*
+                                           (1. - 6./static_cast<double>(i*i*i)),
+                                           tPhotonMeanVsADCFit.GetParameter(j)*
+                                           (1. + 4./static_cast<double>(i*i*i)));
+         }
+      }
+   }
+   else // root can't fit 1 point data
+   {
+      tPhotonMeanVsADCFit.SetParameter(0, meansTVsADC.GetPointY(0));
+      for (int i = 1; i < tPhotonMeanVsADCFit.GetNpar(); i++)
+      {
+         tPhotonMeanVsADCFit.SetParameter(i, 0.);
+      }
+   }
+
+   TCanvas parCanv("mean and sigma t parameters vs ADC", "", 600, 600);
+
+   TH1 *frame = gPad->DrawFrame(meansTVsADC.GetPointX(0)/1.1,
+                                CppTools::Minimum(TMath::MinElement(meansTVsADC.GetN(),
+                                                                    meansTVsADC.GetY()),
+                                                  TMath::MinElement(sigmasTVsADC.GetN(),
+                                                                    sigmasTVsADC.GetY())) - 0.5,
+                                meansTVsADC.GetPointX(meansTVsADC.GetN() - 1)*1.1,
+                                CppTools::Maximum(TMath::MaxElement(meansTVsADC.GetN(),
+                                                                    meansTVsADC.GetY()),
+                                                  TMath::MaxElement(sigmasTVsADC.GetN(),
+                                                                    sigmasTVsADC.GetY())) + 0.5);
+
+   frame->GetXaxis()->SetTitle("ADC");
+
+   tPhotonMeanVsADCFit.Draw("SAME");
+   meansTVsADC.Draw("P");
+   sigmasTVsADC.Draw("P");
+
+   ROOTTools::PrintCanvas(&parCanv, "output/EMCTCalibration/" + runName + "/" +
+                          sector["name"].as<std::string>() + "/tcorr_par_vs_adc_" +
+                          std::to_string(runNumber));
+
+   return true;
+}
+
+void EMCRunOffsetApproximator::MergeChunks(const std::string& outputFileName,
+                                           const std::vector<std::string>& chunkFileNames,
+                                           const bool isUpdated, const std::set<int>& replacedRuns)
+{
+   if (isUpdated)
+   {
+      // directories and tree entries of the replaced runs are removed before the merging
+      std::unique_ptr<TFile> outputFile(TFile::Open(outputFileName.c_str(), "UPDATE"));
+
+      for (const int runNumber : replacedRuns)
+      {
+         outputFile->Delete((std::to_string(runNumber) + ";*").c_str());
+      }
+
+      TTree *tPhotonPeaks = outputFile->Get<TTree>("tcorr_fits");
+      if (tPhotonPeaks)
+      {
+         SetTPhotonPeaksBranchAddresses(tPhotonPeaks);
+
+         outputFile->cd();
+         TTree *keptTPhotonPeaks = tPhotonPeaks->CloneTree(0);
+
+         for (long long i = 0; i < tPhotonPeaks->GetEntries(); i++)
+         {
+            tPhotonPeaks->GetEntry(i);
+            if (replacedRuns.find(tPhotonPeak.run) == replacedRuns.end()) keptTPhotonPeaks->Fill();
+         }
+
+         keptTPhotonPeaks->Write("", TObject::kOverwrite);
+      }
+      outputFile->Close();
+   }
+
+   TFileMerger outputFileMerger(false);
+   outputFileMerger.OutputFile(outputFileName.c_str(), isUpdated ? "UPDATE" : "RECREATE");
+
+   // every chunk contains its own directories of runs hence they are simply merged in one file
+   for (const std::string& chunkFileName : chunkFileNames)
+   {
+      if (std::filesystem::exists(chunkFileName))
+      {
+         outputFileMerger.AddFile(chunkFileName.c_str(), false);
+      }
+   }
+
+   // directories of new runs are added to the existing file
+   if (isUpdated) outputFileMerger.PartialMerge(TFileMerger::kIncremental | TFileMerger::kAll);
+   else outputFileMerger.Merge();
+}
+
+FitStrategyLadder& EMCRunOffsetApproximator::GetTPhotonFitLadder()
+{
+   return tPhotonFitLadder;
+}
+
+TTree *EMCRunOffsetApproximator::CreateTPhotonPeaksTree()
+{
+   TTree *tPhotonPeaks = new TTree("tcorr_fits", "mean and sigma of tcorr of photons in merged ADC bins");
+
+   tPhotonPeaks->Branch("run", &tPhotonPeak.run);
+   tPhotonPeaks->Branch("sector", &tPhotonPeak.sector);
+   tPhotonPeaks->Branch("adc_min", &tPhotonPeak.adcMin);
+   tPhotonPeaks->Branch("adc_max", &tPhotonPeak.adcMax);
+   tPhotonPeaks->Branch("mean", &tPhotonPeak.mean);
+   tPhotonPeaks->Branch("mean_error", &tPhotonPeak.meanError);
+   tPhotonPeaks->Branch("sigma", &tPhotonPeak.sigma);
+   tPhotonPeaks->Branch("sigma_error", &tPhotonPeak.sigmaError);
+   tPhotonPeaks->Branch("status", &tPhotonPeak.status);
+   tPhotonPeaks->Branch("method", &tPhotonPeak.method);
+   tPhotonPeaks->Branch("is_outlier", &tPhotonPeak.isOutlier);
+
+   return tPhotonPeaks;
+}
+
+void EMCRunOffsetApproximator::SetTPhotonPeaksBranchAddresses(TTree *tPhotonPeaks)
+{
+   tPhotonPeaks->SetBranchAddress("run", &tPhotonPeak.run);
+   tPhotonPeaks->SetBranchAddress("sector", &tPhotonPeak.sector);
+   tPhotonPeaks->SetBranchAddress("adc_min", &tPhotonPeak.adcMin);
+   tPhotonPeaks->SetBranchAddress("adc_max", &tPhotonPeak.adcMax);
+   tPhotonPeaks->SetBranchAddress("mean", &tPhotonPeak.mean);
+   tPhotonPeaks->SetBranchAddress("mean_error", &tPhotonPeak.meanError);
+   tPhotonPeaks->SetBranchAddress("sigma", &tPhotonPeak.sigma);
+   tPhotonPeaks->SetBranchAddress("sigma_error", &tPhotonPeak.sigmaError);
+   tPhotonPeaks->SetBranchAddress("status", &tPhotonPeak.status);
+   tPhotonPeaks->SetBranchAddress("method", &tPhotonPeak.method);
+   tPhotonPeaks->SetBranchAddress("is_outlier", &tPhotonPeak.isOutlier);
+}
+
+bool EMCRunOffsetApproximator::IsTPhotonOutlier(const double mean, const double sigma)
+{
+   return (fabs(mean) > 5. || sigma > 3. || sigma < 0.1);
+}
+
+EMCRunOffsetApproximator::~EMCRunOffsetApproximator() {};
+
+#endif /* EMC_RUN_OFFSET_APPROXIMATOR_CPP */
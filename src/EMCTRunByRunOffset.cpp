@@ -18,15 +18,16 @@ int main(int argc, char **argv)
 {
    using namespace EMCTiming;
 
-   if (argc < 2 || argc > 5) 
+   if (argc < 2 || argc > 7 || argc == 6) 
    {
-      std::string errMsg = "Expected 1-2 or 3-4 parameters while " + std::to_string(argc - 1) + 
+      std::string errMsg = "Expected 1-2, 3-4, or 6 parameters while " + std::to_string(argc - 1) + 
                            " parameter(s) were provided \n";
       errMsg += "Usage: bin/EMCTRunByRunOffset inputFile numberOfThreads=" + 
                 std::to_string(std::thread::hardware_concurrency()) + "*\n";
-      errMsg += "Or**: bin/EMCTRunByRunOffset inputFile sectorBin numberOfThreads showProgress=true";
+      errMsg += "Or**: bin/EMCTRunByRunOffset inputFile sectorBin numberOfThreads showProgress=true ";
+      errMsg += "runChunkIndex=0 numberOfRunChunks=1\n";
       errMsg += "*: default argument is the number of threads on the current machine \n";
-      errMsg += "**: this mode processes only one sector \n";
+      errMsg += "**: this mode processes only one sector (or all sectors if sectorBin is -1) \n";
       CppTools::PrintError(errMsg);
    }
 
@@ -43,8 +44,11 @@ int main(int argc, char **argv)
    inputYAMLCal.CheckStatus("emc_timing");
 
    runName = inputYAMLCal["run_name"].as<std::string>();
-
-   CppTools::CheckInputFile("data/EMCTiming/" + runName + "/raw_sum.root");
+   isRunByRunWatched = inputYAMLCal["run_by_run_watch"]["enable"].as<bool>();
+   watchDebounceTime = inputYAMLCal["run_by_run_watch"]["debounce_time"].as<double>();
+   // results for new runs are merged in the existing outputs in watch mode
+   isRunByRunIncremental = 
+      (inputYAMLCal["run_by_run_incremental"].as<bool>() || isRunByRunWatched);
 
    // opening input file with parameters of a run
    inputYAMLMain.OpenFile("input/" + runName + "/main.yaml");
@@ -59,310 +63,553 @@ int main(int argc, char **argv)
 
    TDirectory::AddDirectory(kFALSE);
 
-   const std::string inputDir = "data/EMCTiming/" + runName + "/";
-
-   std::set<std::filesystem::path> inputDataFilePaths;
+   const std::string runCatalogFileName = 
+      "output/EMCTCalibration/" + runName + "/run_catalog.txt";
 
-   for (const auto &file : std::filesystem::directory_iterator(inputDir))
+   // runs are taken from the catalog which is updated only for new and changed se-<run>.root files
+   auto ReadRunCatalog = [&](const bool isUpdated)
    {
-      const std::string fileName = static_cast<std::string>(file.path());
-      if (fileName.substr(inputDir.size(), 3) == static_cast<std::string>("se-"))
+      if (!isUpdated)
       {
-         inputDataFilePaths.insert(file);
+         if (!runCatalog.ReadFile(runCatalogFileName))
+         {
+            CppTools::PrintError("Run catalog " + runCatalogFileName + " does not exist");
+         }
       }
-   }
+      else
+      {
+         std::vector<std::string> sectorNames;
+         for (const auto& sector : inputYAMLCal["sectors_to_calibrate"])
+         {
+            sectorNames.push_back(sector["name"].as<std::string>());
+         }
 
-   // iterating over set inputDataFiles to get run numbers sorted
-   for (const auto &file : inputDataFilePaths)
-   {
-      const std::string fileName = static_cast<std::string>(file);
-      runNumbers.emplace_back(std::stoi(fileName.substr(inputDir.size() + 3, 6)));
-   }
+         system(("mkdir -p output/EMCTCalibration/" + runName).c_str());
+
+         runCatalog.ReadFile(runCatalogFileName);
+         // in watch mode files can be scanned while they are written; they are 
+         // opened only after their size did not change for watchDebounceTime
+         if (runCatalog.Update("data/EMCTiming/" + runName + "/", sectorNames, numberOfThreads,
+                               (isRunByRunWatched ? watchDebounceTime : 0.)))
+         {
+            runCatalog.WriteFile(runCatalogFileName);
+         }
+      }
+      runNumbers = runCatalog.GetRunNumbers();
 
-   if (argc < 3) // Mode1
+      runIndicesToProcess.clear();
+      for (unsigned long i = 0; i < runNumbers.size(); i++) runIndicesToProcess.push_back(i);
+   };
+
+   if (argc < 4) // Mode1
    {
       programMode = 1;
       if (argc > 2) numberOfThreads = std::stoi(argv[2]);
       else numberOfThreads = std::thread::hardware_concurrency();
       if (numberOfThreads == 0) CppTools::PrintError("Number of threads must be bigger than 0");
 
-      system(("mkdir -p tmp/progress/EMCTRunByRunOffset/" + runName).c_str());
-      system(("rm -rf tmp/progress/EMCTRunByRunOffset/" + runName + "/*").c_str());
+      // processes runs that are new or changed since the last call (all runs if not incremental)
+      auto ProcessNewRuns = [&]()
+      {
+         ReadRunCatalog(true);
 
-      numberOfIterations = inputYAMLCal["sectors_to_calibrate"].size()*runNumbers.size();
+         outputDir = "output/EMCTCalibration/" + runName + "/";
 
-      int subprocessNumberOfThreads = numberOfThreads/inputYAMLCal["sectors_to_calibrate"].size();
-      if (subprocessNumberOfThreads < 1) subprocessNumberOfThreads = 1;
+         const unsigned int numberOfSectors = inputYAMLCal["sectors_to_calibrate"].size();
 
-      auto SingleThreadCall = [&](const unsigned long sectorBin)
-      {
-         // man ROOT sucks (TF1::Fit is still not thread safe) so I have to call the same program 
-         // recursively in shell outside of the current instance to implement multithreading
-         system((static_cast<std::string>("./bin/EMCTRunByRunOffset ") + 
-                 argv[1] + " " + std::to_string(sectorBin) + " " + 
-                 std::to_string(subprocessNumberOfThreads) + " 0").c_str());;
-      };
+         std::vector<unsigned int> sectorBins;
+         for (unsigned int sectorBin = 0; sectorBin < numberOfSectors; sectorBin++)
+         {
+            sectorBins.push_back(sectorBin);
+         }
 
-      std::vector<std::thread> thrCalls;
-      std::thread pBarThr(PBarCall); 
+         SelectRunsToProcess(sectorBins);
 
-      for (unsigned int sectorBin = 0; sectorBin < 
-           inputYAMLCal["sectors_to_calibrate"].size(); sectorBin++)
-      {
-            if (thrCalls.size() >= numberOfThreads)
+         if (runIndicesToProcess.empty())
+         {
+            // without incremental mode no runs are skipped hence there are no input files
+            if (isRunByRunIncremental && !runNumbers.empty())
             {
-               while (!thrCalls.empty())
-               {
-                  thrCalls.back().join();
-                  thrCalls.pop_back();
-               }
+               CppTools::PrintInfo("All runs were already processed");
             }
-            thrCalls.emplace_back(SingleThreadCall, sectorBin);
-      }
+            else CppTools::PrintInfo("No se-<run>.root files were found in data/EMCTiming/" + 
+                                     runName);
+            return;
+         }
+
+         system(("mkdir -p tmp/progress/EMCTRunByRunOffset/" + runName).c_str());
+         system(("rm -rf tmp/progress/EMCTRunByRunOffset/" + runName + "/*").c_str());
+
+         numberOfIterations = numberOfSectors*runIndicesToProcess.size();
+
+         // runs are independent hence they are split into contiguous chunks each of which is 
+         // processed for all sectors so that every se-<run>.root file is opened only once;
+         // 2 chunks per thread are used to balance runs with different statistics
+         numberOfRunChunks = CppTools::Minimum(2*numberOfThreads, 
+                                               static_cast<unsigned int>(runIndicesToProcess.size()));
+
+         for (unsigned int sectorBin = 0; sectorBin < numberOfSectors; sectorBin++)
+         {
+            system(("mkdir -p tmp/EMCTRunByRunOffset/" + runName + "/" + 
+                    std::to_string(sectorBin)).c_str());
+            system(("rm -rf tmp/EMCTRunByRunOffset/" + runName + "/" + 
+                    std::to_string(sectorBin) + "/*").c_str());
+         }
+
+         // index of the next chunk of runs to be processed
+         std::atomic<unsigned int> nextRunChunkIndex{0};
+
+         // threads of all subprocesses are taken from the same pool
+         ThreadTokenPool threadTokenPool(numberOfThreads);
+         // subprocesses are started only while their memory fits in the budget
+         MemoryBudget memoryBudget(inputYAMLCal["memory_budget"].as<double>());
+
+         auto SingleThreadCall = [&]()
+         {
+            for (unsigned int i = nextRunChunkIndex++; i < numberOfRunChunks; i = nextRunChunkIndex++)
+            {
+               // subprocess waits for the memory before taking the thread so that the threads 
+               // are not held by the subprocesses that can not be started yet
+               const unsigned long memoryBudgetIndex = memoryBudget.Admit("EMCTRunByRunOffset");
+               threadTokenPool.Acquire();
+
+               // man ROOT sucks (TF1::Fit is still not thread safe) so I have to call the same program 
+               // recursively in shell outside of the current instance to implement multithreading
+               system((memoryBudget.GetEnvironment(memoryBudgetIndex) + "./bin/EMCTRunByRunOffset " + 
+                       argv[1] + " -1 1 0 " + std::to_string(i) + " " + 
+                       std::to_string(numberOfRunChunks)).c_str());
+
+               memoryBudget.Release(memoryBudgetIndex);
+               threadTokenPool.Release();
+            }
+         };
+
+         numberOfCalls = 0;
+         isProcessFinished = false;
+
+         std::vector<std::thread> thrCalls;
+         std::thread pBarThr(PBarCall); 
+
+         for (unsigned int i = 0; i < CppTools::Minimum(numberOfThreads, numberOfRunChunks); i++)
+         {
+            thrCalls.emplace_back(SingleThreadCall);
+         }
+
+         for (std::thread& thr : thrCalls) thr.join();
 
-      while (!thrCalls.empty())
+         // with 1 chunk the subprocess writes (or merges in incremental mode) the outputs itself
+         if (numberOfRunChunks > 1)
+         {
+            for (unsigned int sectorBin = 0; sectorBin < numberOfSectors; sectorBin++)
+            {
+               MergeRunChunks(sectorBin);
+            }
+
+            // statistics of the fits of the chunks are summed in one file of the program
+            FitStrategyLadder tPhotonFitLadder("tcorr fits", 
+                                               inputYAMLCal["fit_strategy"]["t_photon"]);
+            for (unsigned int i = 0; i < numberOfRunChunks; i++)
+            {
+               const std::string statisticsFileName = "tmp/EMCTRunByRunOffset/" + runName + 
+                                                      "/fit_strategy_t_photon_" + 
+                                                      std::to_string(i) + ".txt";
+               tPhotonFitLadder.AddStatistics(statisticsFileName);
+               std::filesystem::remove(statisticsFileName);
+            }
+            tPhotonFitLadder.WriteStatistics(outputDir + 
+                                             "fit_strategy_t_photon_run_by_run_offset.txt");
+         }
+
+         isProcessFinished = true;
+         pBarThr.join();
+      };
+
+      // inotify instance is closed when the watch ends
+      std::unique_ptr<int, void (*)(int *)> 
+         inotifyFileDescriptor(new int(-1), [](int *fileDescriptor)
       {
-         thrCalls.back().join();
-         thrCalls.pop_back();
+         if (*fileDescriptor >= 0) close(*fileDescriptor);
+         delete fileDescriptor;
+      });
+
+      // watch is started before the first processing so that files written during it are not missed
+      if (isRunByRunWatched)
+      {
+         *inotifyFileDescriptor = inotify_init1(IN_CLOEXEC);
+         if (*inotifyFileDescriptor < 0 || 
+             inotify_add_watch(*inotifyFileDescriptor, ("data/EMCTiming/" + runName).c_str(), 
+                               IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+         {
+            CppTools::PrintError("Unable to watch directory data/EMCTiming/" + runName);
+         }
       }
 
-      isProcessFinished = true;
-      pBarThr.join();
+      ProcessNewRuns();
+
+      while (isRunByRunWatched)
+      {
+         CppTools::PrintInfo("Waiting for new runs in data/EMCTiming/" + runName);
+         WaitForNewRuns(*inotifyFileDescriptor);
+         ProcessNewRuns();
+      }
    }
    else // Mode2
    {
       programMode = 2;
+
+      // memory usage is reported to the parent process if it requested it
+      MemoryUsageReporter memoryUsageReporter;
+
       numberOfThreads = std::stoi(argv[3]);
       if (numberOfThreads <= 0) CppTools::PrintError("Number of threads must be bigger than 0");
  
       ROOT::EnableImplicitMT(numberOfThreads);
 
       if (argc > 4) showProgress = static_cast<bool>(std::stoi(argv[4]));
+      if (argc > 6)
+      {
+         runChunkIndex = std::stoi(argv[5]);
+         numberOfRunChunks = std::stoi(argv[6]);
+
+         if (numberOfRunChunks == 0 || runChunkIndex >= numberOfRunChunks)
+         {
+            CppTools::PrintError("Run chunk index must be smaller than the number of run chunks");
+         }
+      }
+
+      // subprocesses only read the catalog updated by the parent process 
+      // so that all of them split the same runs into chunks
+      ReadRunCatalog(numberOfRunChunks == 1);
+
+      // sector bin -1 stands for all sectors
+      std::vector<unsigned int> sectorBins;
+      if (std::stoi(argv[2]) >= 0) sectorBins.push_back(std::stoi(argv[2]));
+      else
+      {
+         for (unsigned int sectorBin = 0; sectorBin < 
+              inputYAMLCal["sectors_to_calibrate"].size(); sectorBin++)
+         {
+            sectorBins.push_back(sectorBin);
+         }
+      }
 
       outputDir = "output/EMCTCalibration/" + runName + "/";
       system(("mkdir -p " + outputDir + "CalibrationParameters").c_str());
-      system(("mkdir -p " + outputDir + inputYAMLCal["sectors_to_calibrate"][std::stoi(argv[2])]
-                                                    ["name"].as<std::string>()).c_str());
+      for (const unsigned int sectorBin : sectorBins)
+      {
+         system(("mkdir -p " + outputDir + inputYAMLCal["sectors_to_calibrate"][sectorBin]
+                                                       ["name"].as<std::string>()).c_str());
+      }
+
+      SelectRunsToProcess(sectorBins);
+
+      // in incremental mode new runs are always written in tmp and merged in the existing outputs
+      if (isRunByRunIncremental && numberOfRunChunks == 1)
+      {
+         for (const unsigned int sectorBin : sectorBins)
+         {
+            system(("mkdir -p tmp/EMCTRunByRunOffset/" + runName + "/" + 
+                    std::to_string(sectorBin)).c_str());
+         }
+      }
 
-      fitNTries = inputYAMLCal["number_of_fit_tries"].as<unsigned int>();
-      fitADCMin = inputYAMLCal["fit_adc_min"].as<double>();
+      runOffsetApproximator.Init(inputYAMLCal);
 
       std::thread pBarThr(PBarCall); 
 
-      numberOfIterations = runNumbers.size();
+      numberOfIterations = sectorBins.size()*
+         (runCatalog.GetFirstRunIndexOfChunk(runChunkIndex + 1, numberOfRunChunks, 
+                                             minRunEntries, runIndicesToProcess) - 
+          runCatalog.GetFirstRunIndexOfChunk(runChunkIndex, numberOfRunChunks, 
+                                             minRunEntries, runIndicesToProcess));
  
-      ProcessSector(std::stoi(argv[2]));
+      ProcessRuns(sectorBins);
+
+      if (isRunByRunIncremental && numberOfRunChunks == 1)
+      {
+         for (const unsigned int sectorBin : sectorBins) MergeRunChunks(sectorBin);
+      }
 
       isProcessFinished = true;
       pBarThr.join();
+
+      FitStrategyLadder& tPhotonFitLadder = runOffsetApproximator.GetTPhotonFitLadder();
+
+      // statistics of the chunks are written in tmp and summed by the parent process
+      if (numberOfRunChunks > 1)
+      {
+         tPhotonFitLadder.WriteStatistics("tmp/EMCTRunByRunOffset/" + runName + 
+                                          "/fit_strategy_t_photon_" + 
+                                          std::to_string(runChunkIndex) + ".txt");
+      }
+      else
+      {
+         tPhotonFitLadder.WriteStatistics(outputDir + "fit_strategy_t_photon_run_by_run_offset" + 
+                                          ((sectorBins.size() == 1) ? "_" + 
+                                           inputYAMLCal["sectors_to_calibrate"][sectorBins[0]]
+                                                       ["name"].as<std::string>() : "") + ".txt");
+      }
+      if (showProgress) tPhotonFitLadder.PrintStatistics();
    }
    return 0;
 }
 
-void EMCTiming::ProcessSector(const int sectorBin)
+void EMCTiming::ProcessRuns(const std::vector<unsigned int>& sectorBins)
 {
-   const YAML::Node sector = inputYAMLCal["sectors_to_calibrate"][sectorBin];
-   const std::string sectorName = sector["name"].as<std::string>();
+   // contiguous part of sorted runs processed by this process; 
+   // chunks are balanced by the expected cost of runs
+   const unsigned long firstRunIndex = 
+      runCatalog.GetFirstRunIndexOfChunk(runChunkIndex, numberOfRunChunks, 
+                                         minRunEntries, runIndicesToProcess);
+   const unsigned long lastRunIndex = 
+      runCatalog.GetFirstRunIndexOfChunk(runChunkIndex + 1, numberOfRunChunks, 
+                                         minRunEntries, runIndicesToProcess);
+
+   // outputs of every sector; output file is not created for the sector in which all towers were masked
+   std::vector<std::ofstream> sectorParametersOutputs(sectorBins.size());
+   std::vector<std::string> outputFileNames(sectorBins.size());
+
+   // in incremental mode outputs cannot be overwritten directly since they contain previous runs
+   const bool isChunkOutput = (numberOfRunChunks > 1 || isRunByRunIncremental);
+
+   for (unsigned long i = 0; i < sectorBins.size(); i++)
+   {
+      const YAML::Node sector = inputYAMLCal["sectors_to_calibrate"][sectorBins[i]];
+      const std::string sectorName = sector["name"].as<std::string>();
 
-   parametersOutput.open(outputDir + "CalibrationParameters/run_by_run_offset_" + 
-                         sectorName + ".txt");
+      // outputs of the chunks are written in tmp and merged by MergeRunChunks
+      const std::string chunkDir = "tmp/EMCTRunByRunOffset/" + runName + "/" + 
+                                   std::to_string(sectorBins[i]) + "/";
 
-   parametersOutput << runNumbers.size() << std::endl;
+      if (isChunkOutput)
+      {
+         sectorParametersOutputs[i].open(chunkDir + std::to_string(runChunkIndex) + ".txt");
+      }
+      else
+      {
+         sectorParametersOutputs[i].open(outputDir + "CalibrationParameters/run_by_run_offset_" + 
+                                         sectorName + ".txt");
+         sectorParametersOutputs[i] << runNumbers.size() << std::endl;
+      }
 
-   const std::string tPhotonFitFunc = 
-      inputYAMLCal["t_photon_fit_func"].as<std::string>();
-   const std::string tPhotonMeanVsADCFitFunc = 
-      inputYAMLCal["tcorr_mean_vs_adc_fit_func"].as<std::string>();
+      // run by run histograms are integrated over the towers of the sector hence tower mask 
+      // can only exclude the sector in which all towers were marked as bad by EMCTTowerMask
+      towerMask.Init(sector["number_of_y_towers"].as<int>(), 
+                     sector["number_of_z_towers"].as<int>());
+      if (towerMask.ReadFile(outputDir + "CalibrationParameters/tower_mask_" + 
+                             sectorName + ".txt") &&
+          towerMask.GetNumberOfTowers(EMCTowerMask::OK) == 0)
+      {
+         if (showProgress || runChunkIndex == 0)
+         {
+            CppTools::PrintWarning("All towers in sector " + sectorName + " are masked; skipping");
+         }
+         continue;
+      }
 
-   TFile outputFile((outputDir + sectorName + "/tcorr_fits.root").c_str(), "RECREATE");
+      outputFileNames[i] = (isChunkOutput ? chunkDir + std::to_string(runChunkIndex) + ".root" : 
+                            outputDir + sectorName + "/tcorr_fits.root");
+   }
 
-   for (const int runNumber : runNumbers)
+   // runs that were not approximated (masked sector or bad run) are written with status 0
+   auto ProcessRunResult = [&](const unsigned long sectorIndex, const int runNumber, 
+                               const TF1 *tPhotonMeanVsADCFit)
    {
       numberOfCalls++;
 
-      TFile inputFile(("data/EMCTiming/" + runName + "/se-" + 
-                       std::to_string(runNumber) + ".root").c_str());
-
-      TH2D *tVsADC = static_cast<TH2D *>(inputFile.Get(("tcorr vs ADC: " + sectorName).c_str()));
+      sectorParametersOutputs[sectorIndex] << runNumber << " ";
 
-      parametersOutput << runNumber << " ";
-
-      if (tVsADC->Integral() < 1000.) // bad run
+      if (!tPhotonMeanVsADCFit) sectorParametersOutputs[sectorIndex] << 0 << std::endl;
+      else
       {
-         parametersOutput << 0 << std::endl;
-         continue;
-      }
-
-      outputFile.mkdir(std::to_string(runNumber).c_str());
-      outputFile.cd(std::to_string(runNumber).c_str());
+         sectorParametersOutputs[sectorIndex] << 1 << " ";
 
-      TGraphErrors meansTVsADC;
-      TGraphErrors sigmasTVsADC;
+         for (int j = 0; j < tPhotonMeanVsADCFit->GetNpar() - 1; j++)
+         {
+            sectorParametersOutputs[sectorIndex] << tPhotonMeanVsADCFit->GetParameter(j) << " ";
+         }
+         sectorParametersOutputs[sectorIndex] << 
+            tPhotonMeanVsADCFit->GetParameter(tPhotonMeanVsADCFit->GetNpar() - 1) << std::endl;
+      }
 
-      for (const auto& rangeADC : sector["adc_ranges"])
+      if (!showProgress && sectorIndex == sectorBins.size() - 1)
       {
-         const double rangeADCMin = rangeADC["min"].as<double>();
-         const double rangeADCMax = rangeADC["max"].as<double>();
-
-         // used to mark the first bin in the adc range for 
-         // cases when there is not enough statistics to merge bins
-         int firstValidBinInRange = CppTools::Maximum(1, tVsADC->GetXaxis()->FindBin(rangeADCMin));
+         std::ofstream progressFile("tmp/progress/EMCTRunByRunOffset/" + runName + 
+                                    "/" + std::to_string(runChunkIndex));
+         progressFile << numberOfCalls;
+      }
+   };
 
-         for (int i = CppTools::Maximum(1, tVsADC->GetXaxis()->FindBin(rangeADCMin)); 
-              i <= CppTools::Minimum(tVsADC->GetXaxis()->FindBin(rangeADCMax), 
-                                    tVsADC->GetXaxis()->GetNbins()); i++)
-         {
-            if (tVsADC->Integral(firstValidBinInRange, i, tVsADC->GetYaxis()->FindBin(-10.), 
-                                 tVsADC->GetYaxis()->FindBin(10.)) < 1000.) continue;
+   runOffsetApproximator.ProcessRuns(runCatalog, runIndicesToProcess, firstRunIndex, lastRunIndex,
+                                     minRunEntries, sectorBins, outputFileNames, ProcessRunResult);
 
-            // ADC value of the (current bin)/(merged bins)
-            const double valADC = 
-               CppTools::Average(tVsADC->GetXaxis()->GetBinCenter(i), 
-                                 tVsADC->GetXaxis()->GetBinCenter(firstValidBinInRange));
+   for (std::ofstream& sectorParametersOutput : sectorParametersOutputs)
+   {
+      sectorParametersOutput.close();
+   }
+}
 
-            TH1D *tVsADCProj = 
-               tVsADC->ProjectionY(("tcorr " + CppTools::DtoStr(valADC, 0)).c_str(), 
-                                   firstValidBinInRange, i);
+void EMCTiming::SelectRunsToProcess(const std::vector<unsigned int>& sectorBins)
+{
+   if (!isRunByRunIncremental) return;
 
-            // if statistics is sufficient first valid bin resets 
-            // to the current bin on next iteration bin
-            firstValidBinInRange = i + 1;
+   std::vector<bool> isRunSelected(runNumbers.size(), false);
 
-            TF1 tPhotonFit(("tcorr fit " + CppTools::DtoStr(valADC, 0)).c_str(), tPhotonFitFunc.c_str());
+   for (const unsigned int sectorBin : sectorBins)
+   {
+      const std::string parametersFileName = outputDir + "CalibrationParameters/run_by_run_offset_" + 
+         inputYAMLCal["sectors_to_calibrate"][sectorBin]["name"].as<std::string>() + ".txt";
 
-            tPhotonFit.SetRange(-10., 10.);
-            tPhotonFit.SetParameters(tVsADCProj->GetMaximum(), 0, 0.5, 1., 1.);
+      // runs that are present in the parameters file
+      std::set<int> processedRuns;
+      long long parametersModificationTime = 0;
 
-            for (unsigned int j = 1; j <= fitNTries; j++)
-            {
-               if (j < fitNTries) tVsADCProj->Fit(&tPhotonFit, "RQMBN");
-               else tVsADCProj->Fit(&tPhotonFit, "RQMB");
-
-               const double parameterDeviationScale = 1. + 1./static_cast<double>(j*j);
-
-               tPhotonFit.SetRange(tPhotonFit.GetParameter(1) - 
-                                 fabs(tPhotonFit.GetParameter(2))*parameterDeviationScale,
-                                 tPhotonFit.GetParameter(1) - 
-                                 fabs(tPhotonFit.GetParameter(2))*parameterDeviationScale);
-
-               for (int k = 0; k < tPhotonFit.GetNpar(); k++)
-               {
-                  if (k == 1)
-                  {
-                     tPhotonFit.SetParLimits(k, tPhotonFit.GetParameter(1) - 
-                                           fabs(tPhotonFit.GetParameter(2))*
-                                           (parameterDeviationScale - 1.),
-                                           tPhotonFit.GetParameter(1) +
-                                           fabs(tPhotonFit.GetParameter(2))*
-                                           (parameterDeviationScale - 1.));
-                  }
-                  else
-                  {
-                     tPhotonFit.SetParLimits(k, tPhotonFit.GetParameter(k)/parameterDeviationScale,
-                                           tPhotonFit.GetParameter(k)*parameterDeviationScale);
-                  }
-               }
-            }
+      if (std::filesystem::exists(parametersFileName))
+      {
+         parametersModificationTime = EMCRunCatalog::GetModificationTime(parametersFileName);
 
-            tVsADCProj->Write();
+         std::ifstream parametersFile(parametersFileName);
+         std::string line;
 
-            // skipping outliers
-            if (fabs(tPhotonFit.GetParameter(1)) > 5. || 
-                fabs(tPhotonFit.GetParameter(2)) > 3. || 
-                fabs(tPhotonFit.GetParameter(2)) < 0.1) continue;
+         std::getline(parametersFile, line); // skipping the number of runs
+         while (std::getline(parametersFile, line))
+         {
+            int runNumber;
+            if (std::istringstream(line) >> runNumber) processedRuns.insert(runNumber);
+         }
+      }
 
-            meansTVsADC.AddPoint(valADC, tPhotonFit.GetParameter(1));
-            sigmasTVsADC.AddPoint(valADC, fabs(tPhotonFit.GetParameter(2)));
+      for (unsigned long i = 0; i < runNumbers.size(); i++)
+      {
+         if (processedRuns.find(runNumbers[i]) == processedRuns.end() || 
+             runCatalog.GetModificationTime(i) >= parametersModificationTime)
+         {
+            isRunSelected[i] = true;
          }
       }
+   }
 
-      meansTVsADC.SetMarkerStyle(20);
-      meansTVsADC.SetMarkerColor(kRed - 3);
-      meansTVsADC.SetMarkerSize(0.5);
+   runIndicesToProcess.clear();
+   for (unsigned long i = 0; i < runNumbers.size(); i++)
+   {
+      if (isRunSelected[i]) runIndicesToProcess.push_back(i);
+   }
+}
 
-      sigmasTVsADC.SetMarkerStyle(20);
-      sigmasTVsADC.SetMarkerColor(kAzure - 3);
-      sigmasTVsADC.SetMarkerSize(0.5);
+void EMCTiming::WaitForNewRuns(const int inotifyFileDescriptor)
+{
+   // buffer for inotify events aligned as required by inotify(7)
+   alignas(inotify_event) char buffer[4096];
+
+   bool isNewRun = false;
+   // the first file is waited for indefinitely; 
+   // after it the files are collected until none are written for watchDebounceTime
+   int timeout = -1;
 
-      TF1 tPhotonMeanVsADCFit("tcorr mean vs ADC fit", tPhotonMeanVsADCFitFunc.c_str(), 0., 10000);
-      tPhotonMeanVsADCFit.SetLineWidth(3);
-      tPhotonMeanVsADCFit.SetLineStyle(2);
-      tPhotonMeanVsADCFit.SetLineColor(kBlack);
+   while (true)
+   {
+      pollfd inotifyPoll{inotifyFileDescriptor, POLLIN, 0};
+      const int pollStatus = poll(&inotifyPoll, 1, timeout);
 
-      if (meansTVsADC.GetN() == 0) // bad run that passed the first bad run check
+      if (pollStatus < 0)
       {
-         parametersOutput << 0 << std::endl;
-         continue;
+         if (errno == EINTR) continue;
+         CppTools::PrintError("Unable to poll inotify events for data/EMCTiming/" + runName);
       }
-      else if (meansTVsADC.GetN() > 1) 
-      {
-         for (unsigned int i = 1; i < fitNTries; i++)
-         {
-            meansTVsADC.Fit(&tPhotonMeanVsADCFit, "RQMBN");
+      if (pollStatus == 0) return; // no files were written during watchDebounceTime
 
-            for (int j = 0; j < tPhotonMeanVsADCFit.GetNpar(); j++)
-            {
-               tPhotonMeanVsADCFit.SetParLimits(j, tPhotonMeanVsADCFit.GetParameter(j)*
-                                              (1. - 6./static_cast<double>(i*i*i)), 
-                                              tPhotonMeanVsADCFit.GetParameter(j)*
-                                              (1. + 4./static_cast<double>(i*i*i)));
-            }
-         }
-      }
-      else // root can't fit 1 point data
+      const ssize_t length = read(inotifyFileDescriptor, buffer, sizeof(buffer));
+      if (length <= 0) continue;
+
+      for (char *eventPointer = buffer; eventPointer < buffer + length; 
+           eventPointer += sizeof(inotify_event) + 
+                           reinterpret_cast<inotify_event *>(eventPointer)->len)
       {
-         tPhotonMeanVsADCFit.SetParameter(0, meansTVsADC.GetPointY(0));
-         for (int i = 1; i < tPhotonMeanVsADCFit.GetNpar(); i++)
-         {
-            tPhotonMeanVsADCFit.SetParameter(i, 0.);
-         }
+         const inotify_event *event = reinterpret_cast<inotify_event *>(eventPointer);
+
+         // some events were lost hence all files are checked by the run catalog anyway
+         if (event->mask & IN_Q_OVERFLOW) isNewRun = true;
+         if (event->len == 0) continue;
+
+         const std::string fileName = event->name;
+         if (fileName.substr(0, 3) == "se-" && 
+             std::filesystem::path(fileName).extension() == ".root") isNewRun = true;
       }
 
-      TCanvas parCanv("mean and sigma t parameters vs ADC", "", 600, 600);
+      if (isNewRun) timeout = static_cast<int>(watchDebounceTime*1000.);
+   }
+}
 
-      TH1 *frame = gPad->DrawFrame(meansTVsADC.GetPointX(0)/1.1, 
-                                   CppTools::Minimum(TMath::MinElement(meansTVsADC.GetN(), 
-                                                                       meansTVsADC.GetY()),
-                                                     TMath::MinElement(sigmasTVsADC.GetN(), 
-                                                                       sigmasTVsADC.GetY())) - 0.5,
-                                   meansTVsADC.GetPointX(meansTVsADC.GetN() - 1)*1.1,
-                                   CppTools::Maximum(TMath::MaxElement(meansTVsADC.GetN(), 
-                                                                       meansTVsADC.GetY()),
-                                                     TMath::MaxElement(sigmasTVsADC.GetN(), 
-                                                                       sigmasTVsADC.GetY())) + 0.5);
+void EMCTiming::MergeRunChunks(const int sectorBin)
+{
+   const std::string sectorName = 
+      inputYAMLCal["sectors_to_calibrate"][sectorBin]["name"].as<std::string>();
 
-      frame->GetXaxis()->SetTitle("ADC");
+   const std::string chunkDir = "tmp/EMCTRunByRunOffset/" + runName + "/" + 
+                                std::to_string(sectorBin) + "/";
 
-      tPhotonMeanVsADCFit.Draw("SAME");
-      meansTVsADC.Draw("P");
-      sigmasTVsADC.Draw("P");
+   const std::string parametersFileName = outputDir + "CalibrationParameters/run_by_run_offset_" + 
+                                          sectorName + ".txt";
+   const std::string outputFileName = outputDir + sectorName + "/tcorr_fits.root";
 
-      ROOTTools::PrintCanvas(&parCanv, "output/EMCTCalibration/" + runName + "/" + 
-                             sectorName + "/tcorr_par_vs_adc_" + std::to_string(runNumber));
+   // lines of parameters of every run; map keeps the runs sorted when new runs are inserted
+   std::map<int, std::string> runParameters;
 
-      
-      parametersOutput << 1 << " ";
+   auto ReadParameters = [&](const std::string& fileName, const bool skipFirstLine)
+   {
+      std::ifstream parametersFile(fileName);
+      std::string line;
 
-      for (int i = 0; i < tPhotonMeanVsADCFit.GetNpar() - 1; i++)
+      if (skipFirstLine) std::getline(parametersFile, line);
+      while (std::getline(parametersFile, line))
       {
-         parametersOutput << tPhotonMeanVsADCFit.GetParameter(i) << " ";
+         int runNumber;
+         if (std::istringstream(line) >> runNumber) runParameters[runNumber] = line;
       }
-      parametersOutput << 
-         tPhotonMeanVsADCFit.GetParameter(tPhotonMeanVsADCFit.GetNpar() - 1) << std::endl;
+   };
 
-      frame->GetXaxis()->SetTitle("ADC");
+   if (isRunByRunIncremental && std::filesystem::exists(parametersFileName))
+   {
+      ReadParameters(parametersFileName, true);
+   }
 
-      if (!showProgress)
-      {
-         std::ofstream progressFile("tmp/progress/EMCTRunByRunOffset/" + runName + 
-                                    "/" + std::to_string(sectorBin));
-         progressFile << numberOfCalls;
-      }
+   const bool isOutputFileUpdated = 
+      (isRunByRunIncremental && std::filesystem::exists(outputFileName));
+
+   // chunk output file does not exist if all towers of the sector were masked
+   std::vector<std::string> chunkFileNames;
+   for (unsigned int i = 0; i < numberOfRunChunks; i++)
+   {
+      const std::string chunkParametersFileName = chunkDir + std::to_string(i) + ".txt";
+
+      CppTools::CheckInputFile(chunkParametersFileName);
+      ReadParameters(chunkParametersFileName, false);
+
+      chunkFileNames.push_back(chunkDir + std::to_string(i) + ".root");
    }
 
-   outputFile.Close();
+   // parameters are written in a temporary file and renamed so that 
+   // the programs reading them (e.g. during the watch) never see a partially written file
+   parametersOutput.open(parametersFileName + ".tmp");
+
+   parametersOutput << runParameters.size() << std::endl;
+   for (const auto& [runNumber, line] : runParameters) parametersOutput << line << std::endl;
 
    parametersOutput.close();
+
+   std::filesystem::rename(parametersFileName + ".tmp", parametersFileName);
+
+   // in incremental mode the runs that were processed again replace their old results
+   std::set<int> processedRuns;
+   for (const unsigned long runIndex : runIndicesToProcess)
+   {
+      processedRuns.insert(runNumbers[runIndex]);
+   }
+
+   runOffsetApproximator.MergeChunks(outputFileName, chunkFileNames, 
+                                     isOutputFileUpdated, processedRuns);
+
+   system(("rm -rf " + chunkDir).c_str());
 }
 
 void EMCTiming::PBarCall()
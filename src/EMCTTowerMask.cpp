@@ -0,0 +1,261 @@
+/**
+ *  @file   EMCTTowerMask.cpp
+ *  @brief  Contains realisations of functions that are used for the classification of EMCal towers (ok, empty, low statistics, hot) before the timing calibration
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMCT_TOWER_MASK_CPP
+#define EMCT_TOWER_MASK_CPP
+
+#include "../include/EMCTiming.hpp"
+
+// This program does not perform any fits and only reads the histograms once
+// so unlike other EMCTiming programs it does not call itself for every sector
+int main(int argc, char **argv)
+{
+   using namespace EMCTiming;
+
+   if (argc != 2)
+   {
+      std::string errMsg = "Expected 1 parameter while " + std::to_string(argc - 1) +
+                           " parameter(s) were provided \n";
+      errMsg += "Usage: bin/EMCTTowerMask inputFile";
+      CppTools::PrintError(errMsg);
+   }
+
+   // initializing ROOT parameters
+   ROOT::EnableThreadSafety();
+   gErrorIgnoreLevel = kWarning;
+   gStyle->SetOptStat(0);
+   gStyle->SetOptFit(0);
+
+   // initializing this program parameters
+   inputYAMLCal.OpenFile(argv[1], "emc_timing");
+   inputYAMLCal.CheckStatus("emc_timing");
+
+   runName = inputYAMLCal["run_name"].as<std::string>();
+
+   // partial input files are merged in memory instead of reading the output of hadd
+   if (inputYAMLCal["input_partial_files"].as<std::string>() != "")
+   {
+      inputHistograms.AddInput(inputYAMLCal["input_partial_files"].as<std::string>());
+   }
+   else inputHistograms.AddInput("data/EMCTiming/" + runName + "/raw_sum.root");
+   inputHistograms.SetNumberOfThreads(std::thread::hardware_concurrency());
+
+   // opening input file with parameters of a run
+   inputYAMLMain.OpenFile("input/" + runName + "/main.yaml");
+   inputYAMLMain.CheckStatus("main");
+
+   if (inputYAMLCal["sectors_to_calibrate"].size() == 0)
+   {
+      CppTools::PrintInfo("No sectors were specified for calibrations");
+      CppTools::PrintInfo("Exiting the program");
+      exit(1);
+   }
+
+   TDirectory::AddDirectory(kFALSE);
+
+   programMode = 2;
+
+   // memory usage is reported to the parent process if it requested it
+   MemoryUsageReporter memoryUsageReporter;
+
+   outputDir = "output/EMCTCalibration/" + runName + "/";
+   system(("mkdir -p " + outputDir + "CalibrationParameters").c_str());
+
+   fitADCMin = inputYAMLCal["fit_adc_min"].as<double>();
+
+   numberOfIterations = 0;
+   for (unsigned int sectorBin = 0; sectorBin <
+        inputYAMLCal["sectors_to_calibrate"].size(); sectorBin++)
+   {
+      numberOfIterations +=
+         inputYAMLCal["sectors_to_calibrate"][sectorBin]["number_of_y_towers"].as<int>();
+   }
+
+   std::thread pBarThr(PBarCall);
+
+   for (unsigned int sectorBin = 0; sectorBin <
+        inputYAMLCal["sectors_to_calibrate"].size(); sectorBin++)
+   {
+      system(("mkdir -p " + outputDir + inputYAMLCal["sectors_to_calibrate"][sectorBin]
+                                                    ["name"].as<std::string>()).c_str());
+      ProcessSector(sectorBin);
+   }
+
+   isProcessFinished = true;
+   pBarThr.join();
+
+   return 0;
+}
+
+void EMCTiming::ProcessSector(const int sectorBin)
+{
+   const YAML::Node sector = inputYAMLCal["sectors_to_calibrate"][sectorBin];
+   const std::string sectorName = sector["name"].as<std::string>();
+
+   const int numberOfYTowers = sector["number_of_y_towers"].as<int>();
+   const int numberOfZTowers = sector["number_of_z_towers"].as<int>();
+
+   const double minEntries = inputYAMLCal["tower_mask"]["min_entries"].as<double>();
+   const double maxOccupancyToMedian =
+      inputYAMLCal["tower_mask"]["max_occupancy_to_median"].as<double>();
+   const double maxTRMSToMedian =
+      inputYAMLCal["tower_mask"]["max_t_rms_to_median"].as<double>();
+
+   // number of entries, mean, and RMS of traw above fit_adc_min for every tower
+   std::vector<double> towerEntries(numberOfYTowers*numberOfZTowers, 0.);
+   std::vector<double> towerMeanT(numberOfYTowers*numberOfZTowers, 0.);
+   std::vector<double> towerRMST(numberOfYTowers*numberOfZTowers, 0.);
+
+   for (int i = 0; i < numberOfYTowers; i++)
+   {
+      numberOfCalls++;
+
+      const std::string distrName =
+         "traw vs ADC vs iz: " + sectorName + ", iy" + std::to_string(i);
+
+      // histogram of the y tower is merged on demand and released after all its z towers
+      // are classified so that only one y tower of the sector is kept in memory at a time
+      TH3D *distrTVsADCVsZTower = static_cast<TH3D *>(inputHistograms.Get(distrName));
+
+      if (!distrTVsADCVsZTower)
+      {
+         CppTools::PrintError("Histogram traw vs ADC vs iz: " + sectorName + ", iy" +
+                              std::to_string(i) + " does not exist in " +
+                              inputHistograms.GetName());
+      }
+
+      if (distrTVsADCVsZTower->GetZaxis()->GetNbins() != numberOfZTowers)
+      {
+         std::string errMsg = "Mismatching number of z towers from input file";
+         errMsg += "and histogram for sector " + sectorName;
+         CppTools::PrintError(errMsg);
+      }
+
+      const int firstADCBin = distrTVsADCVsZTower->GetYaxis()->FindBin(fitADCMin);
+
+      // single pass over all bins of the histogram; x is traw, y is ADC, z is iz
+      for (int j = 0; j < numberOfZTowers; j++)
+      {
+         double sumW = 0., sumWT = 0., sumWT2 = 0.;
+
+         for (int k = firstADCBin; k <= distrTVsADCVsZTower->GetYaxis()->GetNbins(); k++)
+         {
+            for (int l = 1; l <= distrTVsADCVsZTower->GetXaxis()->GetNbins(); l++)
+            {
+               const double w = distrTVsADCVsZTower->GetBinContent(l, k, j + 1);
+               if (w < 1e-15) continue;
+
+               const double t = distrTVsADCVsZTower->GetXaxis()->GetBinCenter(l);
+
+               sumW += w;
+               sumWT += w*t;
+               sumWT2 += w*t*t;
+            }
+         }
+
+         const int towerIndex = i*numberOfZTowers + j;
+
+         towerEntries[towerIndex] = sumW;
+
+         if (sumW < 1e-15) continue;
+
+         towerMeanT[towerIndex] = sumWT/sumW;
+         towerRMST[towerIndex] =
+            sqrt(CppTools::Maximum(sumWT2/sumW - towerMeanT[towerIndex]*towerMeanT[towerIndex], 0.));
+      }
+
+      inputHistograms.Release(distrName);
+   }
+
+   // medians are taken only from towers with sufficient statistics
+   // so that empty or barely filled towers do not bias the reference values
+   std::vector<double> entriesForMedian, rmsForMedian;
+   for (unsigned long i = 0; i < towerEntries.size(); i++)
+   {
+      if (towerEntries[i] < minEntries) continue;
+      entriesForMedian.push_back(towerEntries[i]);
+      rmsForMedian.push_back(towerRMST[i]);
+   }
+
+   double medianEntries = 0., medianRMST = 0.;
+   if (!entriesForMedian.empty())
+   {
+      std::nth_element(entriesForMedian.begin(),
+                       entriesForMedian.begin() + entriesForMedian.size()/2,
+                       entriesForMedian.end());
+      std::nth_element(rmsForMedian.begin(),
+                       rmsForMedian.begin() + rmsForMedian.size()/2,
+                       rmsForMedian.end());
+      medianEntries = entriesForMedian[entriesForMedian.size()/2];
+      medianRMST = rmsForMedian[rmsForMedian.size()/2];
+   }
+
+   towerMask.Init(numberOfYTowers, numberOfZTowers);
+
+   TH2D distrTowerStatus(("tower status " + sectorName).c_str(), "",
+                         numberOfZTowers, 0., static_cast<double>(numberOfZTowers),
+                         numberOfYTowers, 0., static_cast<double>(numberOfYTowers));
+
+   for (int i = 0; i < numberOfYTowers; i++)
+   {
+      for (int j = 0; j < numberOfZTowers; j++)
+      {
+         const int towerIndex = i*numberOfZTowers + j;
+
+         if (towerEntries[towerIndex] < 1e-15) towerMask.SetStatus(i, j, EMCTowerMask::EMPTY);
+         else if (towerEntries[towerIndex] < minEntries)
+         {
+            towerMask.SetStatus(i, j, EMCTowerMask::LOW_STAT);
+         }
+         else if (towerEntries[towerIndex] > medianEntries*maxOccupancyToMedian ||
+                  towerRMST[towerIndex] > medianRMST*maxTRMSToMedian)
+         {
+            towerMask.SetStatus(i, j, EMCTowerMask::HOT);
+         }
+
+         distrTowerStatus.SetBinContent(j + 1, i + 1, towerMask.GetStatus(i, j));
+      }
+   }
+
+   towerMask.WriteFile(outputDir + "CalibrationParameters/tower_mask_" + sectorName + ".txt");
+
+   TCanvas towerStatusCanv("tower status", "", 1000, 500);
+
+   gPad->SetRightMargin(0.13);
+   distrTowerStatus.GetXaxis()->SetTitle("iz");
+   distrTowerStatus.GetYaxis()->SetTitle("iy");
+   distrTowerStatus.SetMinimum(0.);
+   distrTowerStatus.SetMaximum(3.);
+   distrTowerStatus.Draw("COLZ");
+
+   ROOTTools::PrintCanvas(&towerStatusCanv, outputDir + sectorName + "/tower_mask");
+
+   CppTools::PrintInfo(sectorName + ": " +
+                       std::to_string(towerMask.GetNumberOfTowers(EMCTowerMask::OK)) +
+                       " ok, " +
+                       std::to_string(towerMask.GetNumberOfTowers(EMCTowerMask::EMPTY)) +
+                       " empty, " +
+                       std::to_string(towerMask.GetNumberOfTowers(EMCTowerMask::LOW_STAT)) +
+                       " low statistics, " +
+                       std::to_string(towerMask.GetNumberOfTowers(EMCTowerMask::HOT)) +
+                       " hot towers");
+}
+
+void EMCTiming::PBarCall()
+{
+   if (!showProgress) return;
+   while (!isProcessFinished)
+   {
+      pBar.Print(static_cast<double>(numberOfCalls)/
+                 static_cast<double>(numberOfIterations));
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+   }
+   pBar.Print(1.);
+};
+
+#endif /* EMCT_TOWER_MASK_CPP */
@@ -44,7 +44,27 @@ int main(int argc, char **argv)
 
    runName = inputYAMLCal["run_name"].as<std::string>();
 
-   CppTools::CheckInputFile("data/EMCTiming/" + runName + "/raw_sum.root");
+   isIncremental = inputYAMLCal["incremental"]["enable"].as<bool>();
+
+   // there is no default for the files that contain traw vs ADC vs iz histograms
+   // since the names of the outputs of the taxi differ between the productions
+   if (isIncremental && inputYAMLCal["incremental"]["input_file_prefixes"].size() == 0)
+   {
+      CppTools::PrintError("Incremental mode is enabled but incremental: input_file_prefixes "
+                           "is empty; list the prefixes of the files in data/EMCTiming/" + 
+                           runName + "/ that contain traw vs ADC vs iz histograms");
+   }
+
+   // in incremental mode partial input files are added to the moments instead
+   if (!isIncremental)
+   {
+      // partial input files are merged in memory instead of reading the output of hadd
+      if (inputYAMLCal["input_partial_files"].as<std::string>() != "")
+      {
+         inputHistograms.AddInput(inputYAMLCal["input_partial_files"].as<std::string>());
+      }
+      else inputHistograms.AddInput("data/EMCTiming/" + runName + "/raw_sum.root");
+   }
 
    // opening input file with parameters of a run
    inputYAMLMain.OpenFile("input/" + runName + "/main.yaml");
@@ -59,7 +79,7 @@ int main(int argc, char **argv)
 
    TDirectory::AddDirectory(kFALSE);
 
-   if (argc < 3) // Mode1
+   if (argc < 4) // Mode1
    {
       programMode = 1;
       if (argc > 2) numberOfThreads = std::stoi(argv[2]);
@@ -78,32 +98,47 @@ int main(int argc, char **argv)
             inputYAMLCal["sectors_to_calibrate"][sectorBin]["number_of_z_towers"].as<int>();
       }
 
-      int subprocessNumberOfThreads = numberOfThreads/inputYAMLCal["sectors_to_calibrate"].size();
-      if (subprocessNumberOfThreads < 1) subprocessNumberOfThreads = 1;
+      // threads of all subprocesses are taken from the same pool
+      ThreadTokenPool threadTokenPool(numberOfThreads);
+      // subprocesses are started only while their memory fits in the budget
+      MemoryBudget memoryBudget(inputYAMLCal["memory_budget"].as<double>());
+
+      // number of sectors for which the subprocesses were not started yet
+      std::atomic<unsigned int> numberOfUnstartedSectors{
+         static_cast<unsigned int>(inputYAMLCal["sectors_to_calibrate"].size())};
 
       auto SingleThreadCall = [&](const unsigned long sectorBin)
       {
+         // subprocess waits for the memory before taking the threads so that the threads 
+         // are not held by the subprocesses that can not be started yet
+         const unsigned long memoryBudgetIndex = memoryBudget.Admit("EMCTTowerOffset");
+
+         threadTokenPool.Acquire();
+
+         // free threads are split between the sectors that are not started yet so that 
+         // the threads returned by the finished sectors are given to the remaining ones
+         const unsigned int numberOfRemainingSectors = numberOfUnstartedSectors--;
+         const unsigned int subprocessNumberOfThreads = 1 + 
+            threadTokenPool.TryAcquire((numberOfThreads + numberOfRemainingSectors - 1)/
+                                       numberOfRemainingSectors - 1);
+
          // man ROOT sucks (TF1::Fit is still not thread safe) so I have to call the same program 
          // recursively in shell outside of the current instance to implement multithreading
-         system((static_cast<std::string>("./bin/EMCTTowerOffset ") + 
+         system((memoryBudget.GetEnvironment(memoryBudgetIndex) + "./bin/EMCTTowerOffset " + 
                  argv[1] + " " + std::to_string(sectorBin) + " " + 
                  std::to_string(subprocessNumberOfThreads) + " 0").c_str());;
+
+         memoryBudget.Release(memoryBudgetIndex);
+         threadTokenPool.Release(subprocessNumberOfThreads);
       };
 
       std::vector<std::thread> thrCalls;
       std::thread pBarThr(PBarCall); 
 
+      // subprocesses wait for the threads in the pool instead of being started in batches
       for (unsigned int sectorBin = 0; sectorBin < 
            inputYAMLCal["sectors_to_calibrate"].size(); sectorBin++)
       {
-            if (thrCalls.size() >= numberOfThreads)
-            {
-               while (!thrCalls.empty())
-               {
-                  thrCalls.back().join();
-                  thrCalls.pop_back();
-               }
-            }
             thrCalls.emplace_back(SingleThreadCall, sectorBin);
       }
 
@@ -119,10 +154,15 @@ int main(int argc, char **argv)
    else // Mode2
    {
       programMode = 2;
+
+      // memory usage is reported to the parent process if it requested it
+      MemoryUsageReporter memoryUsageReporter;
+
       numberOfThreads = std::stoi(argv[3]);
       if (numberOfThreads <= 0) CppTools::PrintError("Number of threads must be bigger than 0");
  
       ROOT::EnableImplicitMT(numberOfThreads);
+      inputHistograms.SetNumberOfThreads(numberOfThreads);
 
       if (argc > 4) showProgress = static_cast<bool>(std::stoi(argv[4]));
 
@@ -134,16 +174,32 @@ int main(int argc, char **argv)
       fitNTries = inputYAMLCal["number_of_fit_tries"].as<unsigned int>();
       fitADCMin = inputYAMLCal["fit_adc_min"].as<double>();
 
+      isWarmStart = (inputYAMLCal["warm_start"]["parameters_dir"].as<std::string>() != "");
+      warmStartParameterDeviation = inputYAMLCal["warm_start"]["parameter_deviation"].as<double>();
+      warmStartFitNTries = inputYAMLCal["warm_start"]["number_of_fit_tries"].as<unsigned int>();
+      refitMinRelativeChange = 
+         inputYAMLCal["incremental"]["refit_min_relative_change"].as<double>();
+
+      towerFitLadder = FitStrategyLadder("t vs ADC fits", 
+                                         inputYAMLCal["fit_strategy"]["t_vs_adc"]);
+
       std::thread pBarThr(PBarCall); 
 
       numberOfIterations = 
          inputYAMLCal["sectors_to_calibrate"][std::stoi(argv[2])]["number_of_y_towers"].as<int>()*
          inputYAMLCal["sectors_to_calibrate"][std::stoi(argv[2])]["number_of_z_towers"].as<int>();
  
-      ProcessSector(std::stoi(argv[2]));
+      if (isIncremental) UpdateSectorIncrementally(std::stoi(argv[2]));
+      else ProcessSector(std::stoi(argv[2]));
 
       isProcessFinished = true;
       pBarThr.join();
+
+      towerFitLadder.WriteStatistics(outputDir + inputYAMLCal["sectors_to_calibrate"]
+                                                             [std::stoi(argv[2])]["name"].
+                                                             as<std::string>() + 
+                                     "/fit_strategy_t_vs_adc.txt");
+      if (showProgress) towerFitLadder.PrintStatistics();
    }
    return 0;
 }
@@ -156,7 +212,7 @@ void EMCTiming::ProcessSector(const int sectorBin)
    const int numberOfYTowers = sector["number_of_y_towers"].as<int>();
    const int numberOfZTowers = sector["number_of_z_towers"].as<int>();
 
-   TFile inputFile(("data/EMCTiming/" + runName + "/raw_sum.root").c_str());
+   ReadTowerMaskAndWarmStart(sectorName, numberOfYTowers, numberOfZTowers);
 
    parametersOutput.open(outputDir + "CalibrationParameters/tower_offset_" + sectorName + ".txt");
 
@@ -164,8 +220,19 @@ void EMCTiming::ProcessSector(const int sectorBin)
 
    for (int i = 0; i < numberOfYTowers; i++)
    {
-      TH3D *distrTVsADCVsZTower = static_cast<TH3D *>
-         (inputFile.Get(("traw vs ADC vs iz: " + sectorName + ", iy" + std::to_string(i)).c_str()));
+      const std::string distrName = 
+         "traw vs ADC vs iz: " + sectorName + ", iy" + std::to_string(i);
+
+      // histogram of the y tower is merged on demand and released after all its z towers 
+      // are fitted so that only one y tower of the sector is kept in memory at a time
+      TH3D *distrTVsADCVsZTower = static_cast<TH3D *>(inputHistograms.Get(distrName));
+
+      if (!distrTVsADCVsZTower)
+      {
+         CppTools::PrintError("Histogram traw vs ADC vs iz: " + sectorName + ", iy" + 
+                              std::to_string(i) + " does not exist in " + 
+                              inputHistograms.GetName());
+      }
 
       if (distrTVsADCVsZTower->GetZaxis()->GetNbins() != numberOfZTowers)
       {
@@ -178,12 +245,25 @@ void EMCTiming::ProcessSector(const int sectorBin)
       {
          numberOfCalls++;
 
-         TF1 fitFunc("t vs ADC fit", inputYAMLCal["traw_vs_adc_fit_func"].as<std::string>().c_str());
+         if (!towerMask.IsGood(i, j))
+         {
+            parametersOutput << 0 << std::endl;
+            continue;
+         }
 
-         distrTVsADCVsZTower->GetZaxis()->SetRange(j + 1, j + 1); // j + 1 to get the bin
+         // projections and functions of the previous tower are no longer needed
+         histogramArena.Recycle();
+         fitFunctionPool.Recycle();
 
-         if (PerformFitsForSingleTower(static_cast<TH2D *>(distrTVsADCVsZTower->Project3D("xy")), 
-                                       fitFunc, sectorName, i, j))
+         TF1& fitFunc = *fitFunctionPool.
+            Get("t vs ADC fit", inputYAMLCal["traw_vs_adc_fit_func"].as<std::string>());
+
+         // j + 1 to get the bin
+         TH2D *distrTVsADC = histogramArena.
+            ProjectionXY(distrTVsADCVsZTower, (std::string) distrTVsADCVsZTower->GetName() + 
+                         "_xy", j + 1, j + 1);
+
+         if (PerformFitsForSingleTower(distrTVsADC, fitFunc, sectorName, i, j))
          {
             parametersOutput << 1 << " ";
             for (int k = 0; k < fitFunc.GetNpar() - 1; k++)
@@ -205,11 +285,220 @@ void EMCTiming::ProcessSector(const int sectorBin)
             progressFile << numberOfCalls;
          }
       }
+
+      inputHistograms.Release(distrName);
    }
 
    parametersOutput.close();
 }
 
+void EMCTiming::ReadTowerMaskAndWarmStart(const std::string& sectorName, 
+                                          const int numberOfYTowers, const int numberOfZTowers)
+{
+   // towers marked as bad by EMCTTowerMask are skipped before the projection
+   towerMask.Init(numberOfYTowers, numberOfZTowers);
+   if (!towerMask.ReadFile(outputDir + "CalibrationParameters/tower_mask_" + sectorName + ".txt") &&
+       showProgress)
+   {
+      CppTools::PrintInfo("Tower mask for sector " + sectorName + " was not found; " +
+                          "all towers will be fitted");
+   }
+
+   // parameters from the previous calibration must be read before the output is opened
+   // since the previous calibration can be located in the same directory
+   if (isWarmStart)
+   {
+      const std::string warmStartFileName = 
+         inputYAMLCal["warm_start"]["parameters_dir"].as<std::string>() + 
+         "/tower_offset_" + sectorName + ".txt";
+
+      CppTools::CheckInputFile(warmStartFileName);
+      warmStartTowerOffset.ReadFile(warmStartFileName);
+
+      if (warmStartTowerOffset.GetNumberOfYTowers() != numberOfYTowers ||
+          warmStartTowerOffset.GetNumberOfZTowers() != numberOfZTowers)
+      {
+         CppTools::PrintError("Mismatching number of towers in file " + warmStartFileName + 
+                              " and input file for sector " + sectorName);
+      }
+   }
+}
+
+void EMCTiming::UpdateSectorIncrementally(const int sectorBin)
+{
+   const YAML::Node sector = inputYAMLCal["sectors_to_calibrate"][sectorBin];
+   const std::string sectorName = sector["name"].as<std::string>();
+
+   const int numberOfYTowers = sector["number_of_y_towers"].as<int>();
+   const int numberOfZTowers = sector["number_of_z_towers"].as<int>();
+
+   const std::string momentsFileName = 
+      outputDir + "TowerMoments/tower_moments_" + sectorName + ".root";
+   const std::string parametersFileName = 
+      outputDir + "CalibrationParameters/tower_offset_" + sectorName + ".txt";
+
+   EMCTowerMoments towerMoments;
+   towerMoments.ReadFile(momentsFileName);
+
+   // parameters from the previous update; towers without significant changes keep them
+   EMCTowerOffsetTable previousTowerOffset;
+   const bool isPreviousTowerOffsetRead = 
+      previousTowerOffset.ReadFile(parametersFileName) && 
+      previousTowerOffset.GetNumberOfYTowers() == numberOfYTowers &&
+      previousTowerOffset.GetNumberOfZTowers() == numberOfZTowers;
+
+   ReadTowerMaskAndWarmStart(sectorName, numberOfYTowers, numberOfZTowers);
+
+   // refitted towers are seeded with the parameters from the previous 
+   // update unless other parameters were specified for warm start
+   if (!isWarmStart && isPreviousTowerOffsetRead)
+   {
+      warmStartTowerOffset = previousTowerOffset;
+      isWarmStart = true;
+   }
+
+   const std::string inputDir = "data/EMCTiming/" + runName + "/";
+
+   // set is used to add files in the same order on every call
+   std::set<std::string> newInputFileNames;
+
+   for (const auto &file : std::filesystem::directory_iterator(inputDir))
+   {
+      const std::string fileName = file.path().filename().string();
+
+      if (file.path().extension() != ".root" || towerMoments.IsFileAdded(fileName)) continue;
+
+      for (const auto& prefix : inputYAMLCal["incremental"]["input_file_prefixes"])
+      {
+         if (fileName.substr(0, prefix.as<std::string>().size()) == prefix.as<std::string>())
+         {
+            newInputFileNames.insert(fileName);
+            break;
+         }
+      }
+   }
+
+   for (const std::string& fileName : newInputFileNames)
+   {
+      TFile inputFile((inputDir + fileName).c_str());
+
+      for (int i = 0; i < numberOfYTowers; i++)
+      {
+         const std::string distrName = 
+            "traw vs ADC vs iz: " + sectorName + ", iy" + std::to_string(i);
+
+         TH3D *distrTVsADCVsZTower = static_cast<TH3D *>(inputFile.Get(distrName.c_str()));
+
+         if (!distrTVsADCVsZTower)
+         {
+            CppTools::PrintError("Histogram " + distrName + " does not exist in file " + 
+                                 inputDir + fileName + "; check incremental: " + 
+                                 "input_file_prefixes");
+         }
+
+         towerMoments.Add(distrTVsADCVsZTower, i, numberOfYTowers);
+      }
+
+      towerMoments.SetFileAdded(fileName);
+   }
+
+   if (towerMoments.IsEmpty())
+   {
+      CppTools::PrintError("No input files were found in " + inputDir + 
+                           " for incremental update of sector " + sectorName);
+   }
+
+   const TAxis *adcAxis = towerMoments.GetADCAxis();
+   const int firstADCBin = adcAxis->FindBin(fitADCMin);
+
+   parametersOutput.open(parametersFileName);
+
+   parametersOutput << numberOfYTowers << " " << numberOfZTowers << std::endl;
+
+   unsigned long numberOfRefittedTowers = 0;
+
+   for (int i = 0; i < numberOfYTowers; i++)
+   {
+      for (int j = 0; j < numberOfZTowers; j++)
+      {
+         numberOfCalls++;
+
+         if (!showProgress)
+         {
+            std::ofstream progressFile("tmp/progress/EMCTTowerOffset/" + runName + 
+                                       "/" + std::to_string(sectorBin));
+            progressFile << numberOfCalls;
+         }
+
+         const double entries = towerMoments.GetEntries(i, j, firstADCBin);
+
+         if (!towerMask.IsGood(i, j) || entries < 1e-15)
+         {
+            parametersOutput << 0 << std::endl;
+            continue;
+         }
+
+         const double entriesAtLastFit = towerMoments.GetEntriesAtLastFit(i, j);
+
+         if (isPreviousTowerOffsetRead && previousTowerOffset.IsCalibrated(i, j) && 
+             entriesAtLastFit > 0. && 
+             fabs(entries - entriesAtLastFit) < entriesAtLastFit*refitMinRelativeChange)
+         {
+            const double *previousParameters = previousTowerOffset.GetParameters(i, j);
+
+            parametersOutput << 1;
+            for (int k = 0; k < previousTowerOffset.GetNumberOfParameters(); k++)
+            {
+               parametersOutput << " " << previousParameters[k];
+            }
+            parametersOutput << std::endl;
+            continue;
+         }
+
+         // function of the previous tower is no longer needed
+         fitFunctionPool.Recycle();
+
+         TF1& fitFunc = *fitFunctionPool.
+            Get("t vs ADC fit", inputYAMLCal["traw_vs_adc_fit_func"].as<std::string>());
+
+         TH1D meanDistr(("mean distribution of iy" + std::to_string(i) + 
+                         " iz" + std::to_string(j)).c_str(), 
+                        ("iy" + std::to_string(i) + " iz" + std::to_string(j)).c_str(), 
+                        adcAxis->GetNbins(), adcAxis->GetBinLowEdge(1),
+                        adcAxis->GetBinUpEdge(adcAxis->GetNbins()));
+
+         double minT, maxT;
+         towerMoments.FillMeanDistr(i, j, firstADCBin, meanDistr, minT, maxT);
+
+         PerformFitsForMeanDistr(meanDistr, fitFunc, minT, maxT, i, j);
+         DrawTowerFit(nullptr, meanDistr, fitFunc, sectorName, i, j);
+
+         towerMoments.SetEntriesAtLastFit(i, j, entries);
+         numberOfRefittedTowers++;
+
+         parametersOutput << 1 << " ";
+         for (int k = 0; k < fitFunc.GetNpar() - 1; k++)
+         {
+            parametersOutput << fitFunc.GetParameter(k) << " ";
+         }
+         parametersOutput << fitFunc.GetParameter(fitFunc.GetNpar() - 1);
+         parametersOutput << std::endl;
+      }
+   }
+
+   parametersOutput.close();
+
+   system(("mkdir -p " + outputDir + "TowerMoments").c_str());
+   towerMoments.WriteFile(momentsFileName);
+
+   if (showProgress)
+   {
+      CppTools::PrintInfo(sectorName + ": " + std::to_string(newInputFileNames.size()) + 
+                          " new input files were added; " + 
+                          std::to_string(numberOfRefittedTowers) + " towers were refitted");
+   }
+}
+
 bool EMCTiming::PerformFitsForSingleTower(TH2D *distr, TF1& fitFunc, const std::string& sectorName,
                                           const int yTowerIndex, const int zTowerIndex)
 {
@@ -229,10 +518,14 @@ bool EMCTiming::PerformFitsForSingleTower(TH2D *distr, TF1& fitFunc, const std::
 
    for (int i = distr->GetXaxis()->FindBin(fitADCMin); i <= distr->GetXaxis()->GetNbins(); i++)
    {
-      TH1D *distrProj = distr->
-         ProjectionY(((std::string) distr->GetName() + "_px_" + std::to_string(i)).c_str(), i, i);
+      TH1D *distrProj = histogramArena.
+         ProjectionY(distr, (std::string) distr->GetName() + "_px_" + std::to_string(i), i, i);
 
-      if (distrProj->Integral(1, distrProj->GetXaxis()->GetNbins()) < 1e-15) continue;
+      if (distrProj->Integral(1, distrProj->GetXaxis()->GetNbins()) < 1e-15)
+      {
+         histogramArena.Release(distrProj);
+         continue;
+      }
 
       meanDistr.SetBinContent(i, distrProj->GetMean());
       meanDistr.SetBinError(i, distrProj->GetMeanError());
@@ -252,8 +545,24 @@ bool EMCTiming::PerformFitsForSingleTower(TH2D *distr, TF1& fitFunc, const std::
          if (maxT > distrProj->GetXaxis()->GetBinUpEdge(j)) break;
          else maxT = distrProj->GetXaxis()->GetBinUpEdge(j);
       }
+
+      // projection of every ADC bin is filled in the same buffer
+      histogramArena.Release(distrProj);
    }
 
+   PerformFitsForMeanDistr(meanDistr, fitFunc, minT, maxT, yTowerIndex, zTowerIndex);
+
+   distr->GetYaxis()->SetRange(distr->GetYaxis()->FindBin(minT - 5.), 
+                               distr->GetYaxis()->FindBin(maxT + 5.));
+
+   DrawTowerFit(distr, meanDistr, fitFunc, sectorName, yTowerIndex, zTowerIndex);
+   return true;
+}
+
+void EMCTiming::PerformFitsForMeanDistr(TH1D& meanDistr, TF1& fitFunc, 
+                                        const double minT, const double maxT,
+                                        const int yTowerIndex, const int zTowerIndex)
+{
    fitFunc.SetRange(meanDistr.GetXaxis()->GetBinLowEdge(1), 
                     meanDistr.GetXaxis()->GetBinUpEdge(meanDistr.GetXaxis()->GetNbins()));
 
@@ -267,21 +576,116 @@ bool EMCTiming::PerformFitsForSingleTower(TH2D *distr, TF1& fitFunc, const std::
    }
    else
    {
-      fitFunc.SetParameters(minT, 50, -1.);
-
-      distr->GetYaxis()->SetRange(distr->GetYaxis()->FindBin(minT - 5.), 
-                                  distr->GetYaxis()->FindBin(maxT + 5.));
+      if (isWarmStart && warmStartTowerOffset.IsCalibrated(yTowerIndex, zTowerIndex) &&
+          PerformWarmStartFit(meanDistr, fitFunc, yTowerIndex, zTowerIndex)) return;
 
-      for (unsigned int i = 1; i <= fitNTries; i++)
+      auto FitMeanDistr = [&](const FitStrategyLadder::Tier& tier, const unsigned int tryIndex)
       {
-         meanDistr.Fit(&fitFunc, "RQMBN");
+         // every tier starts from the default seeds
+         if (tryIndex == 0)
+         {
+            for (int i = 0; i < fitFunc.GetNpar(); i++) fitFunc.ReleaseParameter(i);
+            fitFunc.SetParameters(minT, 50, -1.);
+         }
+
+         const int fitStatus = meanDistr.Fit(&fitFunc, tier.options.c_str());
+
+         const double parameterDeviationScale = 
+            1. + 2./static_cast<double>((tryIndex + 1)*(tryIndex + 1));
 
-         for (int j = 0; j < fitFunc.GetNpar(); j++)
+         for (int i = 0; i < fitFunc.GetNpar(); i++)
          {
-            fitFunc.SetParLimits(j, fitFunc.GetParameter(j)/(1. + 2./static_cast<double>(i*i)), 
-                                 fitFunc.GetParameter(j)*(1. + 2./static_cast<double>(i*i)));
+            fitFunc.SetParLimits(i, fitFunc.GetParameter(i)/parameterDeviationScale, 
+                                 fitFunc.GetParameter(i)*parameterDeviationScale);
          }
-      }
+
+         return fitStatus;
+      };
+
+      auto IsFitAccepted = [&]()
+      {
+         return towerFitLadder.IsFitGood(fitFunc);
+      };
+
+      // cheaper tiers are escalated to more expensive ones only if their results are rejected
+      towerFitLadder.Run(nullptr, FitMeanDistr, IsFitAccepted);
+   }
+}
+
+bool EMCTiming::PerformWarmStartFit(TH1D& meanDistr, TF1& fitFunc, 
+                                    const int yTowerIndex, const int zTowerIndex)
+{
+   if (warmStartTowerOffset.GetNumberOfParameters() != fitFunc.GetNpar())
+   {
+      CppTools::PrintError("Number of parameters in warm start file does not match "
+                           "the number of parameters of traw_vs_adc_fit_func");
+   }
+
+   const double *seedParameters = warmStartTowerOffset.GetParameters(yTowerIndex, zTowerIndex);
+
+   fitFunc.SetParameters(seedParameters);
+
+   // limits are set around the seed with the half width proportional to the absolute value of 
+   // the seed; parameters close to 0 (e.g. offsets centered at 0) would get collapsed limits
+   // hence their half width is taken proportional to the spread of the parameter over the sector
+   for (int i = 0; i < fitFunc.GetNpar(); i++)
+   {
+      const double halfWidth = warmStartParameterDeviation*
+         CppTools::Maximum(fabs(seedParameters[i]), warmStartTowerOffset.GetParameterRMS(i));
+
+      // ROOT treats equal limits as no limits or as a fixed parameter; 
+      // parameter without any scale is left free instead
+      if (halfWidth < 1e-15) fitFunc.ReleaseParameter(i);
+      else fitFunc.SetParLimits(i, seedParameters[i] - halfWidth, seedParameters[i] + halfWidth);
+   }
+
+   int fitStatus = 0;
+   for (unsigned int i = 0; i < warmStartFitNTries; i++)
+   {
+      fitStatus = meanDistr.Fit(&fitFunc, "RQMBN");
+   }
+
+   bool isFitGood = (fitStatus == 0);
+
+   // parameter that ended up on the limit means that the tower has changed
+   // considerably since the previous calibration and seeds are not reliable
+   for (int i = 0; i < fitFunc.GetNpar() && isFitGood; i++)
+   {
+      double parMin, parMax;
+      fitFunc.GetParLimits(i, parMin, parMax);
+
+      if (parMin >= parMax) continue;
+
+      const double tolerance = (parMax - parMin)*1e-3;
+
+      if (fitFunc.GetParameter(i) - parMin < tolerance || 
+          parMax - fitFunc.GetParameter(i) < tolerance) isFitGood = false;
+   }
+
+   if (!isFitGood)
+   {
+      for (int i = 0; i < fitFunc.GetNpar(); i++) fitFunc.ReleaseParameter(i);
+   }
+
+   return isFitGood;
+}
+
+void EMCTiming::DrawTowerFit(TH2D *distr, TH1D& meanDistr, TF1& fitFunc, 
+                             const std::string& sectorName, 
+                             const int yTowerIndex, const int zTowerIndex)
+{
+   // in incremental mode only the moments are available hence only means are drawn
+   if (!distr)
+   {
+      TCanvas meanCanv("mean distr", "",  500, 500);
+
+      meanDistr.DrawClone();
+      fitFunc.DrawClone("SAME");
+
+      ROOTTools::PrintCanvas(&meanCanv, outputDir + sectorName + "/mean_iy" + 
+                                        std::to_string(yTowerIndex) + "_iz" + 
+                                        std::to_string(zTowerIndex));
+      return;
    }
 
    TCanvas meanCanv("mean distr", "",  1000, 500);
@@ -297,7 +701,6 @@ bool EMCTiming::PerformFitsForSingleTower(TH2D *distr, TF1& fitFunc, const std::
    ROOTTools::PrintCanvas(&meanCanv, outputDir + sectorName + "/mean_iy" + 
                                      std::to_string(yTowerIndex) + "_iz" + 
                                      std::to_string(zTowerIndex));
-   return true;
 }
 
 void EMCTiming::PBarCall()
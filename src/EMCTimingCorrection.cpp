@@ -0,0 +1,231 @@
+/**
+ *  @file   EMCTimingCorrection.cpp
+ *  @brief  Contains realisation of class EMCTimingCorrection
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_TIMING_CORRECTION_CPP
+#define EMC_TIMING_CORRECTION_CPP
+
+#include "../include/EMCTimingCorrection.hpp"
+
+EMCTimingCorrection::EMCTimingCorrection() {};
+
+EMCTimingCorrection::EMCTimingCorrection(const std::string& towerOffsetFunc,
+                                         const std::string& runOffsetFunc,
+                                         const double adcMin, const double adcMax,
+                                         const unsigned int numberOfADCBins)
+{
+   if (adcMax <= adcMin)
+   {
+      CppTools::PrintError("EMCTimingCorrection: Upper edge of ADC grid must be bigger than the lower one");
+   }
+   if (numberOfADCBins == 0)
+   {
+      CppTools::PrintError("EMCTimingCorrection: Number of ADC bins must be bigger than 0");
+   }
+
+   this->towerOffsetFunc = towerOffsetFunc;
+   this->runOffsetFunc = runOffsetFunc;
+   this->adcMin = adcMin;
+   this->adcMax = adcMax;
+   this->numberOfADCBins = numberOfADCBins;
+
+   inverseADCBinWidth = static_cast<double>(numberOfADCBins)/(adcMax - adcMin);
+}
+
+unsigned int EMCTimingCorrection::AddSector(const std::string& towerOffsetFileName,
+                                            const std::string& runByRunOffsetFileName)
+{
+   Sector sector;
+
+   const unsigned long tableSize = numberOfADCBins + 1;
+
+   // tower parameters
+   EMCTowerOffsetTable towerOffsetTable(towerOffsetFileName);
+
+   sector.numberOfYTowers = towerOffsetTable.GetNumberOfYTowers();
+   sector.numberOfZTowers = towerOffsetTable.GetNumberOfZTowers();
+
+   const unsigned long numberOfTowers = sector.numberOfYTowers*sector.numberOfZTowers;
+
+   sector.isTowerCalibrated.assign(numberOfTowers, 0);
+   sector.towerTable.assign(numberOfTowers*tableSize, 0.f);
+
+   TF1 towerFunc("tower offset", towerOffsetFunc.c_str(), adcMin, adcMax);
+
+   for (int iy = 0; iy < sector.numberOfYTowers; iy++)
+   {
+      for (int iz = 0; iz < sector.numberOfZTowers; iz++)
+      {
+         if (!towerOffsetTable.IsCalibrated(iy, iz)) continue;
+
+         if (towerOffsetTable.GetNumberOfParameters() != towerFunc.GetNpar())
+         {
+            CppTools::PrintError("EMCTimingCorrection: Number of parameters in " +
+                                 towerOffsetFileName + " does not match the function " +
+                                 towerOffsetFunc);
+         }
+
+         const unsigned long towerIndex = iy*sector.numberOfZTowers + iz;
+
+         towerFunc.SetParameters(towerOffsetTable.GetParameters(iy, iz));
+         FillTable(towerFunc, &sector.towerTable[towerIndex*tableSize]);
+
+         sector.isTowerCalibrated[towerIndex] = 1;
+      }
+   }
+
+   // run parameters
+   if (!std::filesystem::exists(runByRunOffsetFileName))
+   {
+      CppTools::PrintError("EMCTimingCorrection: File " + runByRunOffsetFileName + " does not exist");
+   }
+
+   std::ifstream runByRunOffsetFile(runByRunOffsetFileName);
+
+   TF1 runFunc("run offset", runOffsetFunc.c_str(), adcMin, adcMax);
+
+   std::string line;
+   std::getline(runByRunOffsetFile, line); // skipping the number of runs
+
+   while (std::getline(runByRunOffsetFile, line))
+   {
+      if (line == "") continue;
+
+      std::istringstream lineStream(line);
+
+      int runNumber, status;
+      if (!(lineStream >> runNumber >> status))
+      {
+         CppTools::PrintError("EMCTimingCorrection: Corrupted line \"" + line +
+                              "\" in file " + runByRunOffsetFileName);
+      }
+
+      if (status == 0) continue;
+
+      std::vector<double> parameters;
+      double parameter;
+      while (lineStream >> parameter) parameters.push_back(parameter);
+
+      if (static_cast<int>(parameters.size()) != runFunc.GetNpar())
+      {
+         CppTools::PrintError("EMCTimingCorrection: Number of parameters in line \"" + line +
+                              "\" of file " + runByRunOffsetFileName +
+                              " does not match the function " + runOffsetFunc);
+      }
+
+      runFunc.SetParameters(parameters.data());
+
+      sector.runNumbers.push_back(runNumber);
+      sector.runTable.resize(sector.runNumbers.size()*tableSize);
+      FillTable(runFunc, &sector.runTable[(sector.runNumbers.size() - 1)*tableSize]);
+   }
+
+   if (!std::is_sorted(sector.runNumbers.begin(), sector.runNumbers.end()))
+   {
+      CppTools::PrintError("EMCTimingCorrection: Runs in file " + runByRunOffsetFileName +
+                           " are not sorted");
+   }
+
+   sectors.push_back(std::move(sector));
+   return sectors.size() - 1;
+}
+
+unsigned long EMCTimingCorrection::Correct(const unsigned int sectorBin, const int runNumber,
+                                           const unsigned long numberOfHits,
+                                           const int *iy, const int *iz,
+                                           const double *adc, double *t) const
+{
+   const Sector& sector = sectors[sectorBin];
+
+   // all hits belong to the same run hence the run is searched only once
+   const float *runTable = GetRunTable(sector, runNumber);
+
+   if (!runTable)
+   {
+      std::fill(t, t + numberOfHits, std::numeric_limits<double>::quiet_NaN());
+      return 0;
+   }
+
+   const unsigned long tableSize = numberOfADCBins + 1;
+
+   unsigned long numberOfCorrectedHits = 0;
+
+   for (unsigned long i = 0; i < numberOfHits; i++)
+   {
+      if (iy[i] < 0 || iy[i] >= sector.numberOfYTowers ||
+          iz[i] < 0 || iz[i] >= sector.numberOfZTowers)
+      {
+         t[i] = std::numeric_limits<double>::quiet_NaN();
+         continue;
+      }
+
+      const unsigned long towerIndex = iy[i]*sector.numberOfZTowers + iz[i];
+
+      if (!sector.isTowerCalibrated[towerIndex])
+      {
+         t[i] = std::numeric_limits<double>::quiet_NaN();
+         continue;
+      }
+
+      t[i] -= Interpolate(&sector.towerTable[towerIndex*tableSize], adc[i]) +
+              Interpolate(runTable, adc[i]);
+      numberOfCorrectedHits++;
+   }
+
+   return numberOfCorrectedHits;
+}
+
+double EMCTimingCorrection::Correct(const unsigned int sectorBin, const int runNumber,
+                                    const int iy, const int iz,
+                                    const double adc, const double t) const
+{
+   double correctedT = t;
+   Correct(sectorBin, runNumber, 1, &iy, &iz, &adc, &correctedT);
+   return correctedT;
+}
+
+unsigned int EMCTimingCorrection::GetNumberOfSectors() const
+{
+   return sectors.size();
+}
+
+const std::vector<int>& EMCTimingCorrection::GetRunNumbers(const unsigned int sectorBin) const
+{
+   return sectors[sectorBin].runNumbers;
+}
+
+void EMCTimingCorrection::FillTable(TF1& func, float *table) const
+{
+   for (unsigned int i = 0; i <= numberOfADCBins; i++)
+   {
+      table[i] = static_cast<float>(func.Eval(adcMin + i/inverseADCBinWidth));
+   }
+}
+
+double EMCTimingCorrection::Interpolate(const float *table, const double adc) const
+{
+   const double position =
+      std::clamp((adc - adcMin)*inverseADCBinWidth, 0., static_cast<double>(numberOfADCBins));
+
+   // the last node is handled by the previous interval
+   const unsigned int bin = std::min(static_cast<unsigned int>(position), numberOfADCBins - 1);
+   const double fraction = position - bin;
+
+   return table[bin] + (table[bin + 1] - table[bin])*fraction;
+}
+
+const float *EMCTimingCorrection::GetRunTable(const Sector& sector, const int runNumber) const
+{
+   auto run = std::lower_bound(sector.runNumbers.begin(), sector.runNumbers.end(), runNumber);
+   if (run == sector.runNumbers.end() || *run != runNumber) return nullptr;
+
+   return &sector.runTable[(run - sector.runNumbers.begin())*(numberOfADCBins + 1)];
+}
+
+EMCTimingCorrection::~EMCTimingCorrection() {};
+
+#endif /* EMC_TIMING_CORRECTION_CPP */
@@ -0,0 +1,144 @@
+/** 
+ *  @file   EMCTimingCorrectionBenchmark.cpp
+ *  @brief  Contains realisation of the program that measures the throughput of EMCTimingCorrection
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_TIMING_CORRECTION_BENCHMARK_CPP
+#define EMC_TIMING_CORRECTION_BENCHMARK_CPP
+
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <filesystem>
+
+#include "ErrorHandler.hpp"
+#include "IOTools.hpp"
+
+#include "InputYAMLReader.hpp"
+#include "EMCTimingCorrection.hpp"
+
+// Reads the calibration parameters of all sectors produced by EMCTTowerOffset and EMCTRunByRunOffset,
+// corrects randomly generated hits in batches, and prints the number of corrected hits per second
+int main(int argc, char **argv)
+{
+   if (argc < 2 || argc > 3) 
+   {
+      std::string errMsg = "Expected 1-2 parameters while " + std::to_string(argc - 1) + 
+                           " parameter(s) were provided \n";
+      errMsg += "Usage: bin/EMCTimingCorrectionBenchmark inputFile numberOfHits=10000000\n";
+      CppTools::PrintError(errMsg);
+   }
+
+   const unsigned long numberOfHits = (argc > 2) ? std::stoul(argv[2]) : 10000000;
+
+   InputYAMLReader inputYAMLCal(argv[1], "emc_timing");
+   inputYAMLCal.CheckStatus("emc_timing");
+
+   const std::string parametersDir = "output/EMCTCalibration/" + 
+      inputYAMLCal["run_name"].as<std::string>() + "/CalibrationParameters/";
+
+   const double adcMin = inputYAMLCal["fit_adc_min"].as<double>();
+   const double adcMax = inputYAMLCal["timing_correction"]["adc_max"].as<double>();
+
+   auto startTime = std::chrono::steady_clock::now();
+
+   EMCTimingCorrection timingCorrection(inputYAMLCal["traw_vs_adc_fit_func"].as<std::string>(),
+                                        inputYAMLCal["tcorr_mean_vs_adc_fit_func"].as<std::string>(),
+                                        adcMin, adcMax, inputYAMLCal["timing_correction"]
+                                        ["number_of_adc_bins"].as<unsigned int>());
+
+   std::vector<std::string> sectorNames;
+   std::vector<int> numberOfYTowers, numberOfZTowers;
+
+   for (const auto& sector : inputYAMLCal["sectors_to_calibrate"])
+   {
+      const std::string sectorName = sector["name"].as<std::string>();
+
+      const std::string towerOffsetFileName = parametersDir + "tower_offset_" + sectorName + ".txt";
+      const std::string runByRunOffsetFileName = 
+         parametersDir + "run_by_run_offset_" + sectorName + ".txt";
+
+      if (!std::filesystem::exists(towerOffsetFileName) || 
+          !std::filesystem::exists(runByRunOffsetFileName))
+      {
+         CppTools::PrintWarning("Sector " + sectorName + " was not calibrated; skipping");
+         continue;
+      }
+
+      timingCorrection.AddSector(towerOffsetFileName, runByRunOffsetFileName);
+
+      sectorNames.push_back(sectorName);
+      numberOfYTowers.push_back(sector["number_of_y_towers"].as<int>());
+      numberOfZTowers.push_back(sector["number_of_z_towers"].as<int>());
+   }
+
+   if (sectorNames.empty()) CppTools::PrintError("No calibrated sectors were found in " + parametersDir);
+
+   bool isAnyRunCalibrated = false;
+   for (unsigned int i = 0; i < sectorNames.size(); i++)
+   {
+      if (!timingCorrection.GetRunNumbers(i).empty()) isAnyRunCalibrated = true;
+   }
+   if (!isAnyRunCalibrated) CppTools::PrintError("No calibrated runs were found in " + parametersDir);
+
+   CppTools::PrintInfo("Lookup tables were filled in " + 
+                       std::to_string(std::chrono::duration<double>
+                                      (std::chrono::steady_clock::now() - startTime).count()) + " s");
+
+   // hits are corrected in batches of the same sector and run as in the event loop over clusters
+   const unsigned long batchSize = 4096;
+
+   std::vector<int> iy(batchSize), iz(batchSize);
+   std::vector<double> adc(batchSize), t(batchSize);
+
+   std::mt19937 randomEngine(0);
+   std::uniform_real_distribution<double> adcDistr(adcMin, adcMax);
+   std::normal_distribution<double> tDistr(0., 5.);
+
+   double totalTime = 0.;
+   unsigned long numberOfProcessedHits = 0, numberOfCorrectedHits = 0;
+
+   for (unsigned int sectorBin = 0; numberOfProcessedHits < numberOfHits; 
+        sectorBin = (sectorBin + 1) % sectorNames.size())
+   {
+      const std::vector<int>& runNumbers = timingCorrection.GetRunNumbers(sectorBin);
+      if (runNumbers.empty()) continue;
+
+      std::uniform_int_distribution<int> iyDistr(0, numberOfYTowers[sectorBin] - 1);
+      std::uniform_int_distribution<int> izDistr(0, numberOfZTowers[sectorBin] - 1);
+      std::uniform_int_distribution<unsigned long> runDistr(0, runNumbers.size() - 1);
+
+      // generation of hits is not included in the measured time
+      for (unsigned long i = 0; i < batchSize; i++)
+      {
+         iy[i] = iyDistr(randomEngine);
+         iz[i] = izDistr(randomEngine);
+         adc[i] = adcDistr(randomEngine);
+         t[i] = tDistr(randomEngine);
+      }
+
+      const int runNumber = runNumbers[runDistr(randomEngine)];
+
+      startTime = std::chrono::steady_clock::now();
+
+      numberOfCorrectedHits += timingCorrection.Correct(sectorBin, runNumber, batchSize, iy.data(), 
+                                                        iz.data(), adc.data(), t.data());
+
+      totalTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+      numberOfProcessedHits += batchSize;
+   }
+
+   CppTools::PrintInfo("Processed hits: " + std::to_string(numberOfProcessedHits) + 
+                       ", corrected hits: " + std::to_string(numberOfCorrectedHits));
+   CppTools::PrintInfo("Throughput: " + 
+                       std::to_string(static_cast<double>(numberOfProcessedHits)/totalTime) + 
+                       " hits/s");
+
+   return 0;
+}
+
+#endif /* EMC_TIMING_CORRECTION_BENCHMARK_CPP */
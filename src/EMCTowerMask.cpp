@@ -0,0 +1,115 @@
+/**
+ *  @file   EMCTowerMask.cpp
+ *  @brief  Contains realisation of class EMCTowerMask
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_TOWER_MASK_CPP
+#define EMC_TOWER_MASK_CPP
+
+#include "../include/EMCTowerMask.hpp"
+
+EMCTowerMask::EMCTowerMask() {};
+
+EMCTowerMask::EMCTowerMask(const int numberOfYTowers, const int numberOfZTowers)
+{
+   Init(numberOfYTowers, numberOfZTowers);
+}
+
+void EMCTowerMask::Init(const int numberOfYTowers, const int numberOfZTowers)
+{
+   this->numberOfYTowers = numberOfYTowers;
+   this->numberOfZTowers = numberOfZTowers;
+   towerStatus.assign(numberOfYTowers*numberOfZTowers, OK);
+}
+
+bool EMCTowerMask::ReadFile(const std::string& fileName)
+{
+   if (!std::filesystem::exists(fileName)) return false;
+
+   std::ifstream inputFile(fileName);
+
+   int fileNumberOfYTowers, fileNumberOfZTowers;
+   if (!(inputFile >> fileNumberOfYTowers >> fileNumberOfZTowers))
+   {
+      CppTools::PrintError("EMCTowerMask::ReadFile: Unable to read the number of towers from " +
+                           fileName);
+   }
+
+   if (!towerStatus.empty() && (fileNumberOfYTowers != numberOfYTowers ||
+                                fileNumberOfZTowers != numberOfZTowers))
+   {
+      CppTools::PrintError("EMCTowerMask::ReadFile: Mismatching number of towers in file " +
+                           fileName + ": " + std::to_string(fileNumberOfYTowers) + "x" +
+                           std::to_string(fileNumberOfZTowers) + " vs " +
+                           std::to_string(numberOfYTowers) + "x" +
+                           std::to_string(numberOfZTowers));
+   }
+
+   Init(fileNumberOfYTowers, fileNumberOfZTowers);
+
+   for (unsigned long i = 0; i < towerStatus.size(); i++)
+   {
+      int status;
+      if (!(inputFile >> status) || status < OK || status > HOT)
+      {
+         CppTools::PrintError("EMCTowerMask::ReadFile: File " + fileName +
+                              " is corrupted or incomplete");
+      }
+      towerStatus[i] = static_cast<unsigned char>(status);
+   }
+
+   return true;
+}
+
+void EMCTowerMask::WriteFile(const std::string& fileName) const
+{
+   std::ofstream outputFile(fileName);
+
+   outputFile << numberOfYTowers << " " << numberOfZTowers << std::endl;
+
+   for (int i = 0; i < numberOfYTowers; i++)
+   {
+      for (int j = 0; j < numberOfZTowers - 1; j++)
+      {
+         outputFile << static_cast<int>(towerStatus[i*numberOfZTowers + j]) << " ";
+      }
+      outputFile << static_cast<int>(towerStatus[(i + 1)*numberOfZTowers - 1]) << std::endl;
+   }
+}
+
+void EMCTowerMask::SetStatus(const int iy, const int iz, const TowerStatus status)
+{
+   towerStatus[iy*numberOfZTowers + iz] = static_cast<unsigned char>(status);
+}
+
+EMCTowerMask::TowerStatus EMCTowerMask::GetStatus(const int iy, const int iz) const
+{
+   return static_cast<TowerStatus>(towerStatus[iy*numberOfZTowers + iz]);
+}
+
+bool EMCTowerMask::IsGood(const int iy, const int iz) const
+{
+   return towerStatus[iy*numberOfZTowers + iz] == OK;
+}
+
+unsigned long EMCTowerMask::GetNumberOfTowers(const TowerStatus status) const
+{
+   return std::count(towerStatus.begin(), towerStatus.end(), static_cast<unsigned char>(status));
+}
+
+int EMCTowerMask::GetNumberOfYTowers() const
+{
+   return numberOfYTowers;
+}
+
+int EMCTowerMask::GetNumberOfZTowers() const
+{
+   return numberOfZTowers;
+}
+
+EMCTowerMask::~EMCTowerMask() {};
+
+#endif /* EMC_TOWER_MASK_CPP */
@@ -0,0 +1,263 @@
+/**
+ *  @file   EMCTowerMoments.cpp
+ *  @brief  Contains realisation of class EMCTowerMoments
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_TOWER_MOMENTS_CPP
+#define EMC_TOWER_MOMENTS_CPP
+
+#include "../include/EMCTowerMoments.hpp"
+
+EMCTowerMoments::EMCTowerMoments() {};
+
+bool EMCTowerMoments::ReadFile(const std::string& fileName)
+{
+   if (!std::filesystem::exists(fileName)) return false;
+
+   TFile inputFile(fileName.c_str());
+
+   // histograms are detached from the file so that they are not deleted after it is closed
+   auto GetHist = [&](const std::string& name) -> TH2D *
+   {
+      TH2D *hist = static_cast<TH2D *>(inputFile.Get(name.c_str()));
+      if (!hist)
+      {
+         CppTools::PrintError("EMCTowerMoments::ReadFile: Histogram " + name +
+                              " does not exist in file " + fileName);
+      }
+      hist->SetDirectory(nullptr);
+      return hist;
+   };
+
+   sumW.reset(GetHist("sumw"));
+   sumWT.reset(GetHist("sumwt"));
+   sumWT2.reset(GetHist("sumwt2"));
+   minT.reset(GetHist("tmin"));
+   maxT.reset(GetHist("tmax"));
+   entriesAtLastFit.reset(GetHist("entries at last fit"));
+
+   numberOfZTowers = entriesAtLastFit->GetXaxis()->GetNbins();
+
+   addedFileNames.clear();
+
+   TNamed *addedFiles = static_cast<TNamed *>(inputFile.Get("added files"));
+   if (addedFiles)
+   {
+      std::istringstream addedFilesStream(addedFiles->GetTitle());
+      std::string addedFileName;
+      while (std::getline(addedFilesStream, addedFileName))
+      {
+         if (addedFileName != "") addedFileNames.insert(addedFileName);
+      }
+   }
+
+   inputFile.Close();
+
+   return true;
+}
+
+void EMCTowerMoments::WriteFile(const std::string& fileName) const
+{
+   if (IsEmpty()) return;
+
+   TFile outputFile(fileName.c_str(), "RECREATE");
+
+   outputFile.WriteTObject(sumW.get(), "sumw");
+   outputFile.WriteTObject(sumWT.get(), "sumwt");
+   outputFile.WriteTObject(sumWT2.get(), "sumwt2");
+   outputFile.WriteTObject(minT.get(), "tmin");
+   outputFile.WriteTObject(maxT.get(), "tmax");
+   outputFile.WriteTObject(entriesAtLastFit.get(), "entries at last fit");
+
+   std::string addedFilesList;
+   for (const std::string& addedFileName : addedFileNames) addedFilesList += addedFileName + "\n";
+
+   TNamed addedFiles("added files", addedFilesList.c_str());
+   outputFile.WriteTObject(&addedFiles, "added files");
+
+   outputFile.Close();
+}
+
+void EMCTowerMoments::Init(const int numberOfYTowers, const int numberOfZTowers,
+                           const TAxis *adcAxis)
+{
+   this->numberOfZTowers = numberOfZTowers;
+
+   const int numberOfTowers = numberOfYTowers*numberOfZTowers;
+
+   auto MakeHist = [&](const std::string& name) -> TH2D *
+   {
+      TH2D *hist;
+      if (adcAxis->GetXbins()->GetSize() > 0) // variable binning
+      {
+         hist = new TH2D(name.c_str(), "", numberOfTowers, 0., static_cast<double>(numberOfTowers),
+                         adcAxis->GetNbins(), adcAxis->GetXbins()->GetArray());
+      }
+      else
+      {
+         hist = new TH2D(name.c_str(), "", numberOfTowers, 0., static_cast<double>(numberOfTowers),
+                         adcAxis->GetNbins(), adcAxis->GetXmin(), adcAxis->GetXmax());
+      }
+      hist->SetDirectory(nullptr);
+      return hist;
+   };
+
+   sumW.reset(MakeHist("sumw"));
+   sumWT.reset(MakeHist("sumwt"));
+   sumWT2.reset(MakeHist("sumwt2"));
+   minT.reset(MakeHist("tmin"));
+   maxT.reset(MakeHist("tmax"));
+
+   entriesAtLastFit.reset(new TH2D("entries at last fit", "",
+                                   numberOfZTowers, 0., static_cast<double>(numberOfZTowers),
+                                   numberOfYTowers, 0., static_cast<double>(numberOfYTowers)));
+   entriesAtLastFit->SetDirectory(nullptr);
+}
+
+void EMCTowerMoments::Add(const TH3D *distrTVsADCVsZTower, const int yTowerIndex,
+                          const int numberOfYTowers)
+{
+   const TAxis *tAxis = distrTVsADCVsZTower->GetXaxis();
+   const TAxis *adcAxis = distrTVsADCVsZTower->GetYaxis();
+
+   if (IsEmpty()) Init(numberOfYTowers, distrTVsADCVsZTower->GetZaxis()->GetNbins(), adcAxis);
+
+   if (adcAxis->GetNbins() != sumW->GetYaxis()->GetNbins() ||
+       fabs(adcAxis->GetXmin() - sumW->GetYaxis()->GetXmin()) > 1e-7 ||
+       fabs(adcAxis->GetXmax() - sumW->GetYaxis()->GetXmax()) > 1e-7)
+   {
+      CppTools::PrintError("EMCTowerMoments::Add: Mismatching ADC binning of histogram " +
+                           static_cast<std::string>(distrTVsADCVsZTower->GetName()));
+   }
+
+   if (distrTVsADCVsZTower->GetZaxis()->GetNbins() != numberOfZTowers)
+   {
+      CppTools::PrintError("EMCTowerMoments::Add: Mismatching number of z towers in histogram " +
+                           static_cast<std::string>(distrTVsADCVsZTower->GetName()));
+   }
+
+   for (int i = 0; i < numberOfZTowers; i++)
+   {
+      // bin of the tower along x axis of moments histograms
+      const int towerBin = yTowerIndex*numberOfZTowers + i + 1;
+
+      for (int j = 1; j <= adcAxis->GetNbins(); j++)
+      {
+         double w = 0., wt = 0., wt2 = 0.;
+         double firstT = 1e31, lastT = -1e31;
+
+         for (int k = 1; k <= tAxis->GetNbins(); k++)
+         {
+            const double content = distrTVsADCVsZTower->GetBinContent(k, j, i + 1);
+            if (content < 1e-15) continue;
+
+            const double t = tAxis->GetBinCenter(k);
+
+            w += content;
+            wt += content*t;
+            wt2 += content*t*t;
+
+            if (firstT > 1e30) firstT = tAxis->GetBinLowEdge(k);
+            lastT = tAxis->GetBinUpEdge(k);
+         }
+
+         if (w < 1e-15) continue;
+
+         // min and max are only meaningful for bins that already have entries
+         if (sumW->GetBinContent(towerBin, j) < 1e-15)
+         {
+            minT->SetBinContent(towerBin, j, firstT);
+            maxT->SetBinContent(towerBin, j, lastT);
+         }
+         else
+         {
+            minT->SetBinContent(towerBin, j,
+                                CppTools::Minimum(minT->GetBinContent(towerBin, j), firstT));
+            maxT->SetBinContent(towerBin, j,
+                                CppTools::Maximum(maxT->GetBinContent(towerBin, j), lastT));
+         }
+
+         sumW->SetBinContent(towerBin, j, sumW->GetBinContent(towerBin, j) + w);
+         sumWT->SetBinContent(towerBin, j, sumWT->GetBinContent(towerBin, j) + wt);
+         sumWT2->SetBinContent(towerBin, j, sumWT2->GetBinContent(towerBin, j) + wt2);
+      }
+   }
+}
+
+bool EMCTowerMoments::IsFileAdded(const std::string& fileName) const
+{
+   return addedFileNames.find(fileName) != addedFileNames.end();
+}
+
+void EMCTowerMoments::SetFileAdded(const std::string& fileName)
+{
+   addedFileNames.insert(fileName);
+}
+
+bool EMCTowerMoments::IsEmpty() const
+{
+   return !sumW;
+}
+
+double EMCTowerMoments::GetEntries(const int iy, const int iz, const int firstADCBin) const
+{
+   if (IsEmpty()) return 0.;
+
+   const int towerBin = iy*numberOfZTowers + iz + 1;
+
+   double entries = 0.;
+   for (int i = CppTools::Maximum(firstADCBin, 1); i <= sumW->GetYaxis()->GetNbins(); i++)
+   {
+      entries += sumW->GetBinContent(towerBin, i);
+   }
+   return entries;
+}
+
+void EMCTowerMoments::FillMeanDistr(const int iy, const int iz, const int firstADCBin,
+                                    TH1D& meanDistr, double& minT, double& maxT) const
+{
+   minT = 1e31;
+   maxT = -1e31;
+
+   const int towerBin = iy*numberOfZTowers + iz + 1;
+
+   for (int i = CppTools::Maximum(firstADCBin, 1); i <= sumW->GetYaxis()->GetNbins(); i++)
+   {
+      const double w = sumW->GetBinContent(towerBin, i);
+      if (w < 1e-15) continue;
+
+      const double mean = sumWT->GetBinContent(towerBin, i)/w;
+      const double variance =
+         CppTools::Maximum(sumWT2->GetBinContent(towerBin, i)/w - mean*mean, 0.);
+
+      // the same values as TH1::GetMean and TH1::GetMeanError give for unweighted projection
+      meanDistr.SetBinContent(i, mean);
+      meanDistr.SetBinError(i, sqrt(variance/w));
+
+      minT = CppTools::Minimum(minT, this->minT->GetBinContent(towerBin, i));
+      maxT = CppTools::Maximum(maxT, this->maxT->GetBinContent(towerBin, i));
+   }
+}
+
+double EMCTowerMoments::GetEntriesAtLastFit(const int iy, const int iz) const
+{
+   if (IsEmpty()) return 0.;
+   return entriesAtLastFit->GetBinContent(iz + 1, iy + 1);
+}
+
+void EMCTowerMoments::SetEntriesAtLastFit(const int iy, const int iz, const double entries)
+{
+   entriesAtLastFit->SetBinContent(iz + 1, iy + 1, entries);
+}
+
+const TAxis *EMCTowerMoments::GetADCAxis() const
+{
+   return sumW->GetYaxis();
+}
+
+EMCTowerMoments::~EMCTowerMoments() {};
+
+#endif /* EMC_TOWER_MOMENTS_CPP */
@@ -0,0 +1,145 @@
+/**
+ *  @file   EMCTowerOffsetTable.cpp
+ *  @brief  Contains realisation of class EMCTowerOffsetTable
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef EMC_TOWER_OFFSET_TABLE_CPP
+#define EMC_TOWER_OFFSET_TABLE_CPP
+
+#include "../include/EMCTowerOffsetTable.hpp"
+
+EMCTowerOffsetTable::EMCTowerOffsetTable() {};
+
+EMCTowerOffsetTable::EMCTowerOffsetTable(const std::string& fileName)
+{
+   if (!ReadFile(fileName))
+   {
+      CppTools::PrintError("EMCTowerOffsetTable: File " + fileName + " does not exist");
+   }
+}
+
+bool EMCTowerOffsetTable::ReadFile(const std::string& fileName)
+{
+   if (!std::filesystem::exists(fileName)) return false;
+
+   std::ifstream inputFile(fileName);
+
+   if (!(inputFile >> numberOfYTowers >> numberOfZTowers))
+   {
+      CppTools::PrintError("EMCTowerOffsetTable::ReadFile: Unable to read the number of towers from " +
+                           fileName);
+   }
+
+   numberOfParameters = 0;
+   isTowerCalibrated.assign(numberOfYTowers*numberOfZTowers, 0);
+   parameters.clear();
+
+   // parameters of towers are read in temporary container since the number
+   // of parameters is not known until the first calibrated tower is read
+   std::vector<std::vector<double>> towerParameters(numberOfYTowers*numberOfZTowers);
+
+   std::string line;
+   std::getline(inputFile, line); // skipping the rest of the first line
+
+   for (unsigned long i = 0; i < isTowerCalibrated.size(); i++)
+   {
+      if (!std::getline(inputFile, line))
+      {
+         CppTools::PrintError("EMCTowerOffsetTable::ReadFile: File " + fileName +
+                              " is incomplete");
+      }
+
+      std::istringstream lineStream(line);
+
+      int status;
+      lineStream >> status;
+
+      if (status == 0) continue;
+
+      double parameter;
+      while (lineStream >> parameter) towerParameters[i].push_back(parameter);
+
+      if (numberOfParameters == 0) numberOfParameters = towerParameters[i].size();
+      else if (numberOfParameters != static_cast<int>(towerParameters[i].size()))
+      {
+         CppTools::PrintError("EMCTowerOffsetTable::ReadFile: Mismatching number of parameters "
+                              "in line " + std::to_string(i + 2) + " of file " + fileName);
+      }
+
+      isTowerCalibrated[i] = 1;
+   }
+
+   parameters.assign(isTowerCalibrated.size()*numberOfParameters, 0.);
+
+   for (unsigned long i = 0; i < towerParameters.size(); i++)
+   {
+      std::copy(towerParameters[i].begin(), towerParameters[i].end(),
+                parameters.begin() + i*numberOfParameters);
+   }
+
+   parametersRMS.assign(numberOfParameters, 0.);
+
+   std::vector<double> sum(numberOfParameters, 0.), sum2(numberOfParameters, 0.);
+   unsigned long numberOfCalibratedTowers = 0;
+
+   for (unsigned long i = 0; i < towerParameters.size(); i++)
+   {
+      if (!isTowerCalibrated[i]) continue;
+
+      for (int j = 0; j < numberOfParameters; j++)
+      {
+         sum[j] += towerParameters[i][j];
+         sum2[j] += towerParameters[i][j]*towerParameters[i][j];
+      }
+      numberOfCalibratedTowers++;
+   }
+
+   if (numberOfCalibratedTowers == 0) return true;
+
+   for (int i = 0; i < numberOfParameters; i++)
+   {
+      const double mean = sum[i]/static_cast<double>(numberOfCalibratedTowers);
+      parametersRMS[i] = 
+         sqrt(CppTools::Maximum(sum2[i]/static_cast<double>(numberOfCalibratedTowers) - 
+                                mean*mean, 0.));
+   }
+
+   return true;
+}
+
+bool EMCTowerOffsetTable::IsCalibrated(const int iy, const int iz) const
+{
+   return isTowerCalibrated[iy*numberOfZTowers + iz];
+}
+
+const double *EMCTowerOffsetTable::GetParameters(const int iy, const int iz) const
+{
+   return &parameters[(iy*numberOfZTowers + iz)*numberOfParameters];
+}
+
+int EMCTowerOffsetTable::GetNumberOfParameters() const
+{
+   return numberOfParameters;
+}
+
+double EMCTowerOffsetTable::GetParameterRMS(const int parIndex) const
+{
+   return parametersRMS[parIndex];
+}
+
+int EMCTowerOffsetTable::GetNumberOfYTowers() const
+{
+   return numberOfYTowers;
+}
+
+int EMCTowerOffsetTable::GetNumberOfZTowers() const
+{
+   return numberOfZTowers;
+}
+
+EMCTowerOffsetTable::~EMCTowerOffsetTable() {};
+
+#endif /* EMC_TOWER_OFFSET_TABLE_CPP */
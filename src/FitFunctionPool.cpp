@@ -0,0 +1,80 @@
+/**
+ *  @file   FitFunctionPool.cpp
+ *  @brief  Contains realisation of class FitFunctionPool
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef FIT_FUNCTION_POOL_CPP
+#define FIT_FUNCTION_POOL_CPP
+
+#include "../include/FitFunctionPool.hpp"
+
+FitFunctionPool::FitFunctionPool() {};
+
+TF1 *FitFunctionPool::Get(const std::string& name, const std::string& formula,
+                          const double xMin, const double xMax)
+{
+   std::vector<PooledFunction>& modelFunctions = functions[formula];
+
+   for (PooledFunction& pooledFunction : modelFunctions)
+   {
+      if (pooledFunction.isUsed) continue;
+
+      pooledFunction.isUsed = true;
+      Reset(pooledFunction, name, xMin, xMax);
+
+      return pooledFunction.function.get();
+   }
+
+   modelFunctions.emplace_back();
+   modelFunctions.back().function =
+      std::make_unique<TF1>(name.c_str(), formula.c_str(), xMin, xMax, TF1::EAddToList::kNo);
+   modelFunctions.back().function->TAttLine::Copy(modelFunctions.back().lineAttributes);
+
+   return modelFunctions.back().function.get();
+}
+
+void FitFunctionPool::Recycle()
+{
+   for (auto& [formula, modelFunctions] : functions)
+   {
+      for (PooledFunction& pooledFunction : modelFunctions) pooledFunction.isUsed = false;
+   }
+}
+
+unsigned long FitFunctionPool::GetNumberOfFunctions() const
+{
+   unsigned long numberOfFunctions = 0;
+   for (const auto& [formula, modelFunctions] : functions) numberOfFunctions += modelFunctions.size();
+   return numberOfFunctions;
+}
+
+void FitFunctionPool::Reset(PooledFunction& pooledFunction, const std::string& name,
+                            const double xMin, const double xMax)
+{
+   TF1 *function = pooledFunction.function.get();
+
+   function->SetName(name.c_str());
+   function->SetRange(xMin, xMax);
+
+   for (int i = 0; i < function->GetNpar(); i++)
+   {
+      function->SetParameter(i, 0.);
+      function->SetParError(i, 0.);
+      // limits are removed; this also unfixes the parameter
+      function->ReleaseParameter(i);
+   }
+
+   // results of the previous fit
+   function->SetChisquare(0.);
+   function->SetNumberFitPoints(0);
+   function->SetNDF(0);
+
+   pooledFunction.lineAttributes.Copy(*function);
+}
+
+FitFunctionPool::~FitFunctionPool() {};
+
+#endif /* FIT_FUNCTION_POOL_CPP */
@@ -0,0 +1,124 @@
+/**
+ *  @file   FitRangeSystematics.cpp
+ *  @brief  Contains realisation of class FitRangeSystematics
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef FIT_RANGE_SYSTEMATICS_CPP
+#define FIT_RANGE_SYSTEMATICS_CPP
+
+#include "../include/FitRangeSystematics.hpp"
+
+FitRangeSystematics::FitRangeSystematics() {};
+
+FitRangeSystematics::FitRangeSystematics(const std::vector<std::pair<double, double>>& windows)
+{
+   for (const std::pair<double, double>& window : windows)
+   {
+      if (window.first >= window.second)
+      {
+         CppTools::PrintError("FitRangeSystematics: Lower edge of the window must be smaller "
+                              "than its upper edge");
+      }
+   }
+
+   this->windows = windows;
+}
+
+bool FitRangeSystematics::Estimate(const TH1 *hist, const TF1& backgroundFunc,
+                                   const double mean, const double sigma)
+{
+   meanError = 0.;
+   sigmaError = 0.;
+   numberOfUsedWindows = 0;
+
+   if (sigma <= 0.) return false;
+
+   const TAxis *axis = hist->GetXaxis();
+
+   // probability density and cumulative distribution of the standard gaussian
+   auto PDF = [](const double x)
+   {
+      return exp(-x*x/2.)/sqrt(2.*M_PI);
+   };
+   auto CDF = [](const double x)
+   {
+      return (1. + erf(x/sqrt(2.)))/2.;
+   };
+
+   double sumMeanDeviation2 = 0., sumSigmaDeviation2 = 0.;
+
+   for (const std::pair<double, double>& window : windows)
+   {
+      const int firstBin = CppTools::Maximum(1, axis->FindBin(mean + window.first*sigma));
+      const int lastBin =
+         CppTools::Minimum(axis->FindBin(mean + window.second*sigma), axis->GetNbins());
+
+      if (lastBin - firstBin + 1 < minNumberOfBins) continue;
+
+      double sumW = 0., sumWX = 0., sumWXX = 0.;
+      for (int i = firstBin; i <= lastBin; i++)
+      {
+         const double x = axis->GetBinCenter(i);
+         const double content = hist->GetBinContent(i) - backgroundFunc.Eval(x);
+
+         sumW += content;
+         sumWX += content*x;
+         sumWXX += content*x*x;
+      }
+
+      if (sumW <= 0.) continue;
+
+      // edges of the bins of the window in sigmas
+      const double alpha = (axis->GetBinLowEdge(firstBin) - mean)/sigma;
+      const double beta = (axis->GetBinUpEdge(lastBin) - mean)/sigma;
+
+      const double probability = CDF(beta) - CDF(alpha);
+      if (probability < 1e-7) continue;
+
+      // shift of the mean and ratio of the variance of the truncated gaussian to the full one
+      const double truncatedShift = (PDF(alpha) - PDF(beta))/probability;
+      const double truncatedVarianceScale = 1. + (alpha*PDF(alpha) - beta*PDF(beta))/probability -
+                                            truncatedShift*truncatedShift;
+
+      const double binWidth = axis->GetBinWidth(firstBin);
+      const double windowVariance = sumWXX/sumW - sumWX*sumWX/sumW/sumW - binWidth*binWidth/12.;
+
+      if (windowVariance <= 0. || truncatedVarianceScale <= 0.) continue;
+
+      const double windowSigma = sqrt(windowVariance/truncatedVarianceScale);
+      const double windowMean = sumWX/sumW - windowSigma*truncatedShift;
+
+      sumMeanDeviation2 += (windowMean - mean)*(windowMean - mean);
+      sumSigmaDeviation2 += (windowSigma - sigma)*(windowSigma - sigma);
+      numberOfUsedWindows++;
+   }
+
+   if (numberOfUsedWindows == 0) return false;
+
+   meanError = sqrt(sumMeanDeviation2/static_cast<double>(numberOfUsedWindows));
+   sigmaError = sqrt(sumSigmaDeviation2/static_cast<double>(numberOfUsedWindows));
+
+   return true;
+}
+
+double FitRangeSystematics::GetMeanError() const
+{
+   return meanError;
+}
+
+double FitRangeSystematics::GetSigmaError() const
+{
+   return sigmaError;
+}
+
+unsigned int FitRangeSystematics::GetNumberOfUsedWindows() const
+{
+   return numberOfUsedWindows;
+}
+
+FitRangeSystematics::~FitRangeSystematics() {};
+
+#endif /* FIT_RANGE_SYSTEMATICS_CPP */
@@ -0,0 +1,216 @@
+/**
+ *  @file   FitStrategyLadder.cpp
+ *  @brief  Contains realisation of class FitStrategyLadder
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef FIT_STRATEGY_LADDER_CPP
+#define FIT_STRATEGY_LADDER_CPP
+
+#include "../include/FitStrategyLadder.hpp"
+
+FitStrategyLadder::FitStrategyLadder() {};
+
+FitStrategyLadder::FitStrategyLadder(const std::string& name, const YAML::Node& ladder)
+{
+   this->name = name;
+
+   if (!ladder["tiers"] || ladder["tiers"].size() == 0)
+   {
+      CppTools::PrintError("FitStrategyLadder: No tiers are specified for " + name);
+   }
+
+   if (ladder["max_chi2_ndf"]) maxChi2NDF = ladder["max_chi2_ndf"].as<double>();
+
+   for (const YAML::Node& tierNode : ladder["tiers"])
+   {
+      Tier tier;
+
+      const std::string method = tierNode["method"].as<std::string>();
+      if (method == "estimate") tier.method = Method::ESTIMATE;
+      else if (method == "fit") tier.method = Method::FIT;
+      else
+      {
+         CppTools::PrintError("FitStrategyLadder: Unknown method \"" + method + "\" in " + name +
+                              "; expected \"estimate\" or \"fit\"");
+      }
+
+      if (tier.method == Method::FIT)
+      {
+         tier.options = tierNode["options"].as<std::string>();
+         if (tierNode["strategy"]) tier.strategy = tierNode["strategy"].as<int>();
+         if (tierNode["number_of_tries"])
+         {
+            tier.numberOfTries = tierNode["number_of_tries"].as<unsigned int>();
+         }
+
+         if (tier.strategy < 0 || tier.strategy > 2)
+         {
+            CppTools::PrintError("FitStrategyLadder: Minuit strategy must be 0, 1, or 2 in " + name);
+         }
+         if (tier.numberOfTries == 0)
+         {
+            CppTools::PrintError("FitStrategyLadder: Number of tries must be bigger than 0 in " +
+                                 name);
+         }
+      }
+
+      tiers.push_back(tier);
+   }
+
+   tiersStatistics.resize(tiers.size());
+}
+
+bool FitStrategyLadder::Run(const std::function<bool()>& estimate,
+                            const std::function<int(const Tier&, const unsigned int)>& fit,
+                            const std::function<bool()>& isAccepted)
+{
+   const int defaultStrategy = ROOT::Math::MinimizerOptions::DefaultStrategy();
+
+   for (unsigned long i = 0; i < tiers.size(); i++)
+   {
+      lastTierIndex = i;
+
+      const auto startTime = std::chrono::steady_clock::now();
+
+      bool isTierAccepted;
+
+      if (tiers[i].method == Method::ESTIMATE)
+      {
+         if (!estimate)
+         {
+            CppTools::PrintError("FitStrategyLadder: Estimate is not available for " + name);
+         }
+         isTierAccepted = estimate();
+      }
+      else
+      {
+         ROOT::Math::MinimizerOptions::SetDefaultStrategy(tiers[i].strategy);
+
+         int fitStatus = 0;
+         for (unsigned int j = 0; j < tiers[i].numberOfTries; j++) fitStatus = fit(tiers[i], j);
+
+         ROOT::Math::MinimizerOptions::SetDefaultStrategy(defaultStrategy);
+
+         isTierAccepted = (fitStatus == 0 && isAccepted());
+      }
+
+      tiersStatistics[i].numberOfCalls++;
+      tiersStatistics[i].time += std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                               startTime).count();
+
+      if (isTierAccepted)
+      {
+         tiersStatistics[i].numberOfAccepted++;
+         return true;
+      }
+   }
+
+   numberOfUnaccepted++;
+   return false;
+}
+
+const FitStrategyLadder::Tier& FitStrategyLadder::GetLastTier() const
+{
+   return tiers[lastTierIndex];
+}
+
+bool FitStrategyLadder::IsFitGood(const TF1& func) const
+{
+   for (int i = 0; i < func.GetNpar(); i++)
+   {
+      if (!std::isfinite(func.GetParameter(i)) || !std::isfinite(func.GetParError(i))) return false;
+   }
+
+   if (maxChi2NDF > 0. && func.GetNDF() > 0 &&
+       func.GetChisquare()/static_cast<double>(func.GetNDF()) > maxChi2NDF) return false;
+
+   return true;
+}
+
+void FitStrategyLadder::PrintStatistics() const
+{
+   for (unsigned long i = 0; i < tiers.size(); i++)
+   {
+      CppTools::PrintInfo(name + ": tier " + std::to_string(i) + " (" + GetDescription(tiers[i]) +
+                          ") accepted " + std::to_string(tiersStatistics[i].numberOfAccepted) +
+                          " of " + std::to_string(tiersStatistics[i].numberOfCalls) + " in " +
+                          CppTools::DtoStr(tiersStatistics[i].time, 2) + " s");
+   }
+   if (numberOfUnaccepted > 0)
+   {
+      CppTools::PrintWarning(name + ": " + std::to_string(numberOfUnaccepted) +
+                             " results were not accepted by any tier");
+   }
+}
+
+void FitStrategyLadder::WriteStatistics(const std::string& fileName) const
+{
+   std::ofstream statisticsFile(fileName);
+
+   statisticsFile << "# tier, description, calls, accepted, time [s]; not accepted by any tier: " <<
+                     numberOfUnaccepted << std::endl;
+
+   for (unsigned long i = 0; i < tiers.size(); i++)
+   {
+      statisticsFile << i << " \"" << GetDescription(tiers[i]) << "\" " <<
+                        tiersStatistics[i].numberOfCalls << " " <<
+                        tiersStatistics[i].numberOfAccepted << " " <<
+                        tiersStatistics[i].time << std::endl;
+   }
+}
+
+void FitStrategyLadder::AddStatistics(const std::string& fileName)
+{
+   std::ifstream statisticsFile(fileName);
+
+   if (!statisticsFile.is_open())
+   {
+      CppTools::PrintError("FitStrategyLadder: Unable to open file " + fileName);
+   }
+
+   std::string line;
+   std::getline(statisticsFile, line);
+
+   // number of results not accepted by any tier is written at the end of the header
+   if (line.rfind(':') == std::string::npos)
+   {
+      CppTools::PrintError("FitStrategyLadder: Unexpected header in file " + fileName);
+   }
+   numberOfUnaccepted += std::stoul(line.substr(line.rfind(':') + 1));
+
+   for (unsigned long i = 0; i < tiers.size(); i++)
+   {
+      unsigned long tierIndex, numberOfCalls, numberOfAccepted;
+      double time;
+      std::string description;
+
+      // description is written in quotes hence it is read up to the closing quote
+      if (!(statisticsFile >> tierIndex) || tierIndex != i ||
+          !std::getline(statisticsFile, description, '"') ||
+          !std::getline(statisticsFile, description, '"') ||
+          description != GetDescription(tiers[i]) ||
+          !(statisticsFile >> numberOfCalls >> numberOfAccepted >> time))
+      {
+         CppTools::PrintError("FitStrategyLadder: Tiers in file " + fileName +
+                              " do not match the tiers of " + name);
+      }
+
+      tiersStatistics[i].numberOfCalls += numberOfCalls;
+      tiersStatistics[i].numberOfAccepted += numberOfAccepted;
+      tiersStatistics[i].time += time;
+   }
+}
+
+std::string FitStrategyLadder::GetDescription(const Tier& tier)
+{
+   if (tier.method == Method::ESTIMATE) return "estimate";
+   return "fit " + tier.options + ", strategy " + std::to_string(tier.strategy) + ", " +
+          std::to_string(tier.numberOfTries) + " tries";
+}
+
+FitStrategyLadder::~FitStrategyLadder() {};
+
+#endif /* FIT_STRATEGY_LADDER_CPP */
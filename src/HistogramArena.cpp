@@ -0,0 +1,298 @@
+/**
+ *  @file   HistogramArena.cpp
+ *  @brief  Contains realisation of class HistogramArena
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef HISTOGRAM_ARENA_CPP
+#define HISTOGRAM_ARENA_CPP
+
+#include "../include/HistogramArena.hpp"
+
+HistogramArena::HistogramArena() {};
+
+TH1D *HistogramArena::ProjectionY(const TH2 *hist, const std::string& name,
+                                  const int firstXBin, const int lastXBin)
+{
+   int firstBin = firstXBin, lastBin = lastXBin;
+   ClampRange(hist->GetXaxis(), firstBin, lastBin);
+
+   int firstProjBin, lastProjBin;
+   GetProjectedRange(hist->GetYaxis(), firstProjBin, lastProjBin);
+
+   TH1D *proj = Get1DBuffer(hist, hist->GetYaxis(), name);
+
+   const TArrayD *sumw2 = hist->GetSumw2();
+   TArrayD *projSumw2 = proj->GetSumw2();
+   const bool isErrorComputed = (hist->GetSumw2N() > 0);
+
+   double entries = 0.;
+
+   for (int i = firstProjBin; i <= lastProjBin; i++)
+   {
+      // X bins are contiguous in memory
+      for (int j = firstBin; j <= lastBin; j++)
+      {
+         const int bin = hist->GetBin(j, i);
+         const double content = hist->GetBinContent(bin);
+
+         proj->AddBinContent(i, content);
+         if (isErrorComputed) (*projSumw2)[i] += sumw2->At(bin);
+         entries += content;
+      }
+   }
+
+   proj->ResetStats();
+   proj->SetEntries(entries);
+
+   return proj;
+}
+
+TH1D *HistogramArena::ProjectionX(const TH3 *hist, const std::string& name,
+                                  const int firstYBin, const int lastYBin,
+                                  const int firstZBin, const int lastZBin)
+{
+   int firstBinY = firstYBin, lastBinY = lastYBin;
+   int firstBinZ = firstZBin, lastBinZ = lastZBin;
+   ClampRange(hist->GetYaxis(), firstBinY, lastBinY);
+   ClampRange(hist->GetZaxis(), firstBinZ, lastBinZ);
+
+   int firstProjBin, lastProjBin;
+   GetProjectedRange(hist->GetXaxis(), firstProjBin, lastProjBin);
+
+   TH1D *proj = Get1DBuffer(hist, hist->GetXaxis(), name);
+
+   const TArrayD *sumw2 = hist->GetSumw2();
+   TArrayD *projSumw2 = proj->GetSumw2();
+   const bool isErrorComputed = (hist->GetSumw2N() > 0);
+
+   double entries = 0.;
+
+   for (int k = firstBinZ; k <= lastBinZ; k++)
+   {
+      for (int j = firstBinY; j <= lastBinY; j++)
+      {
+         // X bins are contiguous in memory
+         for (int i = firstProjBin; i <= lastProjBin; i++)
+         {
+            const int bin = hist->GetBin(i, j, k);
+            const double content = hist->GetBinContent(bin);
+
+            proj->AddBinContent(i, content);
+            if (isErrorComputed) (*projSumw2)[i] += sumw2->At(bin);
+            entries += content;
+         }
+      }
+   }
+
+   proj->ResetStats();
+   proj->SetEntries(entries);
+
+   return proj;
+}
+
+TH2D *HistogramArena::ProjectionXY(const TH3 *hist, const std::string& name,
+                                   const int firstZBin, const int lastZBin)
+{
+   int firstBin = firstZBin, lastBin = lastZBin;
+   ClampRange(hist->GetZaxis(), firstBin, lastBin);
+
+   int firstProjXBin, lastProjXBin, firstProjYBin, lastProjYBin;
+   GetProjectedRange(hist->GetXaxis(), firstProjXBin, lastProjXBin);
+   GetProjectedRange(hist->GetYaxis(), firstProjYBin, lastProjYBin);
+
+   // Y axis of the histogram becomes X axis of the projection
+   TH2D *proj = Get2DBuffer(hist, hist->GetYaxis(), hist->GetXaxis(), name);
+
+   const TArrayD *sumw2 = hist->GetSumw2();
+   TArrayD *projSumw2 = proj->GetSumw2();
+   const bool isErrorComputed = (hist->GetSumw2N() > 0);
+
+   double entries = 0.;
+
+   for (int k = firstBin; k <= lastBin; k++)
+   {
+      for (int j = firstProjYBin; j <= lastProjYBin; j++)
+      {
+         // X bins are contiguous in memory
+         for (int i = firstProjXBin; i <= lastProjXBin; i++)
+         {
+            const int bin = hist->GetBin(i, j, k);
+            const int projBin = proj->GetBin(j, i);
+            const double content = hist->GetBinContent(bin);
+
+            proj->AddBinContent(projBin, content);
+            if (isErrorComputed) (*projSumw2)[projBin] += sumw2->At(bin);
+            entries += content;
+         }
+      }
+   }
+
+   proj->ResetStats();
+   proj->SetEntries(entries);
+
+   return proj;
+}
+
+void HistogramArena::Recycle()
+{
+   isBuffer1DUsed.assign(isBuffer1DUsed.size(), false);
+   isBuffer2DUsed.assign(isBuffer2DUsed.size(), false);
+}
+
+void HistogramArena::Release(const TH1 *buffer)
+{
+   for (unsigned long i = 0; i < buffers1D.size(); i++)
+   {
+      if (buffers1D[i].get() == buffer) isBuffer1DUsed[i] = false;
+   }
+   for (unsigned long i = 0; i < buffers2D.size(); i++)
+   {
+      if (buffers2D[i].get() == buffer) isBuffer2DUsed[i] = false;
+   }
+}
+
+unsigned long HistogramArena::GetNumberOfBuffers() const
+{
+   return buffers1D.size() + buffers2D.size();
+}
+
+bool HistogramArena::IsSameBinning(const TAxis *axis1, const TAxis *axis2)
+{
+   if (axis1->GetNbins() != axis2->GetNbins()) return false;
+
+   // edges are compared for variable bins
+   if (axis1->GetXbins()->GetSize() > 0 || axis2->GetXbins()->GetSize() > 0)
+   {
+      for (int i = 1; i <= axis1->GetNbins() + 1; i++)
+      {
+         if (axis1->GetBinLowEdge(i) != axis2->GetBinLowEdge(i)) return false;
+      }
+      return true;
+   }
+
+   return (axis1->GetXmin() == axis2->GetXmin() && axis1->GetXmax() == axis2->GetXmax());
+}
+
+void HistogramArena::ClampRange(const TAxis *axis, int& firstBin, int& lastBin)
+{
+   if (firstBin < 0) firstBin = 0;
+   if (lastBin > axis->GetNbins() + 1) lastBin = axis->GetNbins() + 1;
+   if (lastBin < firstBin)
+   {
+      firstBin = 0;
+      lastBin = axis->GetNbins() + 1;
+   }
+}
+
+void HistogramArena::GetProjectedRange(const TAxis *axis, int& firstBin, int& lastBin)
+{
+   // the same as in ROOT underflow and overflow bins are projected only if the range is not set
+   if (axis->TestBit(TAxis::kAxisRange))
+   {
+      firstBin = axis->GetFirst();
+      lastBin = axis->GetLast();
+   }
+   else
+   {
+      firstBin = 0;
+      lastBin = axis->GetNbins() + 1;
+   }
+}
+
+void HistogramArena::PrepareBuffer(TH1 *buffer, const TH1 *hist, const std::string& name)
+{
+   buffer->Reset();
+   buffer->SetName(name.c_str());
+   buffer->SetTitle(hist->GetTitle());
+   buffer->SetMinimum();
+   buffer->SetMaximum();
+   // functions stored by the fits of the previous projection
+   buffer->GetListOfFunctions()->Delete();
+
+   for (TAxis *axis : {buffer->GetXaxis(), buffer->GetYaxis()}) axis->SetRange();
+
+   // the same as in ROOT errors are stored only if they are stored in the histogram
+   if (hist->GetSumw2N() > 0 && buffer->GetSumw2N() == 0) buffer->Sumw2();
+   else if (hist->GetSumw2N() == 0 && buffer->GetSumw2N() > 0) buffer->Sumw2(false);
+}
+
+TH1D *HistogramArena::Get1DBuffer(const TH1 *hist, const TAxis *axis, const std::string& name)
+{
+   for (unsigned long i = 0; i < buffers1D.size(); i++)
+   {
+      if (isBuffer1DUsed[i] || !IsSameBinning(buffers1D[i]->GetXaxis(), axis)) continue;
+
+      isBuffer1DUsed[i] = true;
+      PrepareBuffer(buffers1D[i].get(), hist, name);
+      buffers1D[i]->GetXaxis()->SetTitle(axis->GetTitle());
+
+      return buffers1D[i].get();
+   }
+
+   if (axis->GetXbins()->GetSize() > 0)
+   {
+      buffers1D.emplace_back(new TH1D(name.c_str(), hist->GetTitle(), axis->GetNbins(),
+                                      axis->GetXbins()->GetArray()));
+   }
+   else
+   {
+      buffers1D.emplace_back(new TH1D(name.c_str(), hist->GetTitle(), axis->GetNbins(),
+                                      axis->GetXmin(), axis->GetXmax()));
+   }
+   isBuffer1DUsed.push_back(true);
+
+   buffers1D.back()->SetDirectory(nullptr);
+   PrepareBuffer(buffers1D.back().get(), hist, name);
+   buffers1D.back()->GetXaxis()->SetTitle(axis->GetTitle());
+
+   return buffers1D.back().get();
+}
+
+TH2D *HistogramArena::Get2DBuffer(const TH1 *hist, const TAxis *xAxis, const TAxis *yAxis,
+                                  const std::string& name)
+{
+   for (unsigned long i = 0; i < buffers2D.size(); i++)
+   {
+      if (isBuffer2DUsed[i] || !IsSameBinning(buffers2D[i]->GetXaxis(), xAxis) ||
+          !IsSameBinning(buffers2D[i]->GetYaxis(), yAxis)) continue;
+
+      isBuffer2DUsed[i] = true;
+      PrepareBuffer(buffers2D[i].get(), hist, name);
+      buffers2D[i]->GetXaxis()->SetTitle(xAxis->GetTitle());
+      buffers2D[i]->GetYaxis()->SetTitle(yAxis->GetTitle());
+
+      return buffers2D[i].get();
+   }
+
+   if (xAxis->GetXbins()->GetSize() > 0 || yAxis->GetXbins()->GetSize() > 0)
+   {
+      std::vector<double> xEdges, yEdges;
+      for (int i = 1; i <= xAxis->GetNbins() + 1; i++) xEdges.push_back(xAxis->GetBinLowEdge(i));
+      for (int i = 1; i <= yAxis->GetNbins() + 1; i++) yEdges.push_back(yAxis->GetBinLowEdge(i));
+
+      buffers2D.emplace_back(new TH2D(name.c_str(), hist->GetTitle(),
+                                      xAxis->GetNbins(), xEdges.data(),
+                                      yAxis->GetNbins(), yEdges.data()));
+   }
+   else
+   {
+      buffers2D.emplace_back(new TH2D(name.c_str(), hist->GetTitle(),
+                                      xAxis->GetNbins(), xAxis->GetXmin(), xAxis->GetXmax(),
+                                      yAxis->GetNbins(), yAxis->GetXmin(), yAxis->GetXmax()));
+   }
+   isBuffer2DUsed.push_back(true);
+
+   buffers2D.back()->SetDirectory(nullptr);
+   PrepareBuffer(buffers2D.back().get(), hist, name);
+   buffers2D.back()->GetXaxis()->SetTitle(xAxis->GetTitle());
+   buffers2D.back()->GetYaxis()->SetTitle(yAxis->GetTitle());
+
+   return buffers2D.back().get();
+}
+
+HistogramArena::~HistogramArena() {};
+
+#endif /* HISTOGRAM_ARENA_CPP */
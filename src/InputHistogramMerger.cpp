@@ -0,0 +1,217 @@
+/**
+ *  @file   InputHistogramMerger.cpp
+ *  @brief  Contains realisation of class InputHistogramMerger
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef INPUT_HISTOGRAM_MERGER_CPP
+#define INPUT_HISTOGRAM_MERGER_CPP
+
+#include "../include/InputHistogramMerger.hpp"
+
+InputHistogramMerger::InputHistogramMerger() {};
+
+InputHistogramMerger::InputHistogramMerger(const std::string& inputPath)
+{
+   AddInput(inputPath);
+}
+
+void InputHistogramMerger::AddInput(const std::string& inputPath)
+{
+   if (!std::filesystem::exists(inputPath))
+   {
+      CppTools::PrintError("InputHistogramMerger: Input " + inputPath + " does not exist");
+   }
+
+   if (inputName != "") inputName += ", ";
+   inputName += inputPath;
+
+   if (std::filesystem::is_directory(inputPath))
+   {
+      for (const auto &file : std::filesystem::directory_iterator(inputPath))
+      {
+         if (file.path().extension() == ".root") inputFileNames.insert(file.path().string());
+      }
+   }
+   else if (std::filesystem::path(inputPath).extension() == ".root")
+   {
+      inputFileNames.insert(inputPath);
+   }
+   else
+   {
+      std::ifstream inputList(inputPath);
+      std::string fileName;
+
+      while (std::getline(inputList, fileName))
+      {
+         if (fileName == "" || fileName[0] == '#') continue;
+
+         if (!std::filesystem::exists(fileName))
+         {
+            CppTools::PrintError("InputHistogramMerger: File " + fileName +
+                                 " from list " + inputPath + " does not exist");
+         }
+         inputFileNames.insert(fileName);
+      }
+   }
+
+   if (inputFileNames.empty())
+   {
+      CppTools::PrintError("InputHistogramMerger: No .root files were found in " + inputPath);
+   }
+}
+
+void InputHistogramMerger::SetNumberOfThreads(const unsigned int numberOfThreads)
+{
+   if (numberOfThreads == 0)
+   {
+      CppTools::PrintError("InputHistogramMerger: Number of threads must be bigger than 0");
+   }
+   this->numberOfThreads = numberOfThreads;
+}
+
+void InputHistogramMerger::Merge(const std::vector<std::string>& histNames)
+{
+   // histograms that were already merged are not read again
+   std::vector<std::string> namesToMerge;
+   for (const std::string& histName : histNames)
+   {
+      if (mergedHists.find(histName) != mergedHists.end() ||
+          std::find(namesToMerge.begin(), namesToMerge.end(), histName) != namesToMerge.end())
+      {
+         continue;
+      }
+      namesToMerge.push_back(histName);
+   }
+
+   if (namesToMerge.empty()) return;
+
+   const unsigned long numberOfAccumulators =
+      CppTools::Minimum(static_cast<unsigned long>(numberOfThreads), inputFileNames.size());
+
+   // thread local accumulators; i-th set of accumulators sums files i, i + n, i + 2n, ...
+   std::vector<std::vector<std::unique_ptr<TH1>>> accumulators(numberOfAccumulators);
+   for (std::vector<std::unique_ptr<TH1>>& threadAccumulators : accumulators)
+   {
+      threadAccumulators.resize(namesToMerge.size());
+   }
+
+   if (numberOfAccumulators == 1) MergeFiles(namesToMerge, 0, 1, accumulators[0]);
+   else
+   {
+      ROOT::EnableThreadSafety();
+
+      std::vector<std::thread> thrCalls;
+      for (unsigned long i = 0; i < numberOfAccumulators; i++)
+      {
+         thrCalls.emplace_back(&InputHistogramMerger::MergeFiles, this, std::cref(namesToMerge),
+                               i, numberOfAccumulators, std::ref(accumulators[i]));
+      }
+      for (std::thread& thr : thrCalls) thr.join();
+
+      // pairwise summation of the accumulators; every step halves their number
+      for (unsigned long step = 1; step < numberOfAccumulators; step *= 2)
+      {
+         thrCalls.clear();
+         for (unsigned long i = 0; i + step < numberOfAccumulators; i += 2*step)
+         {
+            thrCalls.emplace_back([&accumulators, i, step]()
+            {
+               for (unsigned long j = 0; j < accumulators[i].size(); j++)
+               {
+                  if (!accumulators[i + step][j]) continue;
+                  if (!accumulators[i][j])
+                  {
+                     accumulators[i][j] = std::move(accumulators[i + step][j]);
+                  }
+                  else
+                  {
+                     accumulators[i][j]->Add(accumulators[i + step][j].get());
+                     accumulators[i + step][j].reset();
+                  }
+               }
+            });
+         }
+         for (std::thread& thr : thrCalls) thr.join();
+      }
+   }
+
+   // histograms that are absent in all files are stored as nullptr
+   // so that they are not searched again
+   for (unsigned long i = 0; i < namesToMerge.size(); i++)
+   {
+      mergedHists[namesToMerge[i]] = std::move(accumulators[0][i]);
+   }
+}
+
+TH1 *InputHistogramMerger::Get(const std::string& histName)
+{
+   auto mergedHist = mergedHists.find(histName);
+   if (mergedHist != mergedHists.end()) return mergedHist->second.get();
+
+   Merge({histName});
+   return mergedHists[histName].get();
+}
+
+void InputHistogramMerger::Release(const std::string& histName)
+{
+   mergedHists.erase(histName);
+}
+
+void InputHistogramMerger::Clear()
+{
+   mergedHists.clear();
+}
+
+void InputHistogramMerger::MergeFiles(const std::vector<std::string>& histNames,
+                                      const unsigned long firstFileIndex,
+                                      const unsigned long step,
+                                      std::vector<std::unique_ptr<TH1>>& accumulators) const
+{
+   auto fileName = inputFileNames.begin();
+   std::advance(fileName, firstFileIndex);
+
+   for (unsigned long i = firstFileIndex; i < inputFileNames.size(); i += step)
+   {
+      std::unique_ptr<TFile> inputFile(TFile::Open(fileName->c_str(), "READ"));
+
+      if (!inputFile || inputFile->IsZombie())
+      {
+         CppTools::PrintError("InputHistogramMerger: File " + *fileName + " cannot be opened");
+      }
+
+      // every file is opened once for all requested histograms
+      for (unsigned long j = 0; j < histNames.size(); j++)
+      {
+         TH1 *hist = static_cast<TH1 *>(inputFile->Get(histNames[j].c_str()));
+
+         if (!hist) continue;
+
+         if (!accumulators[j])
+         {
+            // the first histogram is detached from the file so that it is not deleted with it
+            accumulators[j].reset(static_cast<TH1 *>(hist->Clone()));
+            accumulators[j]->SetDirectory(nullptr);
+         }
+         else accumulators[j]->Add(hist);
+      }
+
+      if (i + step < inputFileNames.size()) std::advance(fileName, step);
+   }
+}
+
+unsigned long InputHistogramMerger::GetNumberOfFiles() const
+{
+   return inputFileNames.size();
+}
+
+std::string InputHistogramMerger::GetName() const
+{
+   return inputName;
+}
+
+InputHistogramMerger::~InputHistogramMerger() {};
+
+#endif /* INPUT_HISTOGRAM_MERGER_CPP */
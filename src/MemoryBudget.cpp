@@ -0,0 +1,199 @@
+/**
+ *  @file   MemoryBudget.cpp
+ *  @brief  Contains realisation of class MemoryBudget
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef MEMORY_BUDGET_CPP
+#define MEMORY_BUDGET_CPP
+
+#include "../include/MemoryBudget.hpp"
+
+MemoryBudget::MemoryBudget() {};
+
+MemoryBudget::MemoryBudget(const double budget, const double subprocessMemory)
+{
+   if (budget < 0.) CppTools::PrintError("MemoryBudget: Memory budget must not be negative");
+   if (subprocessMemory < 0.)
+   {
+      CppTools::PrintError("MemoryBudget: Expected memory of the subprocess must not be negative");
+   }
+
+   if (budget > 0.) this->budget = budget;
+   // the rest is left for the parent processes and the page cache
+   else this->budget = 0.9*GetMemoryLimit();
+
+   if (subprocessMemory > 0.) this->subprocessMemory = subprocessMemory;
+   else
+   {
+      this->subprocessMemory =
+         this->budget/static_cast<double>(CppTools::Maximum(std::thread::hardware_concurrency(), 1u));
+   }
+
+   // several objects of this class can exist in one process
+   reportDir = "tmp/MemoryBudget/" + std::to_string(getpid()) + "_" +
+               std::to_string(numberOfCreatedBudgets++) + "/";
+   std::filesystem::create_directories(reportDir);
+}
+
+long MemoryBudget::TryAdmit(const std::string& group)
+{
+   std::lock_guard<std::mutex> lock(subprocessesMutex);
+
+   bool isRunning = false;
+
+   // largest peak memory reported by the running subprocesses of every group
+   std::map<std::string, double> runningGroupPeakMemory;
+
+   for (Subprocess& subprocess : subprocesses)
+   {
+      if (!subprocess.isRunning) continue;
+
+      ReadReport(subprocess);
+
+      isRunning = true;
+      runningGroupPeakMemory[subprocess.group] =
+         CppTools::Maximum(runningGroupPeakMemory[subprocess.group], subprocess.peakMemory);
+   }
+
+   // peak memory reported by the running subprocess can still grow hence until one
+   // subprocess of the group has finished the default expected memory is used unless
+   // the running subprocesses of the group have already exceeded it
+   auto GetExpectedMemory = [&](const std::string& subprocessGroup)
+   {
+      if (groupPeakMemory.find(subprocessGroup) != groupPeakMemory.end())
+      {
+         return GetGroupPeakMemory(subprocessGroup);
+      }
+      return CppTools::Maximum(subprocessMemory, runningGroupPeakMemory[subprocessGroup]);
+   };
+
+   double expectedMemory = 0.;
+   for (const Subprocess& subprocess : subprocesses)
+   {
+      if (!subprocess.isRunning) continue;
+      expectedMemory += CppTools::Maximum(subprocess.peakMemory,
+                                          GetExpectedMemory(subprocess.group));
+   }
+
+   if (isRunning && expectedMemory + GetExpectedMemory(group) > budget) return -1;
+
+   subprocesses.push_back({group, reportDir + std::to_string(subprocesses.size())});
+   std::filesystem::remove(subprocesses.back().reportFileName);
+
+   return subprocesses.size() - 1;
+}
+
+unsigned long MemoryBudget::Admit(const std::string& group)
+{
+   long index;
+   while ((index = TryAdmit(group)) < 0) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+   return index;
+}
+
+std::string MemoryBudget::GetEnvironment(const unsigned long index) const
+{
+   std::lock_guard<std::mutex> lock(subprocessesMutex);
+   return "CALPHENIX_MEMORY_REPORT=" + subprocesses[index].reportFileName + " ";
+}
+
+void MemoryBudget::Release(const unsigned long index)
+{
+   std::lock_guard<std::mutex> lock(subprocessesMutex);
+
+   Subprocess& subprocess = subprocesses[index];
+
+   // the last report of the finished subprocess contains its final peak memory;
+   // subprocesses that did not report do not measure the group
+   ReadReport(subprocess);
+   if (subprocess.peakMemory > 0.)
+   {
+      groupPeakMemory[subprocess.group] =
+         CppTools::Maximum(GetGroupPeakMemory(subprocess.group), subprocess.peakMemory);
+   }
+
+   subprocess.isRunning = false;
+   std::filesystem::remove(subprocess.reportFileName);
+}
+
+double MemoryBudget::GetBudget() const
+{
+   return budget;
+}
+
+double MemoryBudget::GetMemoryLimit()
+{
+   // memory limit [B]; total memory is written in kB
+   double memoryLimit = 0.;
+
+   std::ifstream meminfoFile("/proc/meminfo");
+   std::string field;
+   while (meminfoFile >> field)
+   {
+      if (field == "MemTotal:")
+      {
+         meminfoFile >> memoryLimit;
+         break;
+      }
+   }
+   memoryLimit *= 1024.;
+
+   // cgroup v2 of the process (e.g. from the batch system) and the root one in containers
+   std::vector<std::string> limitFileNames;
+
+   std::ifstream cgroupFile("/proc/self/cgroup");
+   std::string line;
+   while (std::getline(cgroupFile, line))
+   {
+      if (line.substr(0, 3) == "0::")
+      {
+         limitFileNames.push_back("/sys/fs/cgroup" + line.substr(3) + "/memory.max");
+      }
+   }
+   limitFileNames.push_back("/sys/fs/cgroup/memory.max");
+   // cgroup v1
+   limitFileNames.push_back("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+
+   for (const std::string& limitFileName : limitFileNames)
+   {
+      std::ifstream limitFile(limitFileName);
+      double limit;
+
+      // "max" is written if there is no limit
+      if (limitFile >> limit && limit > 0.) memoryLimit = CppTools::Minimum(memoryLimit, limit);
+   }
+
+   if (memoryLimit == 0.) CppTools::PrintError("MemoryBudget: Unable to determine the memory limit");
+
+   return memoryLimit/1024./1024.;
+}
+
+void MemoryBudget::ReadReport(Subprocess& subprocess)
+{
+   std::ifstream reportFile(subprocess.reportFileName);
+
+   double currentMemory, peakMemory;
+   if (!(reportFile >> currentMemory >> peakMemory)) return;
+
+   subprocess.peakMemory = CppTools::Maximum(subprocess.peakMemory, peakMemory);
+}
+
+double MemoryBudget::GetGroupPeakMemory(const std::string& group) const
+{
+   auto groupPeak = groupPeakMemory.find(group);
+   if (groupPeak == groupPeakMemory.end()) return 0.;
+   return groupPeak->second;
+}
+
+MemoryBudget::~MemoryBudget()
+{
+   if (!reportDir.empty())
+   {
+      std::error_code errorCode;
+      std::filesystem::remove_all(reportDir, errorCode);
+   }
+};
+
+#endif /* MEMORY_BUDGET_CPP */
@@ -0,0 +1,85 @@
+/**
+ *  @file   MemoryUsageReporter.cpp
+ *  @brief  Contains realisation of class MemoryUsageReporter
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef MEMORY_USAGE_REPORTER_CPP
+#define MEMORY_USAGE_REPORTER_CPP
+
+#include "../include/MemoryUsageReporter.hpp"
+
+MemoryUsageReporter::MemoryUsageReporter()
+{
+   const char *environmentReportFileName = getenv(environmentVariableName.c_str());
+   if (!environmentReportFileName) return;
+
+   reportFileName = environmentReportFileName;
+
+   reportThread = std::thread([this]()
+   {
+      while (!isStopped)
+      {
+         WriteReport();
+         std::this_thread::sleep_for(reportInterval);
+      }
+   });
+}
+
+bool MemoryUsageReporter::ReadMemoryUsage(double& currentMemory, double& peakMemory)
+{
+   std::ifstream statusFile("/proc/self/status");
+
+   bool isCurrentMemoryRead = false, isPeakMemoryRead = false;
+
+   std::string line;
+   while (std::getline(statusFile, line))
+   {
+      std::istringstream lineStream(line);
+      std::string field;
+      double value;
+
+      lineStream >> field >> value;
+
+      // values are in kB
+      if (field == "VmRSS:")
+      {
+         currentMemory = value/1024.;
+         isCurrentMemoryRead = true;
+      }
+      else if (field == "VmHWM:")
+      {
+         peakMemory = value/1024.;
+         isPeakMemoryRead = true;
+      }
+   }
+
+   return isCurrentMemoryRead && isPeakMemoryRead;
+}
+
+void MemoryUsageReporter::WriteReport() const
+{
+   double currentMemory, peakMemory;
+   if (!ReadMemoryUsage(currentMemory, peakMemory)) return;
+
+   const std::string temporaryFileName = reportFileName + ".tmp";
+   {
+      std::ofstream reportFile(temporaryFileName);
+      reportFile << currentMemory << " " << peakMemory << std::endl;
+   }
+   std::error_code errorCode;
+   std::filesystem::rename(temporaryFileName, reportFileName, errorCode);
+}
+
+MemoryUsageReporter::~MemoryUsageReporter()
+{
+   if (!reportThread.joinable()) return;
+
+   isStopped = true;
+   reportThread.join();
+   WriteReport();
+};
+
+#endif /* MEMORY_USAGE_REPORTER_CPP */
@@ -0,0 +1,292 @@
+/**
+ *  @file   Pipeline.cpp
+ *  @brief  Contains realisation of the program that runs the stages of EMCal timing and sigmalized residuals calibrations split into units of single sectors and detectors
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef PIPELINE_CPP
+#define PIPELINE_CPP
+
+#include <string>
+#include <vector>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "ErrorHandler.hpp"
+#include "IOTools.hpp"
+
+#include "InputYAMLReader.hpp"
+#include "PipelineScheduler.hpp"
+
+// Every stage is split into units that are run by the programs of the stages in Mode2 (one sector
+// for tower offsets and one detector and variable for sigmalized residuals) or in Mode1 (run by 
+// run programs which split the runs between their own subprocesses); a unit is started as soon 
+// as the units it depends on from the previous requested stages are finished and all units and 
+// their subprocesses share the same number of threads passed to this program
+int main(int argc, char **argv)
+{
+   // stages in the order of the calibrations
+   const std::vector<std::string> stages =
+   {
+      "tower-mask", "tower-offset", "run-offset", "check-emc-timing",
+      "residuals-histograms", "sigmalized-residuals", "check-sigmalized-residuals"
+   };
+
+   if (argc < 3 || argc > 5)
+   {
+      std::string errMsg = "Expected 2-4 parameters while " + std::to_string(argc - 1) +
+                           " parameter(s) were provided \n";
+      errMsg += "Usage: bin/Pipeline inputDir stages numberOfThreads=" +
+                std::to_string(std::thread::hardware_concurrency()) + "* memoryBudget=0**\n";
+      errMsg += "inputDir: directory with emc_timing.yaml and sigmalized_residuals.yaml "
+                "(e.g. input/Run14HeAu200)\n";
+      errMsg += "stages: comma separated list of ";
+      for (const std::string& stage : stages) errMsg += stage + ", ";
+      errMsg += "or all (e.g. tower-offset,check-emc-timing)\n";
+      errMsg += "*: default argument is the number of threads on the current machine \n";
+      errMsg += "**: memory [MB] shared by all units; 0 for 90% of the cgroup memory limit "
+                "(or of the total memory if there is no limit)\n";
+      CppTools::PrintError(errMsg);
+   }
+
+   unsigned int numberOfThreads;
+   if (argc > 3) numberOfThreads = std::stoi(argv[3]);
+   else numberOfThreads = std::thread::hardware_concurrency();
+   if (numberOfThreads == 0) CppTools::PrintError("Number of threads must be bigger than 0");
+
+   const double memoryBudget = (argc > 4) ? std::stod(argv[4]) : 0.;
+
+   std::set<std::string> requestedStages;
+   bool isAllRequested = false;
+
+   std::istringstream stagesStream(argv[2]);
+   std::string requestedStage;
+   while (std::getline(stagesStream, requestedStage, ','))
+   {
+      if (requestedStage == "all")
+      {
+         for (const std::string& stage : stages) requestedStages.insert(stage);
+         isAllRequested = true;
+         continue;
+      }
+
+      bool isStageFound = false;
+      for (const std::string& stage : stages)
+      {
+         if (stage == requestedStage) isStageFound = true;
+      }
+      if (!isStageFound) CppTools::PrintError("Unknown stage \"" + requestedStage + "\"");
+
+      requestedStages.insert(requestedStage);
+   }
+
+   if (requestedStages.empty()) CppTools::PrintError("No stages were specified");
+
+   const std::string inputDir = argv[1];
+
+   PipelineScheduler scheduler;
+
+   if (requestedStages.count("tower-mask") || requestedStages.count("tower-offset") ||
+       requestedStages.count("run-offset") || requestedStages.count("check-emc-timing"))
+   {
+      InputYAMLReader inputYAMLCal(inputDir, "emc_timing");
+      inputYAMLCal.CheckStatus("emc_timing");
+
+      const unsigned int numberOfSectors = inputYAMLCal["sectors_to_calibrate"].size();
+      if (numberOfSectors == 0) CppTools::PrintError("No sectors were specified for calibrations");
+
+      // run by run offset approximates the same tcorr projections of the same se-<run>.root files 
+      // and writes the same outputs as the check (tcorr_fits trees and canvases) together with 
+      // the parameters; hence when both are requested the data is read only once
+      if (requestedStages.count("run-offset") && requestedStages.count("check-emc-timing"))
+      {
+         requestedStages.erase("check-emc-timing");
+         CppTools::PrintInfo("Stage check-emc-timing is performed within stage run-offset");
+      }
+
+      // same split of threads as in Mode1 of EMCTTowerOffset when all sectors start at once
+      const unsigned int sectorMaxNumberOfThreads =
+         CppTools::Maximum(numberOfThreads/numberOfSectors, 1u);
+
+      // tower mask is a single pass over all sectors that is needed by every sector
+      std::vector<unsigned long> previousUnits;
+      if (requestedStages.count("tower-mask"))
+      {
+         previousUnits.push_back(scheduler.AddUnit("tower-mask", "tower-mask",
+                                                   [=](const unsigned int)
+                                                   {return "./bin/EMCTTowerMask " + inputDir;}, 1));
+      }
+
+      // towers of every sector are calibrated by a separate unit the same way as in 
+      // Mode1 of EMCTTowerOffset
+      if (requestedStages.count("tower-offset"))
+      {
+         std::vector<unsigned long> towerOffsetUnits;
+         for (unsigned int sectorBin = 0; sectorBin < numberOfSectors; sectorBin++)
+         {
+            const std::string sectorName =
+               inputYAMLCal["sectors_to_calibrate"][sectorBin]["name"].as<std::string>();
+
+            auto Command = [=](const unsigned int unitNumberOfThreads)
+            {
+               return "./bin/EMCTTowerOffset " + inputDir + " " + std::to_string(sectorBin) + " " +
+                      std::to_string(unitNumberOfThreads) + " 0";
+            };
+
+            towerOffsetUnits.push_back(scheduler.AddUnit("tower-offset: " + sectorName, 
+                                                         "tower-offset", Command, 
+                                                         sectorMaxNumberOfThreads, previousUnits));
+         }
+         previousUnits = towerOffsetUnits;
+      }
+
+      if (requestedStages.count("run-offset") && 
+          inputYAMLCal["run_by_run_watch"]["enable"].as<bool>())
+      {
+         CppTools::PrintError("Stage run-offset can not be run by Pipeline in watch mode since "
+                              "it does not exit; run bin/EMCTRunByRunOffset separately");
+      }
+
+      // fits of the runs are sequential within a process hence the run by run programs are run 
+      // in Mode1 in which every se-<run>.root file is read once for all sectors and the chunks 
+      // of runs are processed by the subprocesses; the unit itself only waits for its 
+      // subprocesses so it takes no threads (its subprocesses would otherwise wait for the 
+      // thread held by it) while the subprocesses take the threads from the pool shared with 
+      // the other units (see ThreadTokenPool); the subprocesses are admitted by the memory 
+      // budget of the program (memory_budget in emc_timing.yaml)
+      for (const auto& [stage, programName] : std::vector<std::pair<std::string, std::string>>
+           {{"run-offset", "EMCTRunByRunOffset"}, {"check-emc-timing", "CheckEMCTiming"}})
+      {
+         if (!requestedStages.count(stage)) continue;
+
+         const std::string program = programName;
+         previousUnits = {scheduler.AddUnit(stage, stage, [=](const unsigned int)
+                                            {
+                                               return "./bin/" + program + " " + inputDir + " " +
+                                                      std::to_string(numberOfThreads);
+                                            }, 0, previousUnits)};
+      }
+   }
+
+   if (requestedStages.count("residuals-histograms") ||
+       requestedStages.count("sigmalized-residuals") ||
+       requestedStages.count("check-sigmalized-residuals"))
+   {
+      InputYAMLReader inputYAMLCal(inputDir, "sigmalized_residuals");
+      inputYAMLCal.CheckStatus("sigmalized_residuals");
+
+      const unsigned int numberOfDetectors = inputYAMLCal["detectors_to_calibrate"].size();
+      if (numberOfDetectors == 0) CppTools::PrintError("No detectors are specified for calibrations");
+
+      // distributions are filled from track trees only if they are specified
+      if (isAllRequested &&
+          inputYAMLCal["residuals_histograms"]["input_trees"].as<std::string>() == "")
+      {
+         requestedStages.erase("residuals-histograms");
+      }
+
+      // distributions from the trees are not written in sum.root hence
+      // the calibrations read them only from input_partial_files
+      if (requestedStages.count("residuals-histograms") &&
+          (requestedStages.count("sigmalized-residuals") ||
+           requestedStages.count("check-sigmalized-residuals")) &&
+          inputYAMLCal["input_partial_files"].as<std::string>() == "")
+      {
+         CppTools::PrintWarning("input_partial_files is empty in sigmalized_residuals.yaml; "
+                                "calibrations will read sum.root instead of the distributions "
+                                "filled by residuals-histograms (see output_file in "
+                                "residuals_histograms)");
+      }
+
+      // all detectors are filled in one pass over the trees which uses all threads
+      auto AddHistogramsUnit = [&](const std::string& name,
+                                   const std::vector<unsigned long>& dependencies)
+      {
+         return scheduler.AddUnit(name, "residuals-histograms",
+                                  [=](const unsigned int unitNumberOfThreads)
+                                  {
+                                     return "./bin/SigmalizedResidualsHistograms " + inputDir +
+                                            " " + std::to_string(unitNumberOfThreads);
+                                  }, numberOfThreads, dependencies);
+      };
+
+      std::vector<unsigned long> histogramsUnit;
+      if (requestedStages.count("residuals-histograms"))
+      {
+         histogramsUnit.push_back(AddHistogramsUnit("residuals-histograms", {}));
+      }
+
+      auto AddResidualsUnit = [&](const std::string& stage, const std::string& program,
+                                  const unsigned int detectorBin,
+                                  const unsigned int variableBin,
+                                  const std::vector<unsigned long>& dependencies)
+      {
+         const std::string name =
+            inputYAMLCal["detectors_to_calibrate"][detectorBin]["name"].as<std::string>() +
+            (variableBin == 0 ? " dphi" : " dz");
+
+         // same as in Mode1 of the programs each variable of each detector is processed in 1 thread
+         return scheduler.AddUnit(stage + ": " + name, stage, [=](const unsigned int)
+                                  {
+                                     return "./bin/" + program + " " + inputDir + " " +
+                                            std::to_string(detectorBin) + " " +
+                                            std::to_string(variableBin) + " 1 0";
+                                  }, 1, dependencies);
+      };
+
+      // indices of the last units of every detector and variable
+      std::vector<std::vector<unsigned long>> residualsUnits(2*numberOfDetectors, histogramsUnit);
+
+      if (requestedStages.count("sigmalized-residuals"))
+      {
+         for (unsigned int detectorBin = 0; detectorBin < numberOfDetectors; detectorBin++)
+         {
+            for (unsigned int variableBin = 0; variableBin < 2; variableBin++)
+            {
+               residualsUnits[2*detectorBin + variableBin] =
+                  {AddResidualsUnit("sigmalized-residuals", "SigmalizedResiduals",
+                                    detectorBin, variableBin, residualsUnits[2*detectorBin + variableBin])};
+            }
+         }
+
+         // sdphi and sdz distributions can only be filled with the parameters of all detectors
+         // hence the checks wait for the second pass over the trees
+         if (!histogramsUnit.empty() && requestedStages.count("check-sigmalized-residuals"))
+         {
+            std::vector<unsigned long> allResidualsUnits;
+            for (const std::vector<unsigned long>& units : residualsUnits)
+            {
+               allResidualsUnits.insert(allResidualsUnits.end(), units.begin(), units.end());
+            }
+
+            const unsigned long sigmalizedHistogramsUnit =
+               AddHistogramsUnit("residuals-histograms (sigmalized)", allResidualsUnits);
+            for (std::vector<unsigned long>& units : residualsUnits) units = {sigmalizedHistogramsUnit};
+         }
+      }
+
+      if (requestedStages.count("check-sigmalized-residuals"))
+      {
+         for (unsigned int detectorBin = 0; detectorBin < numberOfDetectors; detectorBin++)
+         {
+            for (unsigned int variableBin = 0; variableBin < 2; variableBin++)
+            {
+               AddResidualsUnit("check-sigmalized-residuals", "CheckSigmalizedResiduals",
+                                detectorBin, variableBin, residualsUnits[2*detectorBin + variableBin]);
+            }
+         }
+      }
+   }
+
+   CppTools::PrintInfo("Running " + std::to_string(scheduler.GetNumberOfUnits()) +
+                       " units on " + std::to_string(numberOfThreads) + " thread(s)");
+
+   if (!scheduler.Run(numberOfThreads, memoryBudget)) CppTools::PrintError("Some of the units failed");
+
+   return 0;
+}
+
+#endif /* PIPELINE_CPP */
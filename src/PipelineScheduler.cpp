@@ -0,0 +1,167 @@
+/**
+ *  @file   PipelineScheduler.cpp
+ *  @brief  Contains realisation of class PipelineScheduler
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef PIPELINE_SCHEDULER_CPP
+#define PIPELINE_SCHEDULER_CPP
+
+#include "../include/PipelineScheduler.hpp"
+
+PipelineScheduler::PipelineScheduler() {};
+
+unsigned long PipelineScheduler::AddUnit(const std::string& name, const std::string& group,
+                                         const std::function<std::string(const unsigned int)>& command,
+                                         const unsigned int maxNumberOfThreads,
+                                         const std::vector<unsigned long>& dependencies)
+{
+   // dependencies on the previous units only guarantee that there are no cycles
+   for (const unsigned long dependency : dependencies)
+   {
+      if (dependency >= units.size())
+      {
+         CppTools::PrintError("PipelineScheduler: Unit " + name +
+                              " depends on the unit that was not added yet");
+      }
+   }
+
+   units.push_back({name, group, command, maxNumberOfThreads, dependencies});
+   return units.size() - 1;
+}
+
+bool PipelineScheduler::Run(const unsigned int numberOfThreads, const double memoryBudget)
+{
+   if (numberOfThreads == 0) CppTools::PrintError("PipelineScheduler: Number of threads must be bigger than 0");
+
+   std::mutex unitsMutex;
+   std::condition_variable unitFinished;
+
+   // threads are shared with other programs run by the same parent process if there is one
+   ThreadTokenPool threadTokenPool(numberOfThreads);
+   MemoryBudget unitsMemoryBudget(memoryBudget);
+
+   unsigned long numberOfFinishedUnits = 0;
+
+   std::vector<std::thread> thrCalls;
+
+   std::unique_lock<std::mutex> lock(unitsMutex);
+
+   while (numberOfFinishedUnits < units.size())
+   {
+      bool isPoolEmpty = false;
+
+      // dependencies are always earlier units so one pass is enough to propagate the skips
+      for (unsigned long i = 0; i < units.size(); i++)
+      {
+         Unit& unit = units[i];
+         if (unit.status != UnitStatus::WAITING) continue;
+
+         bool isReady = true, isBlocked = false;
+         for (const unsigned long dependency : unit.dependencies)
+         {
+            if (units[dependency].status == UnitStatus::FAILED ||
+                units[dependency].status == UnitStatus::SKIPPED) isBlocked = true;
+            else if (units[dependency].status != UnitStatus::SUCCEEDED) isReady = false;
+         }
+
+         if (isBlocked)
+         {
+            unit.status = UnitStatus::SKIPPED;
+            numberOfFinishedUnits++;
+            CppTools::PrintWarning("Unit " + unit.name + " is skipped since its dependencies failed");
+            continue;
+         }
+
+         if (!isReady) continue;
+
+         // units without threads only wait for their subprocesses that take the threads
+         // from the same pool themselves hence they are started even if the pool is empty
+         unsigned int unitNumberOfThreads = 0;
+         if (unit.maxNumberOfThreads > 0)
+         {
+            if (isPoolEmpty) continue;
+
+            unitNumberOfThreads = threadTokenPool.TryAcquire(unit.maxNumberOfThreads);
+            if (unitNumberOfThreads == 0)
+            {
+               isPoolEmpty = true;
+               continue;
+            }
+         }
+
+         // units of the other groups may still fit in the memory budget
+         const long memoryBudgetIndex = unitsMemoryBudget.TryAdmit(unit.group);
+         if (memoryBudgetIndex < 0)
+         {
+            threadTokenPool.Release(unitNumberOfThreads);
+            continue;
+         }
+
+         unit.status = UnitStatus::RUNNING;
+         if (unitNumberOfThreads > 0)
+         {
+            CppTools::PrintInfo("Starting unit " + unit.name + " on " +
+                                std::to_string(unitNumberOfThreads) + " thread(s)");
+         }
+         else CppTools::PrintInfo("Starting unit " + unit.name + " on the threads of the pool");
+
+         const std::string command = unitsMemoryBudget.GetEnvironment(memoryBudgetIndex) +
+                                     unit.command(unitNumberOfThreads);
+
+         thrCalls.emplace_back([&, i, command, unitNumberOfThreads, memoryBudgetIndex]()
+         {
+            const auto startTime = std::chrono::steady_clock::now();
+            const int exitCode = system(command.c_str());
+
+            std::lock_guard<std::mutex> guard(unitsMutex);
+
+            units[i].status = (exitCode == 0) ? UnitStatus::SUCCEEDED : UnitStatus::FAILED;
+            units[i].time =
+               std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+            if (exitCode == 0)
+            {
+               CppTools::PrintInfo("Unit " + units[i].name + " finished in " +
+                                   CppTools::DtoStr(units[i].time, 1) + " s");
+            }
+            else CppTools::PrintWarning("Unit " + units[i].name + " failed");
+
+            unitsMemoryBudget.Release(memoryBudgetIndex);
+            threadTokenPool.Release(unitNumberOfThreads);
+            numberOfFinishedUnits++;
+            unitFinished.notify_one();
+         });
+      }
+
+      if (numberOfFinishedUnits == units.size()) break;
+
+      // tokens can also be returned by the other processes sharing the pool and the reported
+      // memory changes hence the ready units are checked periodically even if no unit finished
+      const unsigned long previousNumberOfFinishedUnits = numberOfFinishedUnits;
+      unitFinished.wait_for(lock, std::chrono::milliseconds(100), [&]()
+                            {return numberOfFinishedUnits != previousNumberOfFinishedUnits;});
+   }
+
+   lock.unlock();
+   for (std::thread& thr : thrCalls) thr.join();
+
+   bool isSucceeded = true;
+   for (const Unit& unit : units)
+   {
+      if (unit.status != UnitStatus::SUCCEEDED) isSucceeded = false;
+   }
+
+   return isSucceeded;
+}
+
+unsigned long PipelineScheduler::GetNumberOfUnits() const
+{
+   return units.size();
+}
+
+PipelineScheduler::~PipelineScheduler() {};
+
+#endif /* PIPELINE_SCHEDULER_CPP */
@@ -0,0 +1,186 @@
+/**
+ *  @file   RobustPeakEstimator.cpp
+ *  @brief  Contains realisation of class RobustPeakEstimator
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef ROBUST_PEAK_ESTIMATOR_CPP
+#define ROBUST_PEAK_ESTIMATOR_CPP
+
+#include "../include/RobustPeakEstimator.hpp"
+
+RobustPeakEstimator::RobustPeakEstimator() {};
+
+RobustPeakEstimator::RobustPeakEstimator(const double nSigma,
+                                         const unsigned int maxNumberOfIterations,
+                                         const double minSignalFraction)
+{
+   if (nSigma <= 0.) CppTools::PrintError("RobustPeakEstimator: nSigma must be positive");
+   if (maxNumberOfIterations == 0)
+   {
+      CppTools::PrintError("RobustPeakEstimator: Maximum number of iterations must be bigger than 0");
+   }
+
+   this->nSigma = nSigma;
+   this->maxNumberOfIterations = maxNumberOfIterations;
+   this->minSignalFraction = minSignalFraction;
+}
+
+bool RobustPeakEstimator::Estimate(const TH1 *hist, const double xMin, const double xMax)
+{
+   const TAxis *axis = hist->GetXaxis();
+
+   const int firstBin = CppTools::Maximum(1, axis->FindBin(xMin));
+   const int lastBin = CppTools::Minimum(axis->FindBin(xMax), axis->GetNbins());
+
+   numberOfIterations = 0;
+   signalFraction = 0.;
+   signalEntries = 0.;
+
+   if (lastBin - firstBin + 1 < minNumberOfBins) return false;
+
+   // first iteration starts from the maximum bin with the RMS of the whole range
+   int maxBin = firstBin;
+   double sumW = 0., sumWX = 0., sumWXX = 0.;
+   for (int i = firstBin; i <= lastBin; i++)
+   {
+      const double content = hist->GetBinContent(i);
+      if (content > hist->GetBinContent(maxBin)) maxBin = i;
+
+      const double x = axis->GetBinCenter(i);
+      sumW += content;
+      sumWX += content*x;
+      sumWXX += content*x*x;
+   }
+
+   if (sumW <= 0.) return false;
+
+   mean = axis->GetBinCenter(maxBin);
+   sigma = sqrt(CppTools::Maximum(sumWXX/sumW - sumWX*sumWX/sumW/sumW, 0.));
+
+   // ratio of RMS of the gaussian truncated at ±nSigma to its sigma
+   const double truncatedRMSScale =
+      sqrt(1. - 2.*nSigma*exp(-nSigma*nSigma/2.)/sqrt(2.*M_PI)/erf(nSigma/sqrt(2.)));
+
+   bool isConverged = false;
+   int numberOfWindowBins = 0;
+
+   while (!isConverged && numberOfIterations < maxNumberOfIterations && sigma > 0.)
+   {
+      numberOfIterations++;
+
+      const double windowMin = mean - nSigma*sigma;
+      const double windowMax = mean + nSigma*sigma;
+
+      // background is the linear interpolation between the average contents of the sidebands
+      double leftSum = 0., leftX = 0., rightSum = 0., rightX = 0.;
+      int leftNBins = 0, rightNBins = 0;
+
+      for (int i = firstBin; i <= lastBin; i++)
+      {
+         const double x = axis->GetBinCenter(i);
+         if (x < windowMin && x >= windowMin - nSigma*sigma)
+         {
+            leftSum += hist->GetBinContent(i);
+            leftX += x;
+            leftNBins++;
+         }
+         else if (x > windowMax && x <= windowMax + nSigma*sigma)
+         {
+            rightSum += hist->GetBinContent(i);
+            rightX += x;
+            rightNBins++;
+         }
+      }
+
+      auto Background = [&](const double x)
+      {
+         if (leftNBins > 0 && rightNBins > 0)
+         {
+            const double leftAverageX = leftX/leftNBins, rightAverageX = rightX/rightNBins;
+            const double leftAverage = leftSum/leftNBins, rightAverage = rightSum/rightNBins;
+            return leftAverage + (rightAverage - leftAverage)*
+                                 (x - leftAverageX)/(rightAverageX - leftAverageX);
+         }
+         if (leftNBins > 0) return leftSum/leftNBins;
+         if (rightNBins > 0) return rightSum/rightNBins;
+         return 0.;
+      };
+
+      double sumContent = 0.;
+      sumW = 0.;
+      sumWX = 0.;
+      sumWXX = 0.;
+      numberOfWindowBins = 0;
+
+      for (int i = firstBin; i <= lastBin; i++)
+      {
+         const double x = axis->GetBinCenter(i);
+         if (x < windowMin || x > windowMax) continue;
+
+         const double content = hist->GetBinContent(i);
+         const double w = CppTools::Maximum(content - Background(x), 0.);
+
+         sumContent += content;
+         sumW += w;
+         sumWX += w*x;
+         sumWXX += w*x*x;
+         numberOfWindowBins++;
+      }
+
+      if (sumW <= 0.) return false;
+
+      const double newMean = sumWX/sumW;
+      const double newSigma =
+         sqrt(CppTools::Maximum(sumWXX/sumW - newMean*newMean, 0.))/truncatedRMSScale;
+
+      isConverged = (fabs(newMean - mean) < tolerance*sigma &&
+                     fabs(newSigma - sigma) < tolerance*sigma);
+
+      mean = newMean;
+      sigma = newSigma;
+      signalFraction = sumW/sumContent;
+      signalEntries = sumW;
+   }
+
+   return isConverged && sigma > 0. && numberOfWindowBins >= minNumberOfBins &&
+          signalFraction >= minSignalFraction;
+}
+
+double RobustPeakEstimator::GetMean() const
+{
+   return mean;
+}
+
+double RobustPeakEstimator::GetSigma() const
+{
+   return sigma;
+}
+
+double RobustPeakEstimator::GetMeanError() const
+{
+   if (signalEntries <= 0.) return 0.;
+   return sigma/sqrt(signalEntries);
+}
+
+double RobustPeakEstimator::GetSigmaError() const
+{
+   if (signalEntries <= 0.) return 0.;
+   return sigma/sqrt(2.*signalEntries);
+}
+
+double RobustPeakEstimator::GetSignalFraction() const
+{
+   return signalFraction;
+}
+
+unsigned int RobustPeakEstimator::GetNumberOfIterations() const
+{
+   return numberOfIterations;
+}
+
+RobustPeakEstimator::~RobustPeakEstimator() {};
+
+#endif /* ROBUST_PEAK_ESTIMATOR_CPP */
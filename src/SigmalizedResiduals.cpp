@@ -75,14 +75,27 @@ int main(int argc, char **argv)
                            inputYAMLCal["centrality_bins"].size()*
                            inputYAMLCal["zdc_bins"].size()*4;
 
+      ThreadTokenPool threadTokenPool(numberOfThreads);
+      // subprocesses are started only while their memory fits in the budget
+      MemoryBudget memoryBudget(inputYAMLCal["memory_budget"].as<double>());
+
       auto SingleThreadCall = [&](const unsigned long detectorBin, 
                                   const unsigned long variableBin)
       {
+         // every subprocess fits in 1 thread taken from the pool shared by all subprocesses
+         // subprocess waits for the memory before taking the thread so that the threads 
+         // are not held by the subprocesses that can not be started yet
+         const unsigned long memoryBudgetIndex = memoryBudget.Admit("SigmalizedResiduals");
+         threadTokenPool.Acquire();
+
          // man ROOT sucks (TF1::Fit is still not thread safe) so I have to call the same program 
          // recursively in shell outside of the current instance to implement multithreading
-         system((static_cast<std::string>("./bin/SigmalizedResiduals ") + 
+         system((memoryBudget.GetEnvironment(memoryBudgetIndex) + "./bin/SigmalizedResiduals " + 
                  argv[1] + " " + std::to_string(detectorBin) + " " + 
                  std::to_string(variableBin) + " 1 0").c_str());;
+
+         memoryBudget.Release(memoryBudgetIndex);
+         threadTokenPool.Release();
       };
 
       std::vector<std::thread> thrCalls;
@@ -93,16 +106,8 @@ int main(int argc, char **argv)
       {
          for (unsigned long variableBin = 0; variableBin < variableName.size(); variableBin++)
          { 
-               if (thrCalls.size() >= numberOfThreads)
-               {
-                  while (!thrCalls.empty())
-                  {
-                     thrCalls.back().join();
-                     thrCalls.pop_back();
-                  }
-               }
-               thrCalls.emplace_back(SingleThreadCall, detectorBin, variableBin);
-            }
+            thrCalls.emplace_back(SingleThreadCall, detectorBin, variableBin);
+         }
       }
 
       while (!thrCalls.empty())
@@ -117,6 +122,10 @@ int main(int argc, char **argv)
    else // Mode2
    {
       programMode = 2;
+
+      // memory usage is reported to the parent process if it requested it
+      MemoryUsageReporter memoryUsageReporter;
+
       if (argc > 4) numberOfThreads = std::stoi(argv[4]);
       else numberOfThreads = std::thread::hardware_concurrency();
       if (numberOfThreads == 0) CppTools::PrintError("Number of threads must be bigger than 0");
@@ -128,9 +137,13 @@ int main(int argc, char **argv)
       outputDir = "output/SigmalizedResiduals/" + runName + "/";
       system(("mkdir -p " + outputDir + "CalibrationParameters").c_str());
 
-      inputFile = 
-         std::unique_ptr<TFile>(TFile::Open(("data/SigmalizedResiduals/" + runName + 
-                                             "/sum.root").c_str(), "READ"));
+      // partial input files are merged in memory instead of reading the output of hadd
+      if (inputYAMLCal["input_partial_files"].as<std::string>() != "")
+      {
+         inputHistograms.AddInput(inputYAMLCal["input_partial_files"].as<std::string>());
+      }
+      else inputHistograms.AddInput("data/SigmalizedResiduals/" + runName + "/sum.root");
+      inputHistograms.SetNumberOfThreads(numberOfThreads);
 
       pTRangeTLatex.SetTextFont(52);
       pTRangeTLatex.SetTextSize(0.06);
@@ -178,6 +191,27 @@ int main(int argc, char **argv)
                                     ["max"].as<double>();
 
       fitNTries = inputYAMLCal["number_of_fit_tries"].as<unsigned int>();
+      dValFitLadder = FitStrategyLadder("dphi and dz fits", inputYAMLCal["fit_strategy"]["dval"]);
+
+      const std::string uncertaintyMode = inputYAMLCal["uncertainty_mode"].as<std::string>();
+      if (uncertaintyMode != "fast" && uncertaintyMode != "full")
+      {
+         CppTools::PrintError("Unknown uncertainty_mode \"" + uncertaintyMode + 
+                              "\"; expected \"fast\" or \"full\"");
+      }
+      isUncertaintyFastMode = (uncertaintyMode == "fast");
+
+      // same ranges as the ranges of the alternative fits in full mode
+      std::vector<std::pair<double, double>> rangeSystematicsWindows;
+      for (unsigned int i = 1; i <= 4; i++)
+      {
+         rangeSystematicsWindows.push_back({-2.*static_cast<double>(i), 2.*static_cast<double>(i)});
+         rangeSystematicsWindows.push_back({-1., 2.*static_cast<double>(i)});
+         rangeSystematicsWindows.push_back({-2.*static_cast<double>(i), 1.});
+      }
+      rangeSystematics = FitRangeSystematics(rangeSystematicsWindows);
+
+      coarseToFineFit = CoarseToFineFit(inputYAMLCal["coarse_to_fine_fit"]);
 
       std::thread pBarThr(PBarCall); 
  
@@ -185,6 +219,13 @@ int main(int argc, char **argv)
 
       isProcessFinished = true;
       pBarThr.join();
+
+      dValFitLadder.WriteStatistics(outputDir + inputYAMLCal["detectors_to_calibrate"]
+                                                            [std::stoi(argv[2])]["name"].
+                                                            as<std::string>() + 
+                                    "/fit_strategy_" + variableName[std::stoi(argv[3])] + 
+                                    ".txt");
+      if (showProgress) dValFitLadder.PrintStatistics();
    }
 
    if (showProgress) CppTools::PrintInfo("SigmalizedResiduals has finished running succesfully");
@@ -231,6 +272,18 @@ void SigmalizedResiduals::PerformFitsForDifferentCentrAndZDC(const unsigned int
       parametersOutput << numberOfParametersFitMeans << " " << 
                           numberOfParametersFitSigmas << std::endl;
 
+      // histograms of all zDC bins are used in every centrality bin hence 
+      // they are merged together in a single pass over the input files
+      std::vector<std::string> distrVariableNames;
+      for (const YAML::Node& zDC : inputYAMLCal["zdc_bins"])
+      {
+         distrVariableNames.push_back(variableName[variableBin] + " vs pT vs centrality: " + 
+                                      detectorName + ", " + chargeName + ", " + 
+                                      zDC["min"].as<std::string>() + "<zDC<" + 
+                                      zDC["max"].as<std::string>());
+      }
+      inputHistograms.Merge(distrVariableNames);
+
       for (unsigned int centralityBin = 0; centralityBin < 
            inputYAMLCal["centrality_bins"].size(); centralityBin++)
       {
@@ -290,12 +343,12 @@ void SigmalizedResiduals::PerformFitsForDifferentCentrAndZDC(const unsigned int
                chargeName + ", " + zDCRangeName;
 
             TH3F *distrVariable = 
-               static_cast<TH3F *>(inputFile->Get(distrVariableName.c_str()));
+               static_cast<TH3F *>(inputHistograms.Get(distrVariableName));
 
             if (!distrVariable) 
             {
                CppTools::PrintError("Histogram named \"" + distrVariableName + 
-                                    "\" does not exist in file " + inputFile->GetName());
+                                    "\" does not exist in " + inputHistograms.GetName());
             }
 
             std::string fitsOutputFileName = outputDir + detectorName + "/" + 
@@ -556,6 +609,11 @@ void SigmalizedResiduals::PerformFitsForDifferentCentrAndZDC(const unsigned int
       }
 
       parametersOutput.close();
+
+      for (const std::string& distrVariableName : distrVariableNames)
+      {
+         inputHistograms.Release(distrVariableName);
+      }
    }
 
    outputFile->Close();
@@ -570,7 +628,6 @@ void SigmalizedResiduals::PerformFitsForDifferentPT(TH3F *hist, TGraphErrors &gr
 {
    const double minBinX = hist->GetXaxis()->GetBinLowEdge(1);
    const double maxBinX = hist->GetXaxis()->GetBinUpEdge(hist->GetXaxis()->GetNbins());
-   const double binWidth = hist->GetXaxis()->GetBinWidth(1);
 
    const std::string chargeName = ((charge > 0) ? "charge>0" : "charge<0");
    const std::string chargeNameShort = ((charge > 0) ? "pos" : "neg");
@@ -592,14 +649,12 @@ void SigmalizedResiduals::PerformFitsForDifferentPT(TH3F *hist, TGraphErrors &gr
                        inputYAMLCal["pt_nbinsy"].as<int>());
 
 
-   // functions for fits of dz and dphi distributions
-   // vectors are needed for the object to not be deleted out of scope which 
-   // would result in deleting it from canvas
-   std::vector<TF1> fitFuncDVal, fitFuncGaus, fitFuncBG;
-   // alternate fits in different region for estimation of uncertainty
- 
    int iCanv = 1;
 
+   // projections and functions of the previous canvas are no longer needed
+   histogramArena.Recycle();
+   fitFunctionPool.Recycle();
+
    // graph that stores the integral of signal vs pT needed later for bin shift correction
    TGraphErrors grYield;
    // minimum and maximum pT of bins that are used
@@ -610,8 +665,8 @@ void SigmalizedResiduals::PerformFitsForDifferentPT(TH3F *hist, TGraphErrors &gr
       const double pT = CppTools::Average(pTBin["min"].as<double>(), pTBin["max"].as<double>());
       if (pT < pTMin || pT > pTMax) continue;
  
-      TH1D *distrVariableProj = hist->
-         ProjectionX(((std::string) hist->GetName() + "_projX_" + std::to_string(pT)).c_str(), 
+      TH1D *distrVariableProj = histogramArena.
+         ProjectionX(hist, (std::string) hist->GetName() + "_projX_" + std::to_string(pT), 
                      hist->GetYaxis()->FindBin(pTBin["min"].as<double>() + 1e-6), 
                      hist->GetYaxis()->FindBin(pTBin["max"].as<double>() - 1e-6),
                      hist->GetZaxis()->FindBin(centrality["min"].as<double>() + 1e-6),
@@ -631,26 +686,9 @@ void SigmalizedResiduals::PerformFitsForDifferentPT(TH3F *hist, TGraphErrors &gr
          continue;
       }
 
-      double minX = 0., maxX = -1.;
-      for (int i = 1; i <= distrVariableProj->GetXaxis()->GetNbins(); i++)
-      {
-         if (distrVariableProj->GetBinContent(i) > 1e-7)
-         {
-            minX = distrVariableProj->GetXaxis()->GetBinLowEdge(i);
-            break;
-         }
-      }
-
-      for (int i = distrVariableProj->GetXaxis()->GetNbins(); i > 1; i--)
-      {
-         if (distrVariableProj->GetBinContent(i) > 1e-7)
-         {
-            maxX = distrVariableProj->GetXaxis()->GetBinUpEdge(i);
-            break;
-         }
-      }
-
-      if (minX > maxX) 
+      // seeds and limits of the main fit and the range of the bins with entries are estimated
+      // from the bin contents in a single pass instead of the prefit
+      if (!dValSeedEstimator.Estimate(distrVariableProj, minBinX, maxBinX)) 
       {
          CppTools::PrintWarning("Something wrong for projection of " + variableName[variableBin] + 
                                 ", " + detector["name"].as<std::string>() + ", " + 
@@ -659,58 +697,56 @@ void SigmalizedResiduals::PerformFitsForDifferentPT(TH3F *hist, TGraphErrors &gr
          continue;
       }
 
-      const double maxBinVal = 
-         distrVariableProj->GetBinContent(distrVariableProj->GetMaximumBin());
+      const double minX = dValSeedEstimator.GetFirstEdge();
+      const double maxX = dValSeedEstimator.GetLastEdge();
 
-      // main fit; it will be drawn and it's parameters will be extracted for further analysis
-      fitFuncDVal.emplace_back(("fitFuncDVal_" + std::to_string(pT)).c_str(), "gaus(0) + gaus(3)");
-      fitFuncGaus.emplace_back(("fitGaus_" + std::to_string(pT)).c_str(), "gaus");
-      fitFuncBG.emplace_back(("fitBg_" + std::to_string(pT)).c_str(), "gaus");
+      const double maxBinVal = dValSeedEstimator.GetMaxBinContent();
 
-      // scale limits
-      fitFuncGaus.back().SetParLimits(0, maxBinVal/2., maxBinVal);
-      fitFuncDVal.back().SetParLimits(0, maxBinVal/2., maxBinVal);
-      fitFuncDVal.back().SetParLimits(3, maxBinVal/20., maxBinVal);
+      // main fit; it will be drawn and it's parameters will be extracted for further analysis
+      // functions are taken from the pool and are not rebuilt for every pT bin;
+      // only their clones are drawn on the canvas
+      TF1& fitFuncDVal = 
+         *fitFunctionPool.Get("fitFuncDVal_" + std::to_string(pT), "gaus(0) + gaus(3)");
+      TF1& fitFuncGaus = *fitFunctionPool.Get("fitGaus_" + std::to_string(pT), "gaus");
+      TF1& fitFuncBG = *fitFunctionPool.Get("fitBg_" + std::to_string(pT), "gaus");
 
       // set of alternative fit functions used for uncertainty estimation 
       // by varying ranges of approximation around mean by n*sigma of the main fit
       // for first vector approximation ranges are varied symmetrically within mean
       // for second vector approximation ranges are varied within right of mean; left range is 1sigma
       // for third vector approximation ranges are varied within left of mean; right range is 1sigma
-      std::vector<TF1> fitFuncDValAlt, fitFuncDValAltRight, fitFuncDValAltLeft;
+      // they are taken from the pool only in full uncertainty mode since only it uses them
+      std::array<TF1 *, 4> fitFuncDValAlt{}, fitFuncDValAltRight{}, fitFuncDValAltLeft{};
 
-      for (unsigned long i = 0; i < 4; i++)
+      if (!isUncertaintyFastMode)
       {
-         fitFuncDValAlt.emplace_back(("fitFuncDValAlt_" + std::to_string(i) + 
-                                         "_" + std::to_string(pT)).c_str(), "gaus(0) + gaus(3)");
-         fitFuncDValAlt.back().SetParLimits(0, maxBinVal/2., maxBinVal);
-         fitFuncDValAlt.back().SetParLimits(3, maxBinVal/20., maxBinVal);
-         fitFuncDValAltRight.emplace_back(("fitFuncDValAltRight_" + std::to_string(i) + 
-                                         "_" + std::to_string(pT)).c_str(), "gaus(0) + gaus(3)");
-         fitFuncDValAltRight.back().SetParLimits(0, maxBinVal/2., maxBinVal);
-         fitFuncDValAltRight.back().SetParLimits(3, maxBinVal/20., maxBinVal);
-         fitFuncDValAltLeft.emplace_back(("fitFuncDValAltLeft_" + std::to_string(i) + 
-                                         "_" + std::to_string(pT)).c_str(), "gaus(0) + gaus(3)");
-         fitFuncDValAltLeft.back().SetParLimits(0, maxBinVal/2., maxBinVal);
-         fitFuncDValAltLeft.back().SetParLimits(3, maxBinVal/20., maxBinVal);
+         for (unsigned long i = 0; i < 4; i++)
+         {
+            fitFuncDValAlt[i] = 
+               fitFunctionPool.Get("fitFuncDValAlt_" + std::to_string(i) + "_" + 
+                                   std::to_string(pT), "gaus(0) + gaus(3)");
+            fitFuncDValAlt[i]->SetParLimits(0, maxBinVal/2., maxBinVal);
+            fitFuncDValAlt[i]->SetParLimits(3, maxBinVal/20., maxBinVal);
+            fitFuncDValAltRight[i] = 
+               fitFunctionPool.Get("fitFuncDValAltRight_" + std::to_string(i) + "_" + 
+                                   std::to_string(pT), "gaus(0) + gaus(3)");
+            fitFuncDValAltRight[i]->SetParLimits(0, maxBinVal/2., maxBinVal);
+            fitFuncDValAltRight[i]->SetParLimits(3, maxBinVal/20., maxBinVal);
+            fitFuncDValAltLeft[i] = 
+               fitFunctionPool.Get("fitFuncDValAltLeft_" + std::to_string(i) + "_" + 
+                                   std::to_string(pT), "gaus(0) + gaus(3)");
+            fitFuncDValAltLeft[i]->SetParLimits(0, maxBinVal/2., maxBinVal);
+            fitFuncDValAltLeft[i]->SetParLimits(3, maxBinVal/20., maxBinVal);
+         }
       }
 
-      fitFuncGaus.back().SetParameters(1., 0., binWidth*2.);
-      fitFuncDVal.back().SetParameters(1., 0., binWidth*2., 1., 0., maxX/2.);
-
-      fitFuncGaus.back().SetParLimits(1, minBinX/5., maxBinX/5.);
-      fitFuncGaus.back().SetParLimits(2, binWidth, maxBinX/5.);
-      fitFuncDVal.back().SetParLimits(1, minX/10., maxX/10.);
-      fitFuncDVal.back().SetParLimits(2, binWidth, CppTools::Average(maxX, maxX, minX));
+      dValSeedEstimator.SetSeeds(fitFuncDVal);
 
-      fitFuncDVal.back().SetParLimits(4, minX*2., maxX*2.);
-      fitFuncDVal.back().SetParLimits(5, maxX/3., maxX*3.);
-
-      fitFuncDVal.back().SetLineColorAlpha(kRed+1, 0.6);
-      fitFuncBG.back().SetLineColorAlpha(kGreen+1, 0.9);
-      fitFuncBG.back().SetLineStyle(2);
-      fitFuncGaus.back().SetLineColorAlpha(kAzure-3, 0.9);
-      fitFuncGaus.back().SetLineStyle(2);
+      fitFuncDVal.SetLineColorAlpha(kRed+1, 0.6);
+      fitFuncBG.SetLineColorAlpha(kGreen+1, 0.9);
+      fitFuncBG.SetLineStyle(2);
+      fitFuncGaus.SetLineColorAlpha(kAzure-3, 0.9);
+      fitFuncGaus.SetLineStyle(2);
 
       distrVariableProj->GetXaxis()->SetTitle(variableNameTex[variableBin].c_str());
       distrVariableProj->SetTitle("");
@@ -724,84 +760,103 @@ void SigmalizedResiduals::PerformFitsForDifferentPT(TH3F *hist, TGraphErrors &gr
 
       //distrVariableProj->Sumw2();
  
-      fitFuncGaus.back().SetRange(minBinX/5., maxBinX/5.);
-
-      distrVariableProj->Fit(&fitFuncGaus.back(), "RQMBN");
- 
-      for (int i = 0; i < 3; i++)
+      fitFuncDVal.SetRange(minBinX, maxBinX);
+      // seeds are refined in the histogram with merged bins; 
+      // original bins are fitted only if there are too few merged bins
+      if (coarseToFineFit.Fit(distrVariableProj, fitFuncDVal) == -1)
       {
-         fitFuncDVal.back().SetParameter(i, fitFuncGaus.back().GetParameter(i));
+         distrVariableProj->Fit(&fitFuncDVal, "RQMBN");
       }
 
-      fitFuncDVal.back().SetRange(minBinX, maxBinX);
-      distrVariableProj->Fit(&fitFuncDVal.back(), "RQMBN");
-
       // fit range
       int fitRangeXMinBin = 
-         distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.back().GetParameter(1) - 
-                                                fitFuncDVal.back().GetParameter(2)*5.);
+         distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.GetParameter(1) - 
+                                                fitFuncDVal.GetParameter(2)*5.);
       int fitRangeXMaxBin = 
-         distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.back().GetParameter(1) + 
-                                                fitFuncDVal.back().GetParameter(2)*5.);
+         distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.GetParameter(1) + 
+                                                fitFuncDVal.GetParameter(2)*5.);
       double fitRangeXMin = distrVariableProj->GetXaxis()->GetBinLowEdge(fitRangeXMinBin);
       double fitRangeXMax = distrVariableProj->GetXaxis()->GetBinUpEdge(fitRangeXMaxBin);
 
-      for (unsigned short i = 1; i <= fitNTries; i++)
+      // every tier starts from the parameters of the seed fit
+      std::array<double, 6> seedParameters;
+      for (int i = 0; i < fitFuncDVal.GetNpar(); i++)
+      {
+         seedParameters[i] = fitFuncDVal.GetParameter(i);
+      }
+
+      auto FitDVal = [&](const FitStrategyLadder::Tier& tier, const unsigned int tryIndex)
       {
-         fitFuncDVal.back().SetParLimits(0, fitFuncDVal.back().GetParameter(0)/
-                                         (1. + 2./static_cast<double>(i*i*i)),
-                                         fitFuncDVal.back().GetParameter(0)*
-                                         (1. + 2./static_cast<double>(i*i*i)));
-         fitFuncDVal.back().SetParLimits(1, fitFuncDVal.back().GetParameter(1)*
-                                         (1. - 6./static_cast<double>(i*i*i)),
-                                         fitFuncDVal.back().GetParameter(1)*
-                                         (1. + 4./static_cast<double>(i*i*i)));
-         fitFuncDVal.back().SetParLimits(2, fitFuncDVal.back().GetParameter(2)/
-                                         (1. + 5./static_cast<double>(i*i*i)),
-                                         fitFuncDVal.back().GetParameter(2)*
-                                         (1. + 5./static_cast<double>(i*i*i)));
-         fitFuncDVal.back().SetParLimits(3, fitFuncDVal.back().GetParameter(3)/
-                                         (1. + 5./static_cast<double>(i*i)),
-                                         fitFuncDVal.back().GetParameter(3)*
-                                         (1. + 5./static_cast<double>(i*i)));
-         fitFuncDVal.back().SetParLimits(4, fitFuncDVal.back().GetParameter(4)*
-                                         (1. - 6./static_cast<double>(i*i)),
-                                         fitFuncDVal.back().GetParameter(4)*
-                                         (1. + 4./static_cast<double>(i*i)));
-         fitFuncDVal.back().SetParLimits(5, fitFuncDVal.back().GetParameter(5)/
-                                         (1. + 5./static_cast<double>(i*i)),
-                                         fitFuncDVal.back().GetParameter(5)*
-                                         (1. + 5./static_cast<double>(i*i)));
+         if (tryIndex == 0) fitFuncDVal.SetParameters(seedParameters.data());
+
+         const unsigned short i = tryIndex + 1;
+
+         fitFuncDVal.SetParLimits(0, fitFuncDVal.GetParameter(0)/
+                                  (1. + 2./static_cast<double>(i*i*i)),
+                                  fitFuncDVal.GetParameter(0)*
+                                  (1. + 2./static_cast<double>(i*i*i)));
+         fitFuncDVal.SetParLimits(1, fitFuncDVal.GetParameter(1)*
+                                  (1. - 6./static_cast<double>(i*i*i)),
+                                  fitFuncDVal.GetParameter(1)*
+                                  (1. + 4./static_cast<double>(i*i*i)));
+         fitFuncDVal.SetParLimits(2, fitFuncDVal.GetParameter(2)/
+                                  (1. + 5./static_cast<double>(i*i*i)),
+                                  fitFuncDVal.GetParameter(2)*
+                                  (1. + 5./static_cast<double>(i*i*i)));
+         fitFuncDVal.SetParLimits(3, fitFuncDVal.GetParameter(3)/
+                                  (1. + 5./static_cast<double>(i*i)),
+                                  fitFuncDVal.GetParameter(3)*
+                                  (1. + 5./static_cast<double>(i*i)));
+         fitFuncDVal.SetParLimits(4, fitFuncDVal.GetParameter(4)*
+                                  (1. - 6./static_cast<double>(i*i)),
+                                  fitFuncDVal.GetParameter(4)*
+                                  (1. + 4./static_cast<double>(i*i)));
+         fitFuncDVal.SetParLimits(5, fitFuncDVal.GetParameter(5)/
+                                  (1. + 5./static_cast<double>(i*i)),
+                                  fitFuncDVal.GetParameter(5)*
+                                  (1. + 5./static_cast<double>(i*i)));
 
          fitRangeXMinBin = 
-            distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.back().GetParameter(1) - 
-                                                   fitFuncDVal.back().GetParameter(2)*5.);
+            distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.GetParameter(1) - 
+                                                   fitFuncDVal.GetParameter(2)*5.);
          fitRangeXMaxBin = 
-            distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.back().GetParameter(1) + 
-                                                   fitFuncDVal.back().GetParameter(2)*5.);
+            distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.GetParameter(1) + 
+                                                   fitFuncDVal.GetParameter(2)*5.);
 
          fitRangeXMin = distrVariableProj->GetXaxis()->GetBinLowEdge(fitRangeXMinBin);
          fitRangeXMax = distrVariableProj->GetXaxis()->GetBinUpEdge(fitRangeXMaxBin);
 
-         fitFuncDVal.back().SetRange(fitRangeXMin, fitRangeXMax);
-         distrVariableProj->Fit(&fitFuncDVal.back(), "RQMBNL");
-      }
+         fitFuncDVal.SetRange(fitRangeXMin, fitRangeXMax);
+         return distrVariableProj->Fit(&fitFuncDVal, tier.options.c_str());
+      };
 
-      fitFuncGaus.back().SetRange(fitRangeXMin, fitRangeXMax);
-      fitFuncBG.back().SetRange(fitRangeXMin, fitRangeXMax);
+      auto IsFitAccepted = [&]()
+      {
+         return dValFitLadder.IsFitGood(fitFuncDVal) && 
+                fabs(fitFuncDVal.GetParameter(1)) < 
+                detector["abs_max_fit_" + variableName[variableBin]].as<double>() && 
+                fabs(fitFuncDVal.GetParameter(2)) < 
+                detector["abs_max_fit_" + variableName[variableBin]].as<double>();
+      };
+
+      // cheaper tiers are escalated to more expensive ones only if their results are rejected
+      dValFitLadder.Run(nullptr, FitDVal, IsFitAccepted);
+
+      fitFuncGaus.SetRange(fitRangeXMin, fitRangeXMax);
+      fitFuncBG.SetRange(fitRangeXMin, fitRangeXMax);
 
       fitRangeXMinBin = 
-         distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.back().GetParameter(1) - 
-                                                fitFuncDVal.back().GetParameter(2)*10.);
+         distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.GetParameter(1) - 
+                                                fitFuncDVal.GetParameter(2)*10.);
       fitRangeXMaxBin = 
-         distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.back().GetParameter(1) + 
-                                                fitFuncDVal.back().GetParameter(2)*10.);
+         distrVariableProj->GetXaxis()->FindBin(fitFuncDVal.GetParameter(1) + 
+                                                fitFuncDVal.GetParameter(2)*10.);
       distrVariableProj->GetXaxis()->SetRange(fitRangeXMinBin, fitRangeXMaxBin);
  
       for (int i = 0; i < 3; i++)
       {
-         fitFuncGaus.back().SetParameter(i, fitFuncDVal.back().GetParameter(i));
-         fitFuncBG.back().SetParameter(i, fitFuncDVal.back().GetParameter(i + 3));
+         fitFuncGaus.SetParameter(i, fitFuncDVal.GetParameter(i));
+         fitFuncBG.SetParameter(i, fitFuncDVal.GetParameter(i + 3));
       }
 
       distrVariableProj->SetMarkerStyle(20);
@@ -816,9 +871,9 @@ void SigmalizedResiduals::PerformFitsForDifferentPT(TH3F *hist, TGraphErrors &gr
       gPad->SetBottomMargin(0.128);
 
       gPad->Add(distrVariableProj, "P");
-      fitFuncDVal.back().DrawClone("SAME");
-      fitFuncBG.back().DrawClone("SAME");
-      fitFuncGaus.back().DrawClone("SAME");
+      fitFuncDVal.DrawClone("SAME");
+      fitFuncBG.DrawClone("SAME");
+      fitFuncGaus.DrawClone("SAME");
 
       pTRangeTLatex.SetText(0.17, 0.85, pTRangeName.c_str());
       zDCRangeTLatex.SetText(0.17, 0.79, zDCRangeName.c_str());
@@ -831,98 +886,119 @@ void SigmalizedResiduals::PerformFitsForDifferentPT(TH3F *hist, TGraphErrors &gr
 
       iCanv++;
 
-      for (unsigned long i = 0; i < fitFuncDValAlt.size(); i++)
+      // alternative fits are used for the uncertainties only in full uncertainty mode
+      if (!isUncertaintyFastMode)
       {
-         fitFuncDValAlt[i].
-            SetRange(fitFuncDVal.back().GetParameter(1) - fitFuncDVal.back().GetParameter(2)*
-                     static_cast<double>(i + 1)*2., fitFuncDVal.back().GetParameter(1) + 
-                     fitFuncDVal.back().GetParameter(2)*static_cast<double>(i + 1)*2.);
-         fitFuncDValAltRight[i].
-            SetRange(fitFuncDVal.back().GetParameter(1) - fitFuncDVal.back().GetParameter(2), 
-                     fitFuncDVal.back().GetParameter(1) + 
-                     fitFuncDVal.back().GetParameter(2)*static_cast<double>(i + 1)*2.);
-         fitFuncDValAltLeft[i].
-            SetRange(fitFuncDVal.back().GetParameter(1) - fitFuncDVal.back().GetParameter(2)*
-                     static_cast<double>(i + 1)*2., fitFuncDVal.back().GetParameter(1) + 
-                     fitFuncDVal.back().GetParameter(2));
-
-         for (int j = 0; j < fitFuncDVal.back().GetNpar(); j++)
+         for (unsigned long i = 0; i < fitFuncDValAlt.size(); i++)
          {
-            fitFuncDValAlt[i].SetParameter(j, fitFuncDVal.back().GetParameter(j)); 
-            fitFuncDValAltRight[i].SetParameter(j, fitFuncDVal.back().GetParameter(j)); 
-            fitFuncDValAltLeft[i].SetParameter(j, fitFuncDVal.back().GetParameter(j)); 
-
-            if (j == 0 || j == 3)
+            fitFuncDValAlt[i]->
+               SetRange(fitFuncDVal.GetParameter(1) - fitFuncDVal.GetParameter(2)*
+                        static_cast<double>(i + 1)*2., fitFuncDVal.GetParameter(1) + 
+                        fitFuncDVal.GetParameter(2)*static_cast<double>(i + 1)*2.);
+            fitFuncDValAltRight[i]->
+               SetRange(fitFuncDVal.GetParameter(1) - fitFuncDVal.GetParameter(2), 
+                        fitFuncDVal.GetParameter(1) + 
+                        fitFuncDVal.GetParameter(2)*static_cast<double>(i + 1)*2.);
+            fitFuncDValAltLeft[i]->
+               SetRange(fitFuncDVal.GetParameter(1) - fitFuncDVal.GetParameter(2)*
+                        static_cast<double>(i + 1)*2., fitFuncDVal.GetParameter(1) + 
+                        fitFuncDVal.GetParameter(2));
+
+            for (int j = 0; j < fitFuncDVal.GetNpar(); j++)
             {
-               fitFuncDValAlt[i].SetParLimits(j, fitFuncDVal.back().GetParameter(j)/1.2, 
-                                              fitFuncDVal.back().GetParameter(j)*1.2); 
-               fitFuncDValAltRight[i].SetParLimits(j, fitFuncDVal.back().GetParameter(j)/1.2, 
-                                                   fitFuncDVal.back().GetParameter(j)*1.2); 
-               fitFuncDValAltLeft[i].SetParLimits(j, fitFuncDVal.back().GetParameter(j)/1.2, 
-                                                  fitFuncDVal.back().GetParameter(j)*1.2); 
-            }
-            else if (j == 2 || j == 4)
-            {
-               fitFuncDValAlt[i].SetParLimits(j, fitFuncDVal.back().GetParameter(j)/1.5, 
-                                              fitFuncDVal.back().GetParameter(j)*1.5); 
-               fitFuncDValAltRight[i].SetParLimits(j, fitFuncDVal.back().GetParameter(j)/1.5, 
-                                                   fitFuncDVal.back().GetParameter(j)*1.5); 
-               fitFuncDValAltLeft[i].SetParLimits(j, fitFuncDVal.back().GetParameter(j)/1.5, 
-                                                   fitFuncDVal.back().GetParameter(j)*1.5); 
+               fitFuncDValAlt[i]->SetParameter(j, fitFuncDVal.GetParameter(j)); 
+               fitFuncDValAltRight[i]->SetParameter(j, fitFuncDVal.GetParameter(j)); 
+               fitFuncDValAltLeft[i]->SetParameter(j, fitFuncDVal.GetParameter(j)); 
+
+               if (j == 0 || j == 3)
+               {
+                  fitFuncDValAlt[i]->SetParLimits(j, fitFuncDVal.GetParameter(j)/1.2, 
+                                                  fitFuncDVal.GetParameter(j)*1.2); 
+                  fitFuncDValAltRight[i]->SetParLimits(j, fitFuncDVal.GetParameter(j)/1.2, 
+                                                       fitFuncDVal.GetParameter(j)*1.2); 
+                  fitFuncDValAltLeft[i]->SetParLimits(j, fitFuncDVal.GetParameter(j)/1.2, 
+                                                      fitFuncDVal.GetParameter(j)*1.2); 
+               }
+               else if (j == 2 || j == 4)
+               {
+                  fitFuncDValAlt[i]->SetParLimits(j, fitFuncDVal.GetParameter(j)/1.5, 
+                                                  fitFuncDVal.GetParameter(j)*1.5); 
+                  fitFuncDValAltRight[i]->SetParLimits(j, fitFuncDVal.GetParameter(j)/1.5, 
+                                                       fitFuncDVal.GetParameter(j)*1.5); 
+                  fitFuncDValAltLeft[i]->SetParLimits(j, fitFuncDVal.GetParameter(j)/1.5, 
+                                                      fitFuncDVal.GetParameter(j)*1.5); 
+               }
             }
+            distrVariableProj->Fit(fitFuncDValAlt[i], "RQMBNL");
+            distrVariableProj->Fit(fitFuncDValAltRight[i], "RQMBNL");
+            distrVariableProj->Fit(fitFuncDValAltLeft[i], "RQMBNL");
          }
-         distrVariableProj->Fit(&fitFuncDValAlt[i], "RQMBNL");
-         distrVariableProj->Fit(&fitFuncDValAltRight[i], "RQMBNL");
-         distrVariableProj->Fit(&fitFuncDValAltLeft[i], "RQMBNL");
       }
 
-      if (fabs(fitFuncDVal.back().GetParameter(1)) < 
+      if (fabs(fitFuncDVal.GetParameter(1)) < 
           detector["abs_max_fit_" + variableName[variableBin]].as<double>() && 
-          fabs(fitFuncDVal.back().GetParameter(2)) < 
+          fabs(fitFuncDVal.GetParameter(2)) < 
           detector["abs_max_fit_" + variableName[variableBin]].as<double>())
       {
-         grMeans.AddPoint(pT, fitFuncDVal.back().GetParameter(1));
-         grSigmas.AddPoint(pT, fabs(fitFuncDVal.back().GetParameter(2)));
+         grMeans.AddPoint(pT, fitFuncDVal.GetParameter(1));
+         grSigmas.AddPoint(pT, fabs(fitFuncDVal.GetParameter(2)));
 
-         grYield.AddPoint(pT, GetYield(distrVariableProj, fitFuncBG.back(), 
-                          fitFuncDVal.back().GetParameter(1), fitFuncDVal.back().GetParameter(2)));
+         grYield.AddPoint(pT, GetYield(distrVariableProj, fitFuncBG, 
+                          fitFuncDVal.GetParameter(1), fitFuncDVal.GetParameter(2)));
 
          binsPTMin.push_back(pTBin["min"].as<double>());
          binsPTMax.push_back(pTBin["max"].as<double>());
 
-         // relative uncertainties of means are inconsistent since absolute uncertainty does not
-         // depend on the position of the mean (it can be close to 0 or much larger number) 
-         // therefore for means difference of means divided by sigma is used as uncertainty
-         // after CppTools is updated needs to be replaced
-         const double meanError = 
-            CppTools::StandardError(fitFuncDValAlt[0].GetParameter(1),
-                                    fitFuncDValAlt[1].GetParameter(1),
-                                    fitFuncDValAlt[2].GetParameter(1),
-                                    fitFuncDValAlt[3].GetParameter(1), 
-                                    fitFuncDValAltRight[0].GetParameter(1),
-                                    fitFuncDValAltRight[1].GetParameter(1),
-                                    fitFuncDValAltRight[2].GetParameter(1),
-                                    fitFuncDValAltRight[3].GetParameter(1),
-                                    fitFuncDValAltLeft[0].GetParameter(1),
-                                    fitFuncDValAltLeft[1].GetParameter(1),
-                                    fitFuncDValAltLeft[2].GetParameter(1),
-                                    fitFuncDValAltLeft[3].GetParameter(1),
-                                    fitFuncDVal.back().GetParameter(1));
-
-         const double sigmaError = 
-            CppTools::StandardError(fitFuncDValAlt[0].GetParameter(2),
-                                    fitFuncDValAlt[1].GetParameter(2),
-                                    fitFuncDValAlt[2].GetParameter(2),
-                                    fitFuncDValAlt[3].GetParameter(2), 
-                                    fitFuncDValAltRight[0].GetParameter(2),
-                                    fitFuncDValAltRight[1].GetParameter(2),
-                                    fitFuncDValAltRight[2].GetParameter(2),
-                                    fitFuncDValAltRight[3].GetParameter(2),
-                                    fitFuncDValAltLeft[0].GetParameter(2),
-                                    fitFuncDValAltLeft[1].GetParameter(2),
-                                    fitFuncDValAltLeft[2].GetParameter(2),
-                                    fitFuncDValAltLeft[3].GetParameter(2),
-                                    fitFuncDVal.back().GetParameter(2));
+         double meanError, sigmaError;
+
+         if (isUncertaintyFastMode)
+         {
+            // statistical uncertainties from the covariance matrix of the main fit and systematic
+            // uncertainties from the range of the fit are added in quadrature
+            rangeSystematics.Estimate(distrVariableProj, fitFuncBG, fitFuncDVal.GetParameter(1), 
+                                      fabs(fitFuncDVal.GetParameter(2)));
+
+            meanError = sqrt(fitFuncDVal.GetParError(1)*fitFuncDVal.GetParError(1) + 
+                             rangeSystematics.GetMeanError()*rangeSystematics.GetMeanError());
+            sigmaError = sqrt(fitFuncDVal.GetParError(2)*fitFuncDVal.GetParError(2) + 
+                              rangeSystematics.GetSigmaError()*rangeSystematics.GetSigmaError());
+         }
+         else
+         {
+            // relative uncertainties of means are inconsistent since absolute uncertainty does not
+            // depend on the position of the mean (it can be close to 0 or much larger number) 
+            // therefore for means difference of means divided by sigma is used as uncertainty
+            // after CppTools is updated needs to be replaced
+            meanError = 
+               CppTools::StandardError(fitFuncDValAlt[0]->GetParameter(1),
+                                       fitFuncDValAlt[1]->GetParameter(1),
+                                       fitFuncDValAlt[2]->GetParameter(1),
+                                       fitFuncDValAlt[3]->GetParameter(1), 
+                                       fitFuncDValAltRight[0]->GetParameter(1),
+                                       fitFuncDValAltRight[1]->GetParameter(1),
+                                       fitFuncDValAltRight[2]->GetParameter(1),
+                                       fitFuncDValAltRight[3]->GetParameter(1),
+                                       fitFuncDValAltLeft[0]->GetParameter(1),
+                                       fitFuncDValAltLeft[1]->GetParameter(1),
+                                       fitFuncDValAltLeft[2]->GetParameter(1),
+                                       fitFuncDValAltLeft[3]->GetParameter(1),
+                                       fitFuncDVal.GetParameter(1));
+
+            sigmaError = 
+               CppTools::StandardError(fitFuncDValAlt[0]->GetParameter(2),
+                                       fitFuncDValAlt[1]->GetParameter(2),
+                                       fitFuncDValAlt[2]->GetParameter(2),
+                                       fitFuncDValAlt[3]->GetParameter(2), 
+                                       fitFuncDValAltRight[0]->GetParameter(2),
+                                       fitFuncDValAltRight[1]->GetParameter(2),
+                                       fitFuncDValAltRight[2]->GetParameter(2),
+                                       fitFuncDValAltRight[3]->GetParameter(2),
+                                       fitFuncDValAltLeft[0]->GetParameter(2),
+                                       fitFuncDValAltLeft[1]->GetParameter(2),
+                                       fitFuncDValAltLeft[2]->GetParameter(2),
+                                       fitFuncDValAltLeft[3]->GetParameter(2),
+                                       fitFuncDVal.GetParameter(2));
+         }
 
          grMeans.SetPointError(grMeans.GetN() - 1, 0, meanError);
          grSigmas.SetPointError(grSigmas.GetN() - 1, 0, sigmaError);
@@ -0,0 +1,281 @@
+/**
+ *  @file   SigmalizedResidualsEvaluator.cpp
+ *  @brief  Contains realisation of class SigmalizedResidualsEvaluator
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef SIGMALIZED_RESIDUALS_EVALUATOR_CPP
+#define SIGMALIZED_RESIDUALS_EVALUATOR_CPP
+
+#include "../include/SigmalizedResidualsEvaluator.hpp"
+
+SigmalizedResidualsEvaluator::SigmalizedResidualsEvaluator() {};
+
+SigmalizedResidualsEvaluator::SigmalizedResidualsEvaluator(const double pTMin, const double pTMax,
+                                                           const unsigned int numberOfPTBins,
+                                                           const std::vector<double>& centralityRanges,
+                                                           const std::vector<double>& zDCRanges,
+                                                           const bool isRecalibrationApplied)
+{
+   if (pTMax <= pTMin)
+   {
+      CppTools::PrintError("SigmalizedResidualsEvaluator: Upper edge of pT grid must be bigger than the lower one");
+   }
+   if (numberOfPTBins == 0)
+   {
+      CppTools::PrintError("SigmalizedResidualsEvaluator: Number of pT bins must be bigger than 0");
+   }
+   if (centralityRanges.size() < 2 || zDCRanges.size() < 2)
+   {
+      CppTools::PrintError("SigmalizedResidualsEvaluator: At least 1 centrality and 1 zDC bin must be provided");
+   }
+
+   this->pTMin = pTMin;
+   this->pTMax = pTMax;
+   this->numberOfPTBins = numberOfPTBins;
+   this->centralityRanges = centralityRanges;
+   this->zDCRanges = zDCRanges;
+   this->isRecalibrationApplied = isRecalibrationApplied;
+
+   inversePTBinWidth = static_cast<double>(numberOfPTBins)/(pTMax - pTMin);
+
+   // the first table is filled with NaN and is used for the tracks out of centrality or zDC bins
+   scaleTable.assign(numberOfPTBins + 1, std::numeric_limits<float>::quiet_NaN());
+   offsetTable.assign(numberOfPTBins + 1, std::numeric_limits<float>::quiet_NaN());
+}
+
+unsigned int SigmalizedResidualsEvaluator::AddDetector(const YAML::Node& detector,
+                                                       const std::string& parametersDir)
+{
+   const unsigned int detectorBin = detectorNames.size();
+
+   detectorNames.push_back(detector["name"].as<std::string>());
+
+   // tables of the detector: 2 variables, 2 charges, all centrality and zDC bins
+   const unsigned long numberOfTables =
+      GetTableIndex(detectorBin + 1, 0, 0, 0, 0)*(numberOfPTBins + 1);
+
+   scaleTable.resize(numberOfTables);
+   offsetTable.resize(numberOfTables);
+
+   for (unsigned int variableBin = 0; variableBin < 2; variableBin++)
+   {
+      FillTables(detector, parametersDir, variableBin, 1,
+                 GetTableIndex(detectorBin, variableBin, 0, 0, 0));
+      FillTables(detector, parametersDir, variableBin, -1,
+                 GetTableIndex(detectorBin, variableBin, 1, 0, 0));
+   }
+
+   return detectorBin;
+}
+
+void SigmalizedResidualsEvaluator::Evaluate(const unsigned int detectorBin,
+                                            const unsigned int variableBin,
+                                            const unsigned long numberOfTracks,
+                                            const int *centralityBin, const int *zDCBin,
+                                            const int *charge, const double *pT,
+                                            const double *val, double *sval) const
+{
+   const int tableSize = static_cast<int>(numberOfPTBins) + 1;
+   const int numberOfCentralityBins = static_cast<int>(centralityRanges.size()) - 1;
+   const int numberOfZDCBins = static_cast<int>(zDCRanges.size()) - 1;
+
+   // tables of the positive charge of the detector and the variable start from this table
+   const int firstTableIndex = static_cast<int>(GetTableIndex(detectorBin, variableBin, 0, 0, 0));
+
+   // members are copied so that the compiler does not reload them after the stores to sval
+   const double gridMin = pTMin;
+   const double gridScale = inversePTBinWidth;
+   const double maxPosition = static_cast<double>(numberOfPTBins);
+   const int lastBin = static_cast<int>(numberOfPTBins) - 1;
+
+   const float *scale = scaleTable.data();
+   const float *offset = offsetTable.data();
+
+   // the loop has no branches and no calls; the last node is handled by the previous interval
+   for (unsigned long i = 0; i < numberOfTracks; i++)
+   {
+      // tracks out of bins are pointed to the NaN table by multiplication instead of the branch;
+      // bitwise and is used instead of logical one for the same reason
+      const int isInRange = (centralityBin[i] >= 0) & (zDCBin[i] >= 0);
+
+      const int tableIndex = isInRange*(firstTableIndex + 
+         ((charge[i] < 0)*numberOfCentralityBins + centralityBin[i])*numberOfZDCBins + zDCBin[i]);
+
+      double position = (pT[i] - gridMin)*gridScale;
+      position = (position < 0.) ? 0. : position;
+      position = (position > maxPosition) ? maxPosition : position;
+
+      int bin = static_cast<int>(position);
+      bin = (bin > lastBin) ? lastBin : bin;
+
+      const double fraction = position - bin;
+      const int node = tableIndex*tableSize + bin;
+
+      const double trackScale = scale[node] + (scale[node + 1] - scale[node])*fraction;
+      const double trackOffset = offset[node] + (offset[node + 1] - offset[node])*fraction;
+
+      sval[i] = val[i]*trackScale + trackOffset;
+   }
+}
+
+double SigmalizedResidualsEvaluator::Evaluate(const unsigned int detectorBin,
+                                              const unsigned int variableBin,
+                                              const int centralityBin, const int zDCBin,
+                                              const int charge, const double pT,
+                                              const double val) const
+{
+   double sval;
+   Evaluate(detectorBin, variableBin, 1, &centralityBin, &zDCBin, &charge, &pT, &val, &sval);
+   return sval;
+}
+
+int SigmalizedResidualsEvaluator::GetCentralityBin(const double centrality) const
+{
+   return FindBin(centralityRanges, centrality);
+}
+
+int SigmalizedResidualsEvaluator::GetZDCBin(const double zDC) const
+{
+   return FindBin(zDCRanges, zDC);
+}
+
+unsigned int SigmalizedResidualsEvaluator::GetNumberOfDetectors() const
+{
+   return detectorNames.size();
+}
+
+const std::string& SigmalizedResidualsEvaluator::GetDetectorName(const unsigned int detectorBin) const
+{
+   return detectorNames[detectorBin];
+}
+
+void SigmalizedResidualsEvaluator::FillTables(const YAML::Node& detector,
+                                              const std::string& parametersDir,
+                                              const unsigned int variableBin, const int charge,
+                                              const unsigned long tableIndex)
+{
+   const std::string detectorName = detector["name"].as<std::string>();
+   const std::string chargeNameShort = ((charge > 0) ? "pos" : "neg");
+   const std::string fileNameEnding =
+      detectorName + "_s" + variableName[variableBin] + "_" + chargeNameShort + ".txt";
+
+   // lambda expressions for TF1 same as in SigmalizedResiduals
+   const std::string meansFitFunc = "[](double *x, double *p) {return " +
+                                    detector["means_fit_func_" + variableName[variableBin] +
+                                             "_" + chargeNameShort].as<std::string>() + ";}";
+   const std::string sigmasFitFunc = "[](double *x, double *p) {return " +
+                                     detector["sigmas_fit_func_" + variableName[variableBin] +
+                                              "_" + chargeNameShort].as<std::string>() + ";}";
+
+   const std::string calFileName = parametersDir + "cal_" + fileNameEnding;
+   const std::string recalFileName = parametersDir + "recal_" + fileNameEnding;
+
+   if (!std::filesystem::exists(calFileName))
+   {
+      CppTools::PrintError("SigmalizedResidualsEvaluator: File " + calFileName + " does not exist");
+   }
+
+   std::ifstream calFile(calFileName);
+   std::ifstream recalFile;
+
+   const bool isRecalibrated = isRecalibrationApplied && std::filesystem::exists(recalFileName);
+
+   if (isRecalibrated)
+   {
+      recalFile.open(recalFileName);
+
+      std::string line;
+      std::getline(recalFile, line); // skipping the number of parameters
+   }
+   else if (isRecalibrationApplied)
+   {
+      CppTools::PrintWarning("SigmalizedResidualsEvaluator: File " + recalFileName +
+                             " does not exist; recalibration will not be applied");
+   }
+
+   int numberOfParametersFitMeans, numberOfParametersFitSigmas;
+   if (!(calFile >> numberOfParametersFitMeans >> numberOfParametersFitSigmas))
+   {
+      CppTools::PrintError("SigmalizedResidualsEvaluator: Corrupted header in file " + calFileName);
+   }
+
+   TF1 meansFunc((detectorName + variableName[variableBin] + chargeNameShort + "means").c_str(),
+                 meansFitFunc.c_str(), pTMin, pTMax, numberOfParametersFitMeans);
+   TF1 sigmasFunc((detectorName + variableName[variableBin] + chargeNameShort + "sigmas").c_str(),
+                  sigmasFitFunc.c_str(), pTMin, pTMax, numberOfParametersFitSigmas);
+
+   std::vector<double> meansParameters(numberOfParametersFitMeans);
+   std::vector<double> sigmasParameters(numberOfParametersFitSigmas);
+
+   const unsigned long tableSize = numberOfPTBins + 1;
+
+   // lines are written by SigmalizedResiduals with zDC bins inside centrality bins
+   for (unsigned long bin = 0; bin < (centralityRanges.size() - 1)*(zDCRanges.size() - 1); bin++)
+   {
+      for (double& parameter : meansParameters)
+      {
+         if (!(calFile >> parameter))
+         {
+            CppTools::PrintError("SigmalizedResidualsEvaluator: Not enough parameters in file " +
+                                 calFileName + " for the centrality and zDC bins from input file");
+         }
+      }
+      for (double& parameter : sigmasParameters)
+      {
+         if (!(calFile >> parameter))
+         {
+            CppTools::PrintError("SigmalizedResidualsEvaluator: Not enough parameters in file " +
+                                 calFileName + " for the centrality and zDC bins from input file");
+         }
+      }
+
+      double meanShift = 0., sigmaScale = 1.;
+      if (isRecalibrated && !(recalFile >> meanShift >> sigmaScale))
+      {
+         CppTools::PrintError("SigmalizedResidualsEvaluator: Not enough parameters in file " +
+                              recalFileName + " for the centrality and zDC bins from input file");
+      }
+
+      meansFunc.SetParameters(meansParameters.data());
+      sigmasFunc.SetParameters(sigmasParameters.data());
+
+      float *scale = &scaleTable[(tableIndex + bin)*tableSize];
+      float *offset = &offsetTable[(tableIndex + bin)*tableSize];
+
+      for (unsigned int i = 0; i <= numberOfPTBins; i++)
+      {
+         const double pT = pTMin + i/inversePTBinWidth;
+         const double sigma = sigmasFunc.Eval(pT);
+
+         scale[i] = static_cast<float>(sigmaScale/sigma);
+         offset[i] = static_cast<float>((meanShift - meansFunc.Eval(pT)/sigma)*sigmaScale);
+      }
+   }
+}
+
+unsigned long SigmalizedResidualsEvaluator::GetTableIndex(const unsigned int detectorBin,
+                                                          const unsigned int variableBin,
+                                                          const unsigned int chargeBin,
+                                                          const unsigned int centralityBin,
+                                                          const unsigned int zDCBin) const
+{
+   const unsigned long numberOfCentralityBins = centralityRanges.size() - 1;
+   const unsigned long numberOfZDCBins = zDCRanges.size() - 1;
+
+   // the first table is the NaN table
+   return (((static_cast<unsigned long>(detectorBin)*2 + variableBin)*2 + chargeBin)*
+           numberOfCentralityBins + centralityBin)*numberOfZDCBins + zDCBin + 1;
+}
+
+int SigmalizedResidualsEvaluator::FindBin(const std::vector<double>& ranges, const double value)
+{
+   if (value < ranges.front() || value >= ranges.back()) return -1;
+   return std::upper_bound(ranges.begin(), ranges.end(), value) - ranges.begin() - 1;
+}
+
+SigmalizedResidualsEvaluator::~SigmalizedResidualsEvaluator() {};
+
+#endif /* SIGMALIZED_RESIDUALS_EVALUATOR_CPP */
@@ -0,0 +1,145 @@
+/**
+ *  @file   SigmalizedResidualsEvaluatorBenchmark.cpp
+ *  @brief  Contains realisation of the program that measures the throughput of SigmalizedResidualsEvaluator
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef SIGMALIZED_RESIDUALS_EVALUATOR_BENCHMARK_CPP
+#define SIGMALIZED_RESIDUALS_EVALUATOR_BENCHMARK_CPP
+
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+
+#include "TROOT.h"
+
+#include "ErrorHandler.hpp"
+#include "IOTools.hpp"
+
+#include "InputYAMLReader.hpp"
+#include "SigmalizedResidualsEvaluator.hpp"
+
+// Reads the calibration parameters of all detectors produced by SigmalizedResiduals and
+// CheckSigmalizedResiduals, calculates sdphi and sdz of randomly generated tracks in batches,
+// and prints the number of evaluated tracks per second
+int main(int argc, char **argv)
+{
+   if (argc < 2 || argc > 3)
+   {
+      std::string errMsg = "Expected 1-2 parameters while " + std::to_string(argc - 1) +
+                           " parameter(s) were provided \n";
+      errMsg += "Usage: bin/SigmalizedResidualsEvaluatorBenchmark inputFile numberOfTracks=10000000\n";
+      CppTools::PrintError(errMsg);
+   }
+
+   const unsigned long numberOfTracks = (argc > 2) ? std::stoul(argv[2]) : 10000000;
+
+   gErrorIgnoreLevel = kWarning;
+
+   InputYAMLReader inputYAMLCal(argv[1], "sigmalized_residuals");
+   inputYAMLCal.CheckStatus("sigmalized_residuals");
+
+   const std::string parametersDir = "output/SigmalizedResiduals/" +
+      inputYAMLCal["run_name"].as<std::string>() + "/CalibrationParameters/";
+
+   std::vector<double> centralityRanges, zDCRanges;
+
+   for (const YAML::Node& centrality: inputYAMLCal["centrality_bins"])
+   {
+      centralityRanges.push_back(centrality["min"].as<double>());
+   }
+   centralityRanges.push_back(inputYAMLCal["centrality_bins"]
+                                          [inputYAMLCal["centrality_bins"].size() - 1]
+                                          ["max"].as<double>());
+
+   for (const YAML::Node& zDCBin: inputYAMLCal["zdc_bins"])
+   {
+      zDCRanges.push_back(zDCBin["min"].as<double>());
+   }
+   zDCRanges.push_back(inputYAMLCal["zdc_bins"][inputYAMLCal["zdc_bins"].size() - 1]
+                                   ["max"].as<double>());
+
+   const double pTMin = inputYAMLCal["pt_bins"][0]["min"].as<double>();
+   const double pTMax = inputYAMLCal["pt_bins"][inputYAMLCal["pt_bins"].size() - 1]
+                                    ["max"].as<double>();
+
+   auto startTime = std::chrono::steady_clock::now();
+
+   SigmalizedResidualsEvaluator evaluator(pTMin, pTMax, inputYAMLCal["residuals_evaluation"]
+                                          ["number_of_pt_bins"].as<unsigned int>(),
+                                          centralityRanges, zDCRanges);
+
+   for (const YAML::Node& detector : inputYAMLCal["detectors_to_calibrate"])
+   {
+      evaluator.AddDetector(detector, parametersDir);
+   }
+
+   if (evaluator.GetNumberOfDetectors() == 0)
+   {
+      CppTools::PrintError("No detectors are specified in " + std::string(argv[1]));
+   }
+
+   CppTools::PrintInfo("Lookup tables were filled in " +
+                       std::to_string(std::chrono::duration<double>
+                                      (std::chrono::steady_clock::now() - startTime).count()) + " s");
+
+   // tracks are evaluated in batches as in the loop over the tracks
+   const unsigned long batchSize = 4096;
+
+   std::vector<int> centralityBin(batchSize), zDCBin(batchSize), charge(batchSize);
+   std::vector<double> pT(batchSize), dphi(batchSize), dz(batchSize);
+   std::vector<double> sdphi(batchSize), sdz(batchSize);
+
+   std::mt19937 randomEngine(0);
+   std::uniform_int_distribution<int> chargeDistr(0, 1);
+   std::uniform_real_distribution<double> pTDistr(pTMin, pTMax);
+   std::uniform_real_distribution<double> centralityDistr(centralityRanges.front(),
+                                                          centralityRanges.back());
+   std::uniform_real_distribution<double> zDCDistr(zDCRanges.front(), zDCRanges.back());
+   std::normal_distribution<double> dphiDistr(0., 0.005);
+   std::normal_distribution<double> dzDistr(0., 2.);
+
+   double totalTime = 0., svalSum = 0.;
+   unsigned long numberOfProcessedTracks = 0;
+
+   for (unsigned int detectorBin = 0; numberOfProcessedTracks < numberOfTracks;
+        detectorBin = (detectorBin + 1) % evaluator.GetNumberOfDetectors())
+   {
+      // generation of tracks is not included in the measured time
+      for (unsigned long i = 0; i < batchSize; i++)
+      {
+         centralityBin[i] = evaluator.GetCentralityBin(centralityDistr(randomEngine));
+         zDCBin[i] = evaluator.GetZDCBin(zDCDistr(randomEngine));
+         charge[i] = 2*chargeDistr(randomEngine) - 1;
+         pT[i] = pTDistr(randomEngine);
+         dphi[i] = dphiDistr(randomEngine);
+         dz[i] = dzDistr(randomEngine);
+      }
+
+      startTime = std::chrono::steady_clock::now();
+
+      evaluator.Evaluate(detectorBin, 0, batchSize, centralityBin.data(), zDCBin.data(),
+                         charge.data(), pT.data(), dphi.data(), sdphi.data());
+      evaluator.Evaluate(detectorBin, 1, batchSize, centralityBin.data(), zDCBin.data(),
+                         charge.data(), pT.data(), dz.data(), sdz.data());
+
+      totalTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+      numberOfProcessedTracks += batchSize;
+
+      // the results are used so that the evaluation is not optimized away
+      svalSum += sdphi[0] + sdz[batchSize - 1];
+   }
+
+   CppTools::PrintInfo("Processed tracks: " + std::to_string(numberOfProcessedTracks) +
+                       " (checksum " + std::to_string(svalSum) + ")");
+   CppTools::PrintInfo("Throughput: " +
+                       std::to_string(static_cast<double>(numberOfProcessedTracks)/totalTime) +
+                       " tracks/s (sdphi and sdz)");
+
+   return 0;
+}
+
+#endif /* SIGMALIZED_RESIDUALS_EVALUATOR_BENCHMARK_CPP */
@@ -0,0 +1,477 @@
+/**
+ *  @file   SigmalizedResidualsHistograms.cpp
+ *  @brief  Contains realisation of functions that are used for filling of dphi and dz (and sdphi and sdz) distributions from track trees for calibration of sigmalized residuals
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef SIGMALIZED_RESIDUALS_HISTOGRAMS_CPP
+#define SIGMALIZED_RESIDUALS_HISTOGRAMS_CPP
+
+#include "../include/SigmalizedResidualsHistograms.hpp"
+
+int main(int argc, char **argv)
+{
+   using namespace SigmalizedResidualsHistograms;
+
+   if (argc < 2 || argc > 3)
+   {
+      std::string errMsg = "Expected 1-2 parameters while " + std::to_string(argc - 1) +
+                           " parameter(s) were provided \n";
+      errMsg += "Usage: bin/SigmalizedResidualsHistograms inputFile numberOfThreads=" +
+                std::to_string(std::thread::hardware_concurrency()) + "*\n";
+      errMsg += "*: default argument is the number of threads on the current machine \n";
+      CppTools::PrintError(errMsg);
+   }
+
+   unsigned int numberOfThreads;
+   if (argc > 2) numberOfThreads = std::stoi(argv[2]);
+   else numberOfThreads = std::thread::hardware_concurrency();
+   if (numberOfThreads == 0) CppTools::PrintError("Number of threads must be bigger than 0");
+
+   // memory usage is reported to the parent process if it requested it
+   MemoryUsageReporter memoryUsageReporter;
+
+   ROOT::EnableThreadSafety();
+   gErrorIgnoreLevel = kWarning;
+   TH1::AddDirectory(kFALSE);
+
+   inputYAMLCal.OpenFile(argv[1], "sigmalized_residuals");
+   inputYAMLCal.CheckStatus("sigmalized_residuals");
+
+   runName = inputYAMLCal["run_name"].as<std::string>();
+
+   const YAML::Node histogramsSettings = inputYAMLCal["residuals_histograms"];
+
+   if (histogramsSettings["input_trees"].as<std::string>() == "")
+   {
+      CppTools::PrintError("Input trees are not specified (see residuals_histograms in " +
+                           std::string(argv[1]) + ")");
+   }
+
+   treeName = histogramsSettings["tree_name"].as<std::string>();
+   entriesPerTask = histogramsSettings["entries_per_task"].as<long long>();
+   if (entriesPerTask <= 0) CppTools::PrintError("Number of entries per task must be bigger than 0");
+
+   for (const YAML::Node& detector : inputYAMLCal["detectors_to_calibrate"])
+   {
+      detectorNames.push_back(detector["name"].as<std::string>());
+   }
+
+   if (detectorNames.empty())
+   {
+      CppTools::PrintInfo("No detectors are specified for calibrations");
+      CppTools::PrintInfo("Exiting the program");
+      exit(1);
+   }
+
+   for (const YAML::Node& pTBin: inputYAMLCal["pt_bins"])
+   {
+      pTRanges.push_back(pTBin["min"].as<double>());
+   }
+   pTRanges.push_back(inputYAMLCal["pt_bins"][inputYAMLCal["pt_bins"].size() - 1]
+                                  ["max"].as<double>());
+
+   for (const YAML::Node& zDCBin: inputYAMLCal["zdc_bins"])
+   {
+      zDCRanges.push_back(zDCBin["min"].as<double>());
+      zDCRangeNames.push_back(zDCBin["min"].as<std::string>() + "<zDC<" +
+                              zDCBin["max"].as<std::string>());
+   }
+   zDCRanges.push_back(inputYAMLCal["zdc_bins"][inputYAMLCal["zdc_bins"].size() - 1]
+                                   ["max"].as<double>());
+
+   for (const YAML::Node& centrality: inputYAMLCal["centrality_bins"])
+   {
+      centralityRanges.push_back(centrality["min"].as<double>());
+   }
+   centralityRanges.push_back(inputYAMLCal["centrality_bins"]
+                                          [inputYAMLCal["centrality_bins"].size() - 1]
+                                          ["max"].as<double>());
+
+   const std::array<std::string, 3> valBinsFields{"dphi_bins", "dz_bins", "sval_bins"};
+   for (unsigned int i = 0; i < valBinsFields.size(); i++)
+   {
+      const YAML::Node valBins = histogramsSettings[valBinsFields[i]];
+
+      const int numberOfBins = valBins["number"].as<int>();
+      const double min = valBins["min"].as<double>();
+      const double max = valBins["max"].as<double>();
+
+      if (numberOfBins <= 0 || max <= min)
+      {
+         CppTools::PrintError("Invalid binning in " + valBinsFields[i] + " in " + argv[1]);
+      }
+
+      for (int j = 0; j <= numberOfBins; j++)
+      {
+         valRanges[i].push_back(min + (max - min)*static_cast<double>(j)/numberOfBins);
+      }
+   }
+
+   // sdphi and sdz are only filled after the calibration parameters were obtained
+   const std::string parametersDir =
+      "output/SigmalizedResiduals/" + runName + "/CalibrationParameters/";
+
+   isSigmalizedFilled = true;
+   for (const std::string& detectorName : detectorNames)
+   {
+      for (const std::string& variable : variableName)
+      {
+         for (const std::string chargeNameShort : {"pos", "neg"})
+         {
+            if (!std::filesystem::exists(parametersDir + "cal_" + detectorName + "_s" +
+                                         variable + "_" + chargeNameShort + ".txt"))
+            {
+               isSigmalizedFilled = false;
+            }
+         }
+      }
+   }
+
+   // evaluator is also used to find centrality and zDC bins of the tracks;
+   // recal_ files are not applied since CheckSigmalizedResiduals obtains them from
+   // sdphi and sdz distributions calculated with cal_ files only
+   evaluator = SigmalizedResidualsEvaluator(pTRanges.front(), pTRanges.back(),
+                                            inputYAMLCal["residuals_evaluation"]
+                                            ["number_of_pt_bins"].as<unsigned int>(),
+                                            centralityRanges, zDCRanges, false);
+
+   if (isSigmalizedFilled)
+   {
+      for (const YAML::Node& detector : inputYAMLCal["detectors_to_calibrate"])
+      {
+         evaluator.AddDetector(detector, parametersDir);
+      }
+      CppTools::PrintInfo("Calibration parameters were found in " + parametersDir +
+                          "; sdphi and sdz distributions will be filled");
+   }
+   else
+   {
+      CppTools::PrintInfo("Calibration parameters were not found in " + parametersDir +
+                          "; only dphi and dz distributions will be filled");
+   }
+
+   AddInputFiles(histogramsSettings["input_trees"].as<std::string>());
+   CreateTasks();
+
+   if (numberOfEntries == 0) CppTools::PrintError("Input trees are empty");
+
+   std::string outputFileName = histogramsSettings["output_file"].as<std::string>();
+   // sum.root from the taxi is not overwritten by default
+   if (outputFileName == "")
+   {
+      outputFileName = "data/SigmalizedResiduals/" + runName + "/sum_from_trees.root";
+   }
+
+   if (std::filesystem::path(outputFileName).has_parent_path())
+   {
+      std::filesystem::create_directories(std::filesystem::path(outputFileName).parent_path());
+   }
+
+   numberOfThreads =
+      CppTools::Minimum(static_cast<unsigned long>(numberOfThreads), tasks.size());
+
+   // thread local histograms
+   std::vector<std::vector<std::unique_ptr<TH3F>>> hists(numberOfThreads);
+   for (unsigned int i = 0; i < numberOfThreads; i++) hists[i] = CreateHistograms();
+
+   std::thread pBarThr(PBarCall);
+
+   std::vector<std::thread> thrCalls;
+   for (unsigned int i = 0; i < numberOfThreads; i++)
+   {
+      thrCalls.emplace_back(ProcessTasks, std::ref(hists[i]));
+   }
+   for (std::thread& thr : thrCalls) thr.join();
+
+   isProcessFinished = true;
+   pBarThr.join();
+
+   // pairwise summation of the thread local histograms; every step halves their number
+   for (unsigned int step = 1; step < numberOfThreads; step *= 2)
+   {
+      thrCalls.clear();
+      for (unsigned int i = 0; i + step < numberOfThreads; i += 2*step)
+      {
+         thrCalls.emplace_back([&hists, i, step]()
+         {
+            for (unsigned long j = 0; j < hists[i].size(); j++)
+            {
+               if (!hists[i][j]) continue;
+               hists[i][j]->Add(hists[i + step][j].get());
+               hists[i + step][j].reset();
+            }
+         });
+      }
+      for (std::thread& thr : thrCalls) thr.join();
+   }
+
+   TFile outputFile(outputFileName.c_str(), "RECREATE");
+   outputFile.cd();
+
+   for (const std::unique_ptr<TH3F>& hist : hists[0])
+   {
+      if (hist) hist->Write();
+   }
+
+   outputFile.Close();
+
+   CppTools::PrintInfo("Distributions were written in " + outputFileName);
+
+   return 0;
+}
+
+void SigmalizedResidualsHistograms::AddInputFiles(const std::string& inputPath)
+{
+   if (!std::filesystem::exists(inputPath))
+   {
+      CppTools::PrintError("Input " + inputPath + " does not exist");
+   }
+
+   std::set<std::string> fileNames;
+
+   if (std::filesystem::is_directory(inputPath))
+   {
+      for (const auto &file : std::filesystem::directory_iterator(inputPath))
+      {
+         if (file.path().extension() == ".root") fileNames.insert(file.path().string());
+      }
+   }
+   else if (std::filesystem::path(inputPath).extension() == ".root")
+   {
+      fileNames.insert(inputPath);
+   }
+   else
+   {
+      std::ifstream inputList(inputPath);
+      std::string fileName;
+
+      while (std::getline(inputList, fileName))
+      {
+         if (fileName == "" || fileName[0] == '#') continue;
+
+         if (!std::filesystem::exists(fileName))
+         {
+            CppTools::PrintError("File " + fileName + " from list " + inputPath + " does not exist");
+         }
+         fileNames.insert(fileName);
+      }
+   }
+
+   if (fileNames.empty()) CppTools::PrintError("No .root files were found in " + inputPath);
+
+   inputFileNames.assign(fileNames.begin(), fileNames.end());
+}
+
+void SigmalizedResidualsHistograms::CreateTasks()
+{
+   for (unsigned long i = 0; i < inputFileNames.size(); i++)
+   {
+      std::unique_ptr<TFile> inputFile(TFile::Open(inputFileNames[i].c_str(), "READ"));
+
+      if (!inputFile || inputFile->IsZombie())
+      {
+         CppTools::PrintError("File " + inputFileNames[i] + " cannot be opened");
+      }
+
+      TTree *tree = static_cast<TTree *>(inputFile->Get(treeName.c_str()));
+
+      if (!tree)
+      {
+         CppTools::PrintError("Tree named \"" + treeName + "\" does not exist in " +
+                              inputFileNames[i]);
+      }
+
+      const long long numberOfFileEntries = tree->GetEntries();
+
+      for (long long firstEntry = 0; firstEntry < numberOfFileEntries;
+           firstEntry += entriesPerTask)
+      {
+         tasks.push_back({i, firstEntry,
+                          CppTools::Minimum(firstEntry + entriesPerTask, numberOfFileEntries)});
+      }
+
+      numberOfEntries += numberOfFileEntries;
+   }
+}
+
+unsigned long SigmalizedResidualsHistograms::GetHistogramIndex(const bool isSigmalized,
+                                                               const unsigned int detectorBin,
+                                                               const unsigned int variableBin,
+                                                               const unsigned int chargeBin,
+                                                               const unsigned int zDCBin)
+{
+   return (((static_cast<unsigned long>(isSigmalized)*detectorNames.size() + detectorBin)*2 +
+            variableBin)*2 + chargeBin)*zDCRangeNames.size() + zDCBin;
+}
+
+std::vector<std::unique_ptr<TH3F>> SigmalizedResidualsHistograms::CreateHistograms()
+{
+   std::vector<std::unique_ptr<TH3F>> hists(GetHistogramIndex(true, 0, 0, 0, 0)*2);
+
+   for (const bool isSigmalized : {false, true})
+   {
+      if (isSigmalized && !isSigmalizedFilled) continue;
+
+      for (unsigned int detectorBin = 0; detectorBin < detectorNames.size(); detectorBin++)
+      {
+         for (unsigned int variableBin = 0; variableBin < variableName.size(); variableBin++)
+         {
+            const std::vector<double>& xRanges = valRanges[isSigmalized ? 2 : variableBin];
+
+            for (unsigned int chargeBin = 0; chargeBin < 2; chargeBin++)
+            {
+               const std::string chargeName = ((chargeBin == 0) ? "charge>0" : "charge<0");
+
+               for (unsigned int zDCBin = 0; zDCBin < zDCRangeNames.size(); zDCBin++)
+               {
+                  // same names as in the taxi output
+                  const std::string histName = (isSigmalized ? "s" : "") +
+                     variableName[variableBin] + " vs pT vs centrality: " +
+                     detectorNames[detectorBin] + ", " + chargeName + ", " +
+                     zDCRangeNames[zDCBin];
+
+                  hists[GetHistogramIndex(isSigmalized, detectorBin, variableBin,
+                                          chargeBin, zDCBin)] = std::make_unique<TH3F>
+                     (histName.c_str(), histName.c_str(),
+                      xRanges.size() - 1, &xRanges[0], pTRanges.size() - 1, &pTRanges[0],
+                      centralityRanges.size() - 1, &centralityRanges[0]);
+               }
+            }
+         }
+      }
+   }
+
+   return hists;
+}
+
+void SigmalizedResidualsHistograms::ProcessTasks(std::vector<std::unique_ptr<TH3F>>& hists)
+{
+   // values of the branches of the current entry
+   int charge;
+   float pT, centrality, zDC;
+   std::vector<float> val(detectorNames.size()*2);
+
+   // tracks of the current batch
+   std::vector<int> batchCharge(batchSize), batchCentralityBin(batchSize), batchZDCBin(batchSize);
+   std::vector<double> batchPT(batchSize), batchCentrality(batchSize), batchSVal(batchSize);
+   std::vector<std::vector<double>> batchVal(val.size(), std::vector<double>(batchSize));
+
+   unsigned long numberOfBatchTracks = 0;
+
+   auto FillBatch = [&]()
+   {
+      for (unsigned int detectorBin = 0; detectorBin < detectorNames.size(); detectorBin++)
+      {
+         for (unsigned int variableBin = 0; variableBin < 2; variableBin++)
+         {
+            const std::vector<double>& trackVal = batchVal[detectorBin*2 + variableBin];
+
+            if (isSigmalizedFilled)
+            {
+               evaluator.Evaluate(detectorBin, variableBin, numberOfBatchTracks,
+                                  batchCentralityBin.data(), batchZDCBin.data(),
+                                  batchCharge.data(), batchPT.data(),
+                                  trackVal.data(), batchSVal.data());
+            }
+
+            for (unsigned long i = 0; i < numberOfBatchTracks; i++)
+            {
+               // tracks without the match in the detector and tracks outside of zDC bins
+               if (!std::isfinite(trackVal[i]) || batchZDCBin[i] < 0) continue;
+
+               // the same convention as in SigmalizedResidualsEvaluator::Evaluate
+               const unsigned int chargeBin = (batchCharge[i] < 0) ? 1 : 0;
+
+               hists[GetHistogramIndex(false, detectorBin, variableBin, chargeBin,
+                                       batchZDCBin[i])]->
+                  Fill(trackVal[i], batchPT[i], batchCentrality[i]);
+
+               if (isSigmalizedFilled && std::isfinite(batchSVal[i]))
+               {
+                  hists[GetHistogramIndex(true, detectorBin, variableBin, chargeBin,
+                                          batchZDCBin[i])]->
+                     Fill(batchSVal[i], batchPT[i], batchCentrality[i]);
+               }
+            }
+         }
+      }
+
+      numberOfProcessedEntries += numberOfBatchTracks;
+      numberOfBatchTracks = 0;
+   };
+
+   std::unique_ptr<TFile> inputFile;
+   TTree *tree = nullptr;
+   unsigned long currentFileIndex = inputFileNames.size();
+
+   for (unsigned long taskIndex = nextTaskIndex++; taskIndex < tasks.size();
+        taskIndex = nextTaskIndex++)
+   {
+      const Task& task = tasks[taskIndex];
+
+      // the file is reopened only when the next task is from another file
+      if (task.fileIndex != currentFileIndex)
+      {
+         inputFile.reset(TFile::Open(inputFileNames[task.fileIndex].c_str(), "READ"));
+         tree = static_cast<TTree *>(inputFile->Get(treeName.c_str()));
+
+         tree->SetBranchAddress("charge", &charge);
+         tree->SetBranchAddress("pT", &pT);
+         tree->SetBranchAddress("centrality", &centrality);
+         tree->SetBranchAddress("zDC", &zDC);
+
+         for (unsigned int detectorBin = 0; detectorBin < detectorNames.size(); detectorBin++)
+         {
+            for (unsigned int variableBin = 0; variableBin < 2; variableBin++)
+            {
+               tree->SetBranchAddress((detectorNames[detectorBin] + "_" +
+                                       variableName[variableBin]).c_str(),
+                                      &val[detectorBin*2 + variableBin]);
+            }
+         }
+
+         currentFileIndex = task.fileIndex;
+      }
+
+      for (long long entry = task.firstEntry; entry < task.lastEntry; entry++)
+      {
+         tree->GetEntry(entry);
+
+         // neutral tracks belong to neither of the charges hence they are neither
+         // sigmalized nor filled
+         if (charge == 0)
+         {
+            numberOfProcessedEntries++;
+            continue;
+         }
+
+         batchCharge[numberOfBatchTracks] = charge;
+         batchPT[numberOfBatchTracks] = pT;
+         batchCentrality[numberOfBatchTracks] = centrality;
+         batchCentralityBin[numberOfBatchTracks] = evaluator.GetCentralityBin(centrality);
+         batchZDCBin[numberOfBatchTracks] = evaluator.GetZDCBin(zDC);
+
+         for (unsigned long i = 0; i < val.size(); i++) batchVal[i][numberOfBatchTracks] = val[i];
+
+         if (++numberOfBatchTracks == batchSize) FillBatch();
+      }
+   }
+
+   FillBatch();
+}
+
+void SigmalizedResidualsHistograms::PBarCall()
+{
+   while (!isProcessFinished)
+   {
+      pBar.Print(static_cast<double>(numberOfProcessedEntries)/
+                 static_cast<double>(numberOfEntries));
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+   }
+   pBar.Finish();
+}
+
+#endif /* SIGMALIZED_RESIDUALS_HISTOGRAMS_CPP */
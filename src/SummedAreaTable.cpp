@@ -0,0 +1,72 @@
+/**
+ *  @file   SummedAreaTable.cpp
+ *  @brief  Contains realisation of class SummedAreaTable
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef SUMMED_AREA_TABLE_CPP
+#define SUMMED_AREA_TABLE_CPP
+
+#include "../include/SummedAreaTable.hpp"
+
+SummedAreaTable::SummedAreaTable(const TH2 *hist)
+{
+   numberOfXBins = hist->GetXaxis()->GetNbins();
+   numberOfYBins = hist->GetYaxis()->GetNbins();
+
+   // bins from 0 (underflow) to n + 1 (overflow) are shifted by 1 in the table
+   sums.assign((numberOfXBins + 3)*(numberOfYBins + 3), 0.);
+
+   for (int i = 0; i <= numberOfXBins + 1; i++)
+   {
+      for (int j = 0; j <= numberOfYBins + 1; j++)
+      {
+         sums[GetIndex(i, j)] = hist->GetBinContent(i, j) +
+                                sums[GetIndex(i - 1, j)] + sums[GetIndex(i, j - 1)] -
+                                sums[GetIndex(i - 1, j - 1)];
+      }
+   }
+}
+
+double SummedAreaTable::Integral(int firstXBin, int lastXBin, int firstYBin, int lastYBin) const
+{
+   firstXBin = CppTools::Maximum(firstXBin, 0);
+   lastXBin = CppTools::Minimum(lastXBin, numberOfXBins + 1);
+   firstYBin = CppTools::Maximum(firstYBin, 0);
+   lastYBin = CppTools::Minimum(lastYBin, numberOfYBins + 1);
+
+   if (firstXBin > lastXBin || firstYBin > lastYBin) return 0.;
+
+   return sums[GetIndex(lastXBin, lastYBin)] - sums[GetIndex(firstXBin - 1, lastYBin)] -
+          sums[GetIndex(lastXBin, firstYBin - 1)] + sums[GetIndex(firstXBin - 1, firstYBin - 1)];
+}
+
+std::vector<std::pair<int, int>>
+SummedAreaTable::GetMergedXBins(const int firstXBin, const int lastXBin,
+                                const int firstYBin, const int lastYBin,
+                                const double minIntegral) const
+{
+   std::vector<std::pair<int, int>> mergedXBins;
+
+   int firstMergedXBin = firstXBin;
+   for (int i = firstXBin; i <= lastXBin; i++)
+   {
+      if (Integral(firstMergedXBin, i, firstYBin, lastYBin) < minIntegral) continue;
+
+      mergedXBins.emplace_back(firstMergedXBin, i);
+      firstMergedXBin = i + 1;
+   }
+
+   return mergedXBins;
+}
+
+unsigned long SummedAreaTable::GetIndex(const int xBin, const int yBin) const
+{
+   return static_cast<unsigned long>(xBin + 1)*(numberOfYBins + 3) + yBin + 1;
+}
+
+SummedAreaTable::~SummedAreaTable() {};
+
+#endif /* SUMMED_AREA_TABLE_CPP */
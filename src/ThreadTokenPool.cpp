@@ -0,0 +1,105 @@
+/**
+ *  @file   ThreadTokenPool.cpp
+ *  @brief  Contains realisation of class ThreadTokenPool
+ *
+ *  This file is a part of a project CalPhenix (https://github.com/Sergeyir/CalPhenix).
+ *
+ *  @author Sergei Antsupov (antsupov0124@gmail.com)
+ **/
+#ifndef THREAD_TOKEN_POOL_CPP
+#define THREAD_TOKEN_POOL_CPP
+
+#include "../include/ThreadTokenPool.hpp"
+
+ThreadTokenPool::ThreadTokenPool() {};
+
+ThreadTokenPool::ThreadTokenPool(const unsigned int numberOfThreads)
+{
+   if (numberOfThreads == 0) CppTools::PrintError("ThreadTokenPool: Number of threads must be bigger than 0");
+
+   const char *inheritedFifoPath = getenv(environmentVariableName.c_str());
+
+   if (inheritedFifoPath)
+   {
+      fifoPath = inheritedFifoPath;
+      isInherited = true;
+   }
+   else
+   {
+      std::filesystem::create_directories("tmp/ThreadTokenPool");
+      fifoPath = std::filesystem::absolute("tmp/ThreadTokenPool/" +
+                                           std::to_string(getpid())).string();
+
+      std::filesystem::remove(fifoPath);
+      if (mkfifo(fifoPath.c_str(), 0600) != 0)
+      {
+         CppTools::PrintError("ThreadTokenPool: Unable to create pipe " + fifoPath);
+      }
+   }
+
+   // O_RDWR does not wait for the other end of the pipe to be opened and keeps the pipe open
+   // while the tokens are in it even if all other processes closed it
+   blockingFileDescriptor = open(fifoPath.c_str(), O_RDWR | O_CLOEXEC);
+   nonBlockingFileDescriptor = open(fifoPath.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+
+   if (blockingFileDescriptor < 0 || nonBlockingFileDescriptor < 0)
+   {
+      CppTools::PrintError("ThreadTokenPool: Unable to open pipe " + fifoPath);
+   }
+
+   if (!isInherited)
+   {
+      Release(numberOfThreads);
+      setenv(environmentVariableName.c_str(), fifoPath.c_str(), 1);
+   }
+}
+
+void ThreadTokenPool::Acquire()
+{
+   char token;
+   while (read(blockingFileDescriptor, &token, 1) != 1)
+   {
+      if (errno != EINTR) CppTools::PrintError("ThreadTokenPool: Unable to read pipe " + fifoPath);
+   }
+}
+
+unsigned int ThreadTokenPool::TryAcquire(const unsigned int numberOfTokens)
+{
+   if (numberOfTokens == 0) return 0;
+
+   std::vector<char> tokens(numberOfTokens);
+   const ssize_t numberOfReadTokens = read(nonBlockingFileDescriptor, tokens.data(), numberOfTokens);
+
+   if (numberOfReadTokens < 0) return 0;
+   return static_cast<unsigned int>(numberOfReadTokens);
+}
+
+void ThreadTokenPool::Release(const unsigned int numberOfTokens)
+{
+   // the pipe capacity is much bigger than any reasonable number of tokens hence it never blocks
+   const std::vector<char> tokens(numberOfTokens, '+');
+   if (write(nonBlockingFileDescriptor, tokens.data(), numberOfTokens) !=
+       static_cast<ssize_t>(numberOfTokens))
+   {
+      CppTools::PrintError("ThreadTokenPool: Unable to write in pipe " + fifoPath);
+   }
+}
+
+bool ThreadTokenPool::IsInherited() const
+{
+   return isInherited;
+}
+
+ThreadTokenPool::~ThreadTokenPool()
+{
+   if (blockingFileDescriptor >= 0) close(blockingFileDescriptor);
+   if (nonBlockingFileDescriptor >= 0) close(nonBlockingFileDescriptor);
+
+   if (!isInherited && !fifoPath.empty())
+   {
+      unsetenv(environmentVariableName.c_str());
+      std::filesystem::remove(fifoPath);
+   }
+};
+
+#endif /* THREAD_TOKEN_POOL_CPP */